@@ -0,0 +1,220 @@
+/*
+ * File Description
+ *      Source file for the animation library in program flash. The region is declared as a PSV 
+ *      array at a fixed address so the linker keeps code out of it, and noload leaves it out of 
+ *      the hex file, so programming the hex does not write over it. noload does not stop an erase: 
+ *      the programmer's bulk erase still wipes the region unless it is set to preserve it (see 
+ *      Anim_store.h). The __psv__ pointers make the compiler set PSVPAG for every read, so the 
+ *      rest of the const data (gamma table, pixel map) can still be read in between.
+ */
+
+#include "xc.h"
+#include "Anim_store.h"
+#include "Frame_buffer.h"
+#include "Bus.h"
+
+#define NVM_ERASE_PAGE 0x4042   // NVMCON: erase one page
+#define NVM_WRITE_ROW 0x4001    // NVMCON: write one row
+
+#if ANIM_STORE_ADDRESS % (ANIM_PAGE_BYTES) != 0
+#error "ANIM_STORE_ADDRESS must be page aligned"
+#endif
+
+static __psv__ const unsigned char anim_store[ANIM_STORE_BYTES] 
+    __attribute__((space(psv), address(ANIM_STORE_ADDRESS), noload));
+
+/*
+ * Description
+ *      Reads a 16-bit value stored low byte first.
+ * Parameters 
+ *      1. __psv__ const unsigned char *p, the value in the region
+ * Return
+ *      unsigned int, the value
+ */
+static unsigned int read_word(__psv__ const unsigned char *p)
+{
+    return p[0] | ((unsigned int) p[1] << 8);
+}
+
+/*
+ * Description
+ *      Starts the flash operation set up in NVMCON and waits for it. The CPU stalls until the 
+ *      flash is done anyway, and __builtin_write_NVM masks interrupts for the unlock sequence.
+ * Parameters 
+ *      void
+ * Return
+ *      void
+ */
+static void nvm_start(void)
+{
+    __builtin_write_NVM();
+    while (NVMCONbits.WR) {}
+}
+
+/*
+ * Description
+ *      Erases pages of the region.
+ * Parameters 
+ *      1. unsigned char first, first page (0 to ANIM_PAGES - 1)
+ *      2. unsigned char count, number of pages
+ * Return
+ *      unsigned char, 1 if done, 0 if the pages are outside the region
+ */
+unsigned char anim_store_erase(unsigned char first, unsigned char count)
+{
+    unsigned long address;
+
+    if (first >= ANIM_PAGES || count > ANIM_PAGES - first)
+        return 0;
+
+    while (count--) {
+        address = ANIM_STORE_ADDRESS + (unsigned long) first++ * ANIM_PAGE_BYTES;
+        NVMCON = NVM_ERASE_PAGE;
+        TBLPAG = address >> 16;
+        __builtin_tblwtl((unsigned int) address, 0); // Selects the page
+        nvm_start();
+    }
+    return 1;
+}
+
+/*
+ * Description
+ *      Writes one row of the region. The row has to be erased first. Every 2 bytes go into the 
+ *      low word of one instruction, the part PSV can read; the upper byte is left erased.
+ * Parameters 
+ *      1. unsigned int offset, byte offset in the region, a multiple of ANIM_ROW_BYTES
+ *      2. const unsigned char *data, ANIM_ROW_BYTES bytes
+ * Return
+ *      unsigned char, 1 if done, 0 if the offset is not a row of the region
+ */
+unsigned char anim_store_write_row(unsigned int offset, const unsigned char *data)
+{
+    unsigned long address = ANIM_STORE_ADDRESS + offset;
+    unsigned int i;
+
+    if (offset % ANIM_ROW_BYTES != 0 || offset >= ANIM_STORE_BYTES)
+        return 0;
+
+    NVMCON = NVM_WRITE_ROW;
+    TBLPAG = address >> 16;
+    for (i = 0; i < ANIM_ROW_BYTES; i += 2) { // Fill the 64 write latches
+        __builtin_tblwtl((unsigned int) address + i, data[i] | ((unsigned int) data[i + 1] << 8));
+        __builtin_tblwth((unsigned int) address + i, 0xFF);
+    }
+    nvm_start();
+    return 1;
+}
+
+/*
+ * Description
+ *      Checks that a page holds the start of a complete blob with a good CRC.
+ * Parameters 
+ *      1. unsigned char page, the page
+ * Return
+ *      unsigned char, 1 if the blob is good
+ */
+unsigned char anim_store_check(unsigned char page)
+{
+    __psv__ const unsigned char *blob;
+    unsigned int length, frames, i, crc;
+    unsigned char bit;
+
+    if (page >= ANIM_PAGES)
+        return 0;
+    blob = anim_store + (unsigned int) page * ANIM_PAGE_BYTES;
+
+    if (blob[0] != 'A' || blob[1] != 'N')
+        return 0;
+    length = read_word(blob + 2);
+    frames = read_word(blob + 4);
+    if (frames == 0 || frames > (ANIM_STORE_BYTES - ANIM_HEADER_BYTES) / ANIM_FRAME_BYTES || 
+        length != ANIM_HEADER_BYTES + frames * ANIM_FRAME_BYTES || 
+        length + 2 > ANIM_STORE_BYTES - (unsigned int) page * ANIM_PAGE_BYTES)
+        return 0;
+
+    crc = 0xFFFF; // CRC-16/CCITT, only run when a blob is checked so a plain loop is enough
+    for (i = 0; i < length; i++) {
+        crc ^= (unsigned int) blob[i] << 8;
+        for (bit = 0; bit < 8; bit++)
+            crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+    }
+    return crc == (((unsigned int) blob[length] << 8) | blob[length + 1]);
+}
+
+/*
+ * Description
+ *      Finds a blob by its number, counting the good blobs from the start of the region.
+ * Parameters 
+ *      1. unsigned char n, number of the blob (0 for the first)
+ * Return
+ *      unsigned char, page the blob starts on, ANIM_NONE if there are not that many
+ */
+unsigned char anim_store_find(unsigned char n)
+{
+    unsigned char page = 0;
+    unsigned int length;
+
+    while (page < ANIM_PAGES) {
+        if (!anim_store_check(page)) {
+            page++;
+            continue;
+        }
+        if (n-- == 0)
+            return page;
+        length = read_word(anim_store + (unsigned int) page * ANIM_PAGE_BYTES + 2);
+        page += (length + 2 + ANIM_PAGE_BYTES - 1) / ANIM_PAGE_BYTES; // Skip the pages it fills
+    }
+    return ANIM_NONE;
+}
+
+/*
+ * Description
+ *      Plays a blob once, reading every frame straight from flash.
+ * Parameters 
+ *      1. unsigned char page, page the blob starts on (it should have passed anim_store_check)
+ * Return
+ *      void
+ */
+void anim_store_play(unsigned char page)
+{
+    __psv__ const unsigned char *blob = anim_store + (unsigned int) page * ANIM_PAGE_BYTES;
+    __psv__ const unsigned char *frame = blob + ANIM_HEADER_BYTES;
+    __psv__ const unsigned char *color;
+    unsigned int frames = read_word(blob + 4);
+    unsigned int period = read_word(blob + 6);
+    unsigned char x, y, index;
+
+    while (frames--) {
+        for (y = 0; y < FRAME_HEIGHT; y++) {
+            for (x = 0; x < FRAME_WIDTH; x++) {
+                index = frame[(y * FRAME_WIDTH + x) / 2];
+                index = (x & 1) ? (index & 0x0F) : (index >> 4);
+                color = blob + 8 + index * 3;
+                frame_set_pixel(x, y, color[0], color[1], color[2]);
+            }
+        }
+        frame_show();
+        frame += ANIM_FRAME_BYTES;
+        bus_wait_until(deadline_in_ms(period)); // Same gap between frames as Ndelay
+    }
+}
+
+/*
+ * Description
+ *      Carries out one upload command from the stream parser.
+ * Parameters 
+ *      1. unsigned char type, STREAM_TYPE_STORE_ERASE, STREAM_TYPE_STORE_ROW or STREAM_TYPE_STORE_CHECK
+ *      2. const unsigned char *payload, the payload of the stream frame
+ * Return
+ *      unsigned char, 1 if it worked (answered with STREAM_ACK), 0 if not (STREAM_NAK)
+ */
+unsigned char anim_store_command(unsigned char type, const unsigned char *payload)
+{
+    if (type == STREAM_TYPE_STORE_ERASE)
+        return anim_store_erase(payload[0], payload[1]);
+    if (type == STREAM_TYPE_STORE_ROW)
+        return anim_store_write_row(payload[0] | ((unsigned int) payload[1] << 8), payload + 2);
+    if (type == STREAM_TYPE_STORE_CHECK)
+        return anim_store_check(payload[0]);
+    return 0;
+}
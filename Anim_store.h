@@ -0,0 +1,130 @@
+/*
+ * File Description
+ *      Header file for the animation library kept in program flash, which can be replaced over 
+ *      UART while the program runs, without a programmer.
+ * 
+ * Background
+ *      Program addresses ANIM_STORE_ADDRESS to ANIM_STORE_ADDRESS + 0x1FFF (8 erase pages) are 
+ *      kept free of code and are not loaded by the programmer. Through program space visibility 
+ *      (PSV) the low 16 bits of each instruction word can be read like const data, so the region 
+ *      holds 8 KB, 1 KB per page, and the player reads frames straight from it with no copy in RAM. 
+ *      It is written with run-time self-programming (RTSP): a page is erased at once and written 
+ *      one row (64 instructions, 128 bytes) at a time. 
+ * 
+ *      Every animation (blob) starts at the beginning of a page and is laid out as
+ * 
+ *      offset 0    'A', 'N' (magic)
+ *      offset 2    length, bytes up to the CRC (2 bytes, low first)
+ *      offset 4    number of frames (2 bytes, low first)
+ *      offset 6    time per frame in ms (2 bytes, low first)
+ *      offset 8    16 color palette, 3 bytes per color in writeColor order
+ *      offset 56   frames, 32 bytes each: one 4-bit palette index per pixel, row by row from the 
+ *                  top-left pixel, left pixel in the high nibble
+ *      length      CRC-16/CCITT of everything before it (2 bytes, high first), same as Stream.h
+ * 
+ *      A blob is uploaded through the stream protocol (Stream.h) with three frame types: erase 
+ *      the pages, write each row, then check the blob. Each one is answered with STREAM_ACK or 
+ *      STREAM_NAK once the flash operation is done, so the PC never sends while the CPU is stalled 
+ *      by a flash write. Uploading a full 8 KB takes well under a second at 1 Mbaud.
+ * 
+ *      The region is left out of the hex file, but reprogramming the chip still starts with a bulk 
+ *      erase that wipes it along with everything else. To keep the uploaded animations across a 
+ *      reflash, set the programmer to preserve program memory 0x8000 to 0x9FFF: in MPLAB X, 
+ *      Project Properties, PICkit/ICD, option category Memories to Program, check Preserve Program 
+ *      Memory and set the start to 0x8000 and the end to 0x9FFF; in MPLAB IPE, Settings, Advanced 
+ *      Mode, Memory, Preserve Program Memory range with the same addresses. The programmer then 
+ *      reads the range back before the erase and writes it again afterwards. Move the range along 
+ *      with ANIM_STORE_ADDRESS.
+ */
+
+#ifndef ANIM_STORE_H
+#define	ANIM_STORE_H
+
+#include <xc.h> // include processor files - each processor file is guarded.  
+
+#ifdef	__cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+    #define ANIM_STORE_ADDRESS 0x8000UL     // First program address of the region, page aligned
+    #define ANIM_PAGES 8                    // Erase pages in the region
+    #define ANIM_PAGE_BYTES 1024            // Bytes per page (512 instructions, 2 bytes each)
+    #define ANIM_ROW_BYTES 128              // Bytes per row (64 instructions, 2 bytes each)
+    #define ANIM_STORE_BYTES ((unsigned int) ANIM_PAGES * ANIM_PAGE_BYTES)
+    #define ANIM_HEADER_BYTES 56            // Header and palette
+    #define ANIM_FRAME_BYTES 32             // One 8x8 frame at 4 bits per pixel
+    #define ANIM_NONE 0xFF
+
+    // Stream frame types for uploading (see Stream.h)
+    #define STREAM_TYPE_STORE_ERASE 0x10    // payload: first page, page count
+    #define STREAM_TYPE_STORE_ROW 0x11      // payload: byte offset in the region (2 bytes, low first), 128 bytes
+    #define STREAM_TYPE_STORE_CHECK 0x12    // payload: page of the blob
+
+    /*
+     * Description
+     *      Erases pages of the region.
+     * Parameters 
+     *      1. unsigned char first, first page (0 to ANIM_PAGES - 1)
+     *      2. unsigned char count, number of pages
+     * Return
+     *      unsigned char, 1 if done, 0 if the pages are outside the region
+     */
+    unsigned char anim_store_erase(unsigned char first, unsigned char count);
+
+    /*
+     * Description
+     *      Writes one row of the region. The row has to be erased first.
+     * Parameters 
+     *      1. unsigned int offset, byte offset in the region, a multiple of ANIM_ROW_BYTES
+     *      2. const unsigned char *data, ANIM_ROW_BYTES bytes
+     * Return
+     *      unsigned char, 1 if done, 0 if the offset is not a row of the region
+     */
+    unsigned char anim_store_write_row(unsigned int offset, const unsigned char *data);
+
+    /*
+     * Description
+     *      Checks that a page holds the start of a complete blob with a good CRC.
+     * Parameters 
+     *      1. unsigned char page, the page
+     * Return
+     *      unsigned char, 1 if the blob is good
+     */
+    unsigned char anim_store_check(unsigned char page);
+
+    /*
+     * Description
+     *      Finds a blob by its number, counting the good blobs from the start of the region.
+     * Parameters 
+     *      1. unsigned char n, number of the blob (0 for the first)
+     * Return
+     *      unsigned char, page the blob starts on, ANIM_NONE if there are not that many
+     */
+    unsigned char anim_store_find(unsigned char n);
+
+    /*
+     * Description
+     *      Plays a blob once, reading every frame straight from flash.
+     * Parameters 
+     *      1. unsigned char page, page the blob starts on (it should have passed anim_store_check)
+     * Return
+     *      void
+     */
+    void anim_store_play(unsigned char page);
+
+    /*
+     * Description
+     *      Carries out one upload command from the stream parser.
+     * Parameters 
+     *      1. unsigned char type, STREAM_TYPE_STORE_ERASE, STREAM_TYPE_STORE_ROW or STREAM_TYPE_STORE_CHECK
+     *      2. const unsigned char *payload, the payload of the stream frame
+     * Return
+     *      unsigned char, 1 if it worked (answered with STREAM_ACK), 0 if not (STREAM_NAK)
+     */
+    unsigned char anim_store_command(unsigned char type, const unsigned char *payload);
+
+#ifdef	__cplusplus
+}
+#endif /* __cplusplus */
+
+#endif	/* ANIM_STORE_H */
@@ -18,8 +18,8 @@ extern "C" {
     * Description
     *       Created in assembly code through repeating the ?nop? operation 1593 times which 
     *       corresponds to roughly a hundred microseconds using the 16 MHz clock. This assembly 
-    *       function was implemented in the Ndelay function to essentially create a consistent 
-    *       delay that we would use throughout our project.
+    *       function was used by the Ndelay function until the timer based delays in Timer.h, 
+    *       which are derived from FCY, replaced it.
     * Parameters 
     *       void 
     * Return
@@ -45,7 +45,10 @@ extern "C" {
      *      Created in assembly code, containing instructions for a high pulse of 6 instruction 
      *      cycles followed by a low value for 14 instruction cycles which correspond to 0.375µs 
      *      and 0.875µs respectively. From the datasheet, this period of 20 clock cycles is 
-     *      interpreted as a ?0? bit by the LED matrix.
+     *      interpreted as a ?0? bit by the LED matrix. Only RA0 is toggled (bset/bclr), so the 
+     *      rest of LATA keeps its value.
+     *      The counts are T0H_CYCLES and TBIT_CYCLES, generated from FCY_KHZ in Assembly.s 
+     *      (the numbers above are for 16 MIPS).
      * Parameters 
      *      void
      * Return
@@ -58,13 +61,31 @@ extern "C" {
      *      Created in assembly code, containing instructions for a high pulse of 12 instruction 
      *      cycles followed by a low value for 8 instruction cycles which correspond to 0.750µs 
      *      and 0.500µs respectively. From the datasheet, this period of 20 clock cycles is 
-     *      interpreted as a ?1? bit by the LED matrix.
+     *      interpreted as a ?1? bit by the LED matrix. Only RA0 is toggled (bset/bclr), so the 
+     *      rest of LATA keeps its value.
+     *      The counts are T1H_CYCLES and TBIT_CYCLES, generated from FCY_KHZ in Assembly.s 
+     *      (the numbers above are for 16 MIPS).
      * Parameters 
      *      void
      * Return
      *      void
      */
     void write_1(void);
+    
+    /*
+     * Description
+     *      Drives up to 8 LED strings at once on RB8-RB15 (string n on RB(8+n)). Each byte of the 
+     *      plane buffer holds one bit time for every string: bit n set means string n sends a '1'. 
+     *      Every bit time uses the same generated timing as write_0 and write_1, so 8 strings are 
+     *      refreshed in the time of one. Only the pins in the mask are changed.
+     * Parameters 
+     *      1. const unsigned char *planes, the bit planes (one byte per bit time)
+     *      2. unsigned int count, number of planes to send
+     *      3. unsigned char mask, data lines in use (bit n = RB(8+n))
+     * Return
+     *      void
+     */
+    void write_parallel(const unsigned char *planes, unsigned int count, unsigned char mask);
 #ifdef	__cplusplus
 }
 #endif
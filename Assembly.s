@@ -10,14 +10,56 @@
 ; we will need a .global statement to make available ASM functions to C code.
 ; All functions utilized outside of this file will need to have a leading
 ; underscore (_) and be included in a comment delimited list below.
-.global _example_public_function, _second_public_function, _delay_hund_uS, _delay_MS, _write_0, _write_1
+.global _example_public_function, _second_public_function, _delay_hund_uS, _delay_MS, _write_0, _write_1, _write_parallel
+
+; WS2812 bit timing, generated from the instruction clock. FCY_KHZ must match FCY in Timer.h;
+; for another clock assemble with --defsym FCY_KHZ=<FCY in kHz>. Every count is rounded to the
+; nearest instruction cycle (6, 12 and 20 cycles at 16 MIPS).
+.ifndef FCY_KHZ
+.equ FCY_KHZ, 16000
+.endif
+.equ T0H_NS, 375                ; high time of a '0'
+.equ T1H_NS, 750                ; high time of a '1'
+.equ TBIT_NS, 1250              ; whole bit
+.equ T0H_CYCLES, (FCY_KHZ * T0H_NS + 500000) / 1000000
+.equ T1H_CYCLES, (FCY_KHZ * T1H_NS + 500000) / 1000000
+.equ TBIT_CYCLES, (FCY_KHZ * TBIT_NS + 500000) / 1000000
+
+; Instructions that fall in the low time after a bit: bclr, return and the next call of write_0 or
+; write_1, and the last 'and' and the loop back to ior in write_parallel
+.equ CALL_CYCLES, 6
+.equ LOOP_CYCLES, 7
+
+; write_parallel needs one cycle between raising the lines and each of the two 'and' steps
+.if T0H_CYCLES < 2
+.error "FCY_KHZ is too slow to meet the WS2812 T0H time"
+.endif
+.if (T1H_CYCLES - T0H_CYCLES) < 2
+.error "FCY_KHZ is too slow to meet the WS2812 T1H time"
+.endif
+; The low time of a '1' has to hold those instructions, or every '1' comes out longer than TBIT
+; (below about 14 MIPS, so 8 MIPS is refused)
+.if (TBIT_CYCLES - T1H_CYCLES) < LOOP_CYCLES
+.error "FCY_KHZ is too slow to fit the WS2812 low time of a '1' between bits"
+.endif
+
+; Busy wait of exactly n instruction cycles (nothing for n <= 0). repeat #k runs the next
+; instruction k+1 times, so repeat + nop takes k+2 cycles.
+.macro delay_cycles n
+    .if (\n) == 1
+    nop
+    .elseif (\n) >= 2
+    repeat #((\n) - 2)
+    nop
+    .endif
+.endm
 
     /*
     * Description
     *       Created in assembly code through repeating the ?nop? operation 1593 times which 
     *       corresponds to roughly a hundred microseconds using the 16 MHz clock. This assembly 
-    *       function was implemented in the Ndelay function to essentially create a consistent 
-    *       delay that we would use throughout our project.
+    *       function was used by the Ndelay function until the timer based delays in Timer.h, 
+    *       which are derived from FCY, replaced it.
     * Parameters 
     *       void 
     * Return
@@ -50,19 +92,20 @@
      *      Created in assembly code, containing instructions for a high pulse of 6 instruction 
      *      cycles followed by a low value for 14 instruction cycles which correspond to 0.375s 
      *      and 0.875s respectively. From the datasheet, this period of 20 clock cycles is 
-     *      interpreted as a ?0? bit by the LED matrix.
+     *      interpreted as a ?0? bit by the LED matrix. Only RA0 is toggled (bset/bclr), so the 
+     *      rest of LATA keeps its value.
+     *      The counts are T0H_CYCLES and TBIT_CYCLES, generated from FCY_KHZ above 
+     *      (the numbers above are for 16 MIPS).
      * Parameters 
      *      void
      * Return
      *      void
      */
     _write_0: 
-    inc LATA;
-    repeat #3
-    nop
-    clr LATA;
-    repeat #6
-    nop
+    bset LATA, #0
+    delay_cycles (T0H_CYCLES - 1)
+    bclr LATA, #0
+    delay_cycles (TBIT_CYCLES - T0H_CYCLES - CALL_CYCLES) ; bclr, return and the next call
     return
     
     /*
@@ -70,19 +113,90 @@
      *      Created in assembly code, containing instructions for a high pulse of 12 instruction 
      *      cycles followed by a low value for 8 instruction cycles which correspond to 0.750s 
      *      and 0.500s respectively. From the datasheet, this period of 20 clock cycles is 
-     *      interpreted as a ?1? bit by the LED matrix.
+     *      interpreted as a ?1? bit by the LED matrix. Only RA0 is toggled (bset/bclr), so the 
+     *      rest of LATA keeps its value.
+     *      The counts are T1H_CYCLES and TBIT_CYCLES, generated from FCY_KHZ above 
+     *      (the numbers above are for 16 MIPS).
      * Parameters 
      *      void
      * Return
      *      void
      */
     _write_1:
-    inc LATA;
-    repeat #9
-    nop
-    clr LATA;
-    nop
-    nop
+    bset LATA, #0
+    delay_cycles (T1H_CYCLES - 1)
+    bclr LATA, #0
+    delay_cycles (TBIT_CYCLES - T1H_CYCLES - CALL_CYCLES) ; bclr, return and the next call
+    return
+    
+    /*
+     * Description
+     *      Drives up to 8 LED strings at once on RB8-RB15 (string n on RB(8+n)). Each byte of the 
+     *      plane buffer holds one bit time for every string: bit n set means string n sends a '1'. 
+     *      Every bit time is TBIT_CYCLES: all data lines in the mask go high, the lines sending 
+     *      a '0' go low after T0H_CYCLES and the rest go low after T1H_CYCLES, the same timing as 
+     *      write_0 and write_1 (20, 6 and 12 cycles at 16 MIPS). The port is only changed with ior/and on the high 
+     *      byte of LATB, so pins that are not in the mask are left untouched.
+     * Parameters 
+     *      W0, pointer to the bit planes (one byte per bit time)
+     *      W1, number of planes to send
+     *      W2, mask of the data lines in use (bit n = RB(8+n))
+     * Return
+     *      void
+     */
+    _write_parallel:
+    cp0 W1
+    bra z, write_parallel_done
+    mov W0, W3              ; W3 walks through the planes
+    com.b W2, W4            ; W4 = pins that are not data lines
+    write_parallel_loop:
+    mov.b [W3++], W5
+    ior.b W5, W4, W5        ; clear mask for the '0' lines only
+    mov.b W2, W0
+    ior.b LATB+1            ; t = 0, all data lines high
+    mov.b W5, W0
+    delay_cycles (T0H_CYCLES - 2)
+    and.b LATB+1            ; t = T0H, lines sending '0' go low
+    mov.b W4, W0
+    delay_cycles (T1H_CYCLES - T0H_CYCLES - 2)
+    and.b LATB+1            ; t = T1H, lines sending '1' go low
+    delay_cycles (TBIT_CYCLES - T1H_CYCLES - LOOP_CYCLES) ; this 'and' and the loop back to ior
+    dec W1, W1
+    bra nz, write_parallel_loop ; next plane starts at t = TBIT
+    write_parallel_done:
     return
 
 
+.ifdef PROFILE
+.global __T4Interrupt
+    /*
+     * Description
+     *      Timer4 interrupt of the sampling profiler (Profile.h), only assembled with 
+     *      --defsym PROFILE=1. The CPU pushes the interrupted PC<15:0> and then SR<7:0>, IPL3 and 
+     *      PC<22:16> when it takes the interrupt; both are read back from under the registers saved 
+     *      here and handed to profile_sample with TMR4, the cycles since the timer matched.
+     *      W0-W7 and RCOUNT are saved because a C function may use them.
+     * Parameters 
+     *      void
+     * Return
+     *      void
+     */
+    __T4Interrupt:
+    push.d W0
+    push.d W2
+    push.d W4
+    push.d W6
+    push RCOUNT             ; 9 words (18 bytes) pushed since the CPU pushed the PC
+    mov TMR4, W2            ; profile_sample(pc, late): pc in W1:W0, late in W2
+    mov [W15-22], W0        ; PC<15:0>
+    mov [W15-20], W1
+    and #0x7F, W1           ; PC<22:16>
+    bclr IFS1, #T4IF
+    call _profile_sample
+    pop RCOUNT
+    pop.d W6
+    pop.d W4
+    pop.d W2
+    pop.d W0
+    retfie
+.endif
@@ -0,0 +1,170 @@
+/*
+ * File Description
+ *      Source file for the 8x8 bitboard library. All of the transforms work on the whole 64-bit 
+ *      word at once with shifts and masks, so none of them loop over rows or pixels.
+ */
+
+#include "xc.h"
+#include "Bitboard.h"
+#include "Frame_buffer.h"
+
+#define BB_EACH_ROW 0x0101010101010101ULL // Multiply a byte by this to copy it into every row
+
+/*
+ * Description
+ *      Packs 8 row patterns (top row first, bit 0x80 is the left-most LED) into a bitboard.
+ * Parameters 
+ *      1. const unsigned char rows[8], row patterns
+ * Return
+ *      bitboard, the packed frame
+ */
+bitboard bb_from_rows(const unsigned char rows[8]) {
+
+    bitboard b = 0;
+    int y;
+
+    for (y = 0; y < 8; y++)
+        b = (b << 8) | rows[y];
+    return b;
+}
+
+/*
+ * Description
+ *      Moves every pixel by dx columns and dy rows. Pixels that leave the matrix are dropped and 
+ *      nothing wraps around. Moves of 8 or more in either direction give an empty frame.
+ * Parameters 
+ *      1. bitboard b, frame to move
+ *      2. int dx, columns to move (positive is to the right)
+ *      3. int dy, rows to move (positive is down)
+ * Return
+ *      bitboard, the moved frame
+ */
+bitboard bb_shift(bitboard b, int dx, int dy) {
+
+    if (dx >= 8 || dx <= -8 || dy >= 8 || dy <= -8)
+        return 0;
+
+    // Columns: shift the whole word, then clear the bits that crossed into the next row
+    if (dx > 0)
+        b = (b >> dx) & (BB_EACH_ROW * (0xFF >> dx));
+    else if (dx < 0)
+        b = (b << -dx) & (BB_EACH_ROW * (0xFF & (0xFF << -dx)));
+
+    // Rows: each row is one byte, so moving down is a right shift by whole bytes
+    if (dy > 0)
+        b = b >> (8 * dy);
+    else if (dy < 0)
+        b = b << (8 * -dy);
+
+    return b;
+}
+
+/*
+ * Description
+ *      Mirrors the frame top to bottom (reverses the order of the rows).
+ * Parameters 
+ *      1. bitboard b, frame to flip
+ * Return
+ *      bitboard, the flipped frame
+ */
+bitboard bb_flip_vertical(bitboard b) {
+
+    b = ((b >> 8) & 0x00FF00FF00FF00FFULL) | ((b & 0x00FF00FF00FF00FFULL) << 8);
+    b = ((b >> 16) & 0x0000FFFF0000FFFFULL) | ((b & 0x0000FFFF0000FFFFULL) << 16);
+    return (b >> 32) | (b << 32);
+}
+
+/*
+ * Description
+ *      Mirrors the frame left to right (reverses the bits in every row).
+ * Parameters 
+ *      1. bitboard b, frame to flip
+ * Return
+ *      bitboard, the flipped frame
+ */
+bitboard bb_flip_horizontal(bitboard b) {
+
+    b = ((b >> 1) & 0x5555555555555555ULL) | ((b & 0x5555555555555555ULL) << 1);
+    b = ((b >> 2) & 0x3333333333333333ULL) | ((b & 0x3333333333333333ULL) << 2);
+    return ((b >> 4) & 0x0F0F0F0F0F0F0F0FULL) | ((b & 0x0F0F0F0F0F0F0F0FULL) << 4);
+}
+
+/*
+ * Description
+ *      Swaps rows and columns, so the pixel at (x, y) moves to (y, x). Done as three delta swaps: 
+ *      4x4 blocks, then 2x2 blocks, then single pixels across the diagonal.
+ * Parameters 
+ *      1. bitboard b, frame to transpose
+ * Return
+ *      bitboard, the transposed frame
+ */
+bitboard bb_transpose(bitboard b) {
+
+    bitboard t;
+
+    t = 0x0F0F0F0F00000000ULL & (b ^ (b << 28));
+    b ^= t ^ (t >> 28);
+    t = 0x3333000033330000ULL & (b ^ (b << 14));
+    b ^= t ^ (t >> 14);
+    t = 0x5500550055005500ULL & (b ^ (b << 7));
+    b ^= t ^ (t >> 7);
+    return b;
+}
+
+/*
+ * Description
+ *      Rotates the frame by 90 degrees clockwise.
+ * Parameters 
+ *      1. bitboard b, frame to rotate
+ * Return
+ *      bitboard, the rotated frame
+ */
+bitboard bb_rotate_cw(bitboard b) {
+    return bb_flip_horizontal(bb_transpose(b));
+}
+
+/*
+ * Description
+ *      Rotates the frame by 90 degrees counter-clockwise.
+ * Parameters 
+ *      1. bitboard b, frame to rotate
+ * Return
+ *      bitboard, the rotated frame
+ */
+bitboard bb_rotate_ccw(bitboard b) {
+    return bb_flip_vertical(bb_transpose(b));
+}
+
+/*
+ * Description
+ *      Combines two frames: pixels inside the mask come from b, the others come from a.
+ * Parameters 
+ *      1. bitboard a, frame used outside the mask
+ *      2. bitboard b, frame used inside the mask
+ *      3. bitboard mask, pixels to take from b
+ * Return
+ *      bitboard, the merged frame
+ */
+bitboard bb_merge(bitboard a, bitboard b, bitboard mask) {
+    return a ^ ((a ^ b) & mask);
+}
+
+/*
+ * Description
+ *      Draws a bitboard into the frame buffer. Lit pixels get the given color and the others 
+ *      are turned off. The colors are given in the same order as writeColor.
+ * Parameters 
+ *      1. bitboard b, frame to draw
+ *      2. unsigned char r, first color byte (same as writeColor)
+ *      3. unsigned char g, second color byte (same as writeColor)
+ *      4. unsigned char bl, third color byte (same as writeColor)
+ * Return
+ *      void
+ */
+void bb_draw(bitboard b, unsigned char r, unsigned char g, unsigned char bl) {
+
+    unsigned char y;
+
+    for (y = 0; y < 8; y++)
+        frame_draw_row(y, bb_row(b, y), r, g, bl);
+}
@@ -0,0 +1,131 @@
+/*
+ * File Description
+ *      Header file for the 8x8 bitboard library used to move and transform whole frames.
+ * 
+ * Background
+ *      A bitboard packs one 8x8 frame into a single 64-bit word. The top row is the most significant 
+ *      byte and, like the row patterns used by the animations, bit 0x80 of each byte is the left-most 
+ *      LED. The banana frame from Fruit_animation.h becomes 0x0207070F1E7EFC70. With every pixel in 
+ *      one word, moving or turning a frame is a handful of shifts and masks on the whole word (SWAR, 
+ *      SIMD within a register) instead of loops over rows, and pixels that move off the edge simply 
+ *      fall out of the word, so no padding rows are needed.
+ */
+
+#ifndef BITBOARD_H
+#define	BITBOARD_H
+
+#include <xc.h> // include processor files - each processor file is guarded.  
+
+#ifdef	__cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+    typedef unsigned long long bitboard;
+
+    // Row y (0 is the top row) of a bitboard, bit 0x80 is the left-most LED
+    #define bb_row(b, y) ((unsigned char) ((b) >> (56 - 8 * (y))))
+
+    /*
+     * Description
+     *      Packs 8 row patterns (top row first, bit 0x80 is the left-most LED) into a bitboard.
+     * Parameters 
+     *      1. const unsigned char rows[8], row patterns
+     * Return
+     *      bitboard, the packed frame
+     */
+    bitboard bb_from_rows(const unsigned char rows[8]);
+
+    /*
+     * Description
+     *      Moves every pixel by dx columns and dy rows. Pixels that leave the matrix are dropped and 
+     *      nothing wraps around. Moves of 8 or more in either direction give an empty frame.
+     * Parameters 
+     *      1. bitboard b, frame to move
+     *      2. int dx, columns to move (positive is to the right)
+     *      3. int dy, rows to move (positive is down)
+     * Return
+     *      bitboard, the moved frame
+     */
+    bitboard bb_shift(bitboard b, int dx, int dy);
+
+    /*
+     * Description
+     *      Mirrors the frame top to bottom (reverses the order of the rows).
+     * Parameters 
+     *      1. bitboard b, frame to flip
+     * Return
+     *      bitboard, the flipped frame
+     */
+    bitboard bb_flip_vertical(bitboard b);
+
+    /*
+     * Description
+     *      Mirrors the frame left to right (reverses the bits in every row).
+     * Parameters 
+     *      1. bitboard b, frame to flip
+     * Return
+     *      bitboard, the flipped frame
+     */
+    bitboard bb_flip_horizontal(bitboard b);
+
+    /*
+     * Description
+     *      Swaps rows and columns, so the pixel at (x, y) moves to (y, x).
+     * Parameters 
+     *      1. bitboard b, frame to transpose
+     * Return
+     *      bitboard, the transposed frame
+     */
+    bitboard bb_transpose(bitboard b);
+
+    /*
+     * Description
+     *      Rotates the frame by 90 degrees clockwise.
+     * Parameters 
+     *      1. bitboard b, frame to rotate
+     * Return
+     *      bitboard, the rotated frame
+     */
+    bitboard bb_rotate_cw(bitboard b);
+
+    /*
+     * Description
+     *      Rotates the frame by 90 degrees counter-clockwise.
+     * Parameters 
+     *      1. bitboard b, frame to rotate
+     * Return
+     *      bitboard, the rotated frame
+     */
+    bitboard bb_rotate_ccw(bitboard b);
+
+    /*
+     * Description
+     *      Combines two frames: pixels inside the mask come from b, the others come from a.
+     * Parameters 
+     *      1. bitboard a, frame used outside the mask
+     *      2. bitboard b, frame used inside the mask
+     *      3. bitboard mask, pixels to take from b
+     * Return
+     *      bitboard, the merged frame
+     */
+    bitboard bb_merge(bitboard a, bitboard b, bitboard mask);
+
+    /*
+     * Description
+     *      Draws a bitboard into the frame buffer. Lit pixels get the given color and the others 
+     *      are turned off. The colors are given in the same order as writeColor.
+     * Parameters 
+     *      1. bitboard b, frame to draw
+     *      2. unsigned char r, first color byte (same as writeColor)
+     *      3. unsigned char g, second color byte (same as writeColor)
+     *      4. unsigned char bl, third color byte (same as writeColor)
+     * Return
+     *      void
+     */
+    void bb_draw(bitboard b, unsigned char r, unsigned char g, unsigned char bl);
+
+#ifdef	__cplusplus
+}
+#endif /* __cplusplus */
+
+#endif	/* BITBOARD_H */
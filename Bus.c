@@ -0,0 +1,119 @@
+/*
+ * File Description
+ *      Source file for the I2C bus scheduler. Jobs are kept in a list in the order they were 
+ *      added, which is also the order they run in when several are due.
+ */
+
+#include "xc.h"
+#include "Bus.h"
+
+static bus_job_t *jobs;
+static bus_stats_t totals;
+
+/*
+ * Description
+ *      Registers a periodic job. The job is due right away. The job structure has to stay 
+ *      valid for as long as the program runs.
+ * Parameters 
+ *      1. bus_job_t *job, the job with run, period_ms and cost_us filled in
+ * Return
+ *      void
+ */
+void bus_add(bus_job_t *job)
+{
+    bus_job_t **last = &jobs;
+
+    while (*last != 0)
+        last = &(*last)->next;
+    job->due = timer_now();
+    job->next = 0;
+    *last = job;
+}
+
+/*
+ * Description
+ *      Runs one job that is due, records how late it was, and sets its next due time. If it fell 
+ *      a whole period or more behind, the missed periods are counted and it is rescheduled from now.
+ * Parameters 
+ *      1. bus_job_t *job, the job
+ * Return
+ *      void
+ */
+static void run_job(bus_job_t *job)
+{
+    unsigned long now = timer_now();
+    unsigned long late = now - job->due;
+    unsigned long period = (unsigned long) job->period_ms * TIMER_COUNTS_PER_MS;
+
+    totals.runs++;
+    totals.deferred_us += late / TIMER_COUNTS_PER_US;
+    if (late / TIMER_COUNTS_PER_US > totals.max_late_us)
+        totals.max_late_us = late / TIMER_COUNTS_PER_US;
+    if (late >= period) {
+        totals.missed += late / period;
+        job->due = now;
+    }
+    job->due += period;
+
+    job->run();
+}
+
+/*
+ * Description
+ *      Runs every job that is due, without a time limit. Used by the main loop when no frame 
+ *      is waiting to be sent.
+ * Parameters 
+ *      void
+ * Return
+ *      void
+ */
+void bus_poll(void)
+{
+    bus_job_t *job;
+
+    for (job = jobs; job != 0; job = job->next) {
+        if (deadline_expired(job->due))
+            run_job(job);
+    }
+}
+
+/*
+ * Description
+ *      Waits until a deadline (usually the next frame), running the jobs that come due in the 
+ *      meantime when they fit before it. Between jobs the CPU idles in wait_until, up to the 
+ *      next job or the deadline, whichever comes first.
+ * Parameters 
+ *      1. deadline_t deadline, end of the gap
+ * Return
+ *      void
+ */
+void bus_wait_until(deadline_t deadline)
+{
+    bus_job_t *job;
+    deadline_t wake;
+
+    while (!deadline_expired(deadline)) {
+        wake = deadline;
+        for (job = jobs; job != 0; job = job->next) {
+            if (deadline_expired(job->due) && 
+                (long) (deadline - timer_now()) > (long) ((unsigned long) job->cost_us * TIMER_COUNTS_PER_US))
+                run_job(job); // Fits in the gap
+            if (!deadline_expired(job->due) && (long) (job->due - wake) < 0)
+                wake = job->due;
+        }
+        wait_until(wake); // Jobs that did not fit are left for the next gap
+    }
+}
+
+/*
+ * Description
+ *      Statistics since start up.
+ * Parameters 
+ *      1. bus_stats_t *stats, filled in with the statistics
+ * Return
+ *      void
+ */
+void bus_stats(bus_stats_t *stats)
+{
+    *stats = totals;
+}
@@ -0,0 +1,91 @@
+/*
+ * File Description
+ *      Header file for the I2C bus scheduler, which fits the sensor transactions into the gaps 
+ *      between LED frames. 
+ * 
+ * Background
+ *      Sending a frame to the LEDs has to run with interrupts masked for about 2 ms, and an I2C 
+ *      transaction polls the bus for up to a few milliseconds. Both run on the main loop, so they 
+ *      can never overlap, but a transaction that starts just before a frame is due makes the 
+ *      frame late, and a long animation would keep the sensors from being read at all. Instead of 
+ *      touching the bus directly, sensor work is registered as periodic jobs with their worst-case 
+ *      time. bus_wait_until replaces the plain waits between frames and runs the jobs that are due 
+ *      whenever they fit before the next frame, and idles otherwise. A job that does not fit is 
+ *      held for the next gap. The time jobs spend held back is added up as deferred time, and a 
+ *      job that is held back for a whole period or more counts as missed deadlines. I2C stays 
+ *      polled, so no I2C interrupt can land in the middle of a frame push.
+ */
+
+#ifndef BUS_H
+#define	BUS_H
+
+#include <xc.h> // include processor files - each processor file is guarded.  
+#include "Timer.h"
+
+#ifdef	__cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+    typedef struct bus_job {
+        void (*run)(void);      // Does the bus transactions of the job
+        unsigned int period_ms; // How often the job should run
+        unsigned int cost_us;   // Longest time run takes
+        deadline_t due;         // When the job should run next
+        struct bus_job *next;   // Next registered job
+    } bus_job_t;
+
+    typedef struct {
+        unsigned long runs;        // Jobs run
+        unsigned long deferred_us; // Total time jobs waited after they were due
+        unsigned long max_late_us; // Longest time a job waited after it was due
+        unsigned long missed;      // Whole periods jobs fell behind
+    } bus_stats_t;
+
+    /*
+     * Description
+     *      Registers a periodic job. The job is due right away. The job structure has to stay 
+     *      valid for as long as the program runs.
+     * Parameters 
+     *      1. bus_job_t *job, the job with run, period_ms and cost_us filled in
+     * Return
+     *      void
+     */
+    void bus_add(bus_job_t *job);
+
+    /*
+     * Description
+     *      Runs every job that is due, without a time limit. Used by the main loop when no frame 
+     *      is waiting to be sent.
+     * Parameters 
+     *      void
+     * Return
+     *      void
+     */
+    void bus_poll(void);
+
+    /*
+     * Description
+     *      Waits until a deadline (usually the next frame), running the jobs that come due in the 
+     *      meantime when they fit before it.
+     * Parameters 
+     *      1. deadline_t deadline, end of the gap
+     * Return
+     *      void
+     */
+    void bus_wait_until(deadline_t deadline);
+
+    /*
+     * Description
+     *      Statistics since start up.
+     * Parameters 
+     *      1. bus_stats_t *stats, filled in with the statistics
+     * Return
+     *      void
+     */
+    void bus_stats(bus_stats_t *stats);
+
+#ifdef	__cplusplus
+}
+#endif /* __cplusplus */
+
+#endif	/* BUS_H */
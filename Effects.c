@@ -0,0 +1,406 @@
+/*
+ * File Description
+ *      Source file for the procedural effects. Every effect keeps its state in a few Q8.8 phases, 
+ *      and the fire also in a small heat map, so a frame is drawn from scratch in one pass over the 
+ *      pixels.
+ */
+
+#include "xc.h"
+#include "Effects.h"
+#include "Frame_buffer.h"
+#include "Event_queue.h"
+#include "Bus.h"
+
+#define PALETTE_SIZE 64
+#define PLASMA_SPEED_1 0x0180   // Phase steps per frame, Q8.8 (1.5 sine steps)
+#define PLASMA_SPEED_2 0x00E0
+#define PLASMA_SPEED_3 0x0240
+#define PLASMA_COLOR_SPEED 0x0080 // Palette shift per frame, Q8.8
+#define FIRE_SPARK_MIN 160      // Heat of the hidden row under the bottom row
+#define FIRE_COOLING 31         // Most heat a cell loses while rising one row
+#define RIPPLE_SPEED 0x0060     // Growth of the ripple radius per frame, Q8.8 (0.375 pixels)
+#define RIPPLE_FADE 8           // Amplitude lost per frame (out of 255)
+#define RIPPLE_Y 4              // Row the ripples start from
+
+// sin(2 pi i / 256) * 127
+static const signed char sine[256] = {
+    0, 3, 6, 9, 12, 16, 19, 22, 25, 28, 31, 34, 37, 40, 43, 46,
+    49, 51, 54, 57, 60, 63, 65, 68, 71, 73, 76, 78, 81, 83, 85, 88,
+    90, 92, 94, 96, 98, 100, 102, 104, 106, 107, 109, 111, 112, 113, 115, 116,
+    117, 118, 120, 121, 122, 122, 123, 124, 125, 125, 126, 126, 126, 127, 127, 127,
+    127, 127, 127, 127, 126, 126, 126, 125, 125, 124, 123, 122, 122, 121, 120, 118,
+    117, 116, 115, 113, 112, 111, 109, 107, 106, 104, 102, 100, 98, 96, 94, 92,
+    90, 88, 85, 83, 81, 78, 76, 73, 71, 68, 65, 63, 60, 57, 54, 51,
+    49, 46, 43, 40, 37, 34, 31, 28, 25, 22, 19, 16, 12, 9, 6, 3,
+    0, -3, -6, -9, -12, -16, -19, -22, -25, -28, -31, -34, -37, -40, -43, -46,
+    -49, -51, -54, -57, -60, -63, -65, -68, -71, -73, -76, -78, -81, -83, -85, -88,
+    -90, -92, -94, -96, -98, -100, -102, -104, -106, -107, -109, -111, -112, -113, -115, -116,
+    -117, -118, -120, -121, -122, -122, -123, -124, -125, -125, -126, -126, -126, -127, -127, -127,
+    -127, -127, -127, -127, -126, -126, -126, -125, -125, -124, -123, -122, -122, -121, -120, -118,
+    -117, -116, -115, -113, -112, -111, -109, -107, -106, -104, -102, -100, -98, -96, -94, -92,
+    -90, -88, -85, -83, -81, -78, -76, -73, -71, -68, -65, -63, -60, -57, -54, -51,
+    -49, -46, -43, -40, -37, -34, -31, -28, -25, -22, -19, -16, -12, -9, -6, -3
+};
+
+// Distance between two pixels dx and dy apart (dy * 8 + dx), Q4.4
+static const unsigned char distance[FRAME_PIXELS] = {
+    0, 16, 32, 48, 64, 80, 96, 112,
+    16, 23, 36, 51, 66, 82, 97, 113,
+    32, 36, 45, 58, 72, 86, 101, 116,
+    48, 51, 58, 68, 80, 93, 107, 122,
+    64, 66, 72, 80, 91, 102, 115, 129,
+    80, 82, 86, 93, 102, 113, 125, 138,
+    96, 97, 101, 107, 115, 125, 136, 148,
+    112, 113, 116, 122, 129, 138, 148, 158
+};
+
+// Color wheel, in writeColor order
+static const unsigned char plasma_palette[PALETTE_SIZE][3] = {
+    { 200, 0, 0 },
+    { 200, 19, 0 },
+    { 200, 38, 0 },
+    { 200, 56, 0 },
+    { 200, 75, 0 },
+    { 200, 94, 0 },
+    { 200, 112, 0 },
+    { 200, 131, 0 },
+    { 200, 150, 0 },
+    { 200, 169, 0 },
+    { 200, 188, 0 },
+    { 194, 200, 0 },
+    { 175, 200, 0 },
+    { 156, 200, 0 },
+    { 138, 200, 0 },
+    { 119, 200, 0 },
+    { 100, 200, 0 },
+    { 81, 200, 0 },
+    { 62, 200, 0 },
+    { 44, 200, 0 },
+    { 25, 200, 0 },
+    { 6, 200, 0 },
+    { 0, 200, 12 },
+    { 0, 200, 31 },
+    { 0, 200, 50 },
+    { 0, 200, 69 },
+    { 0, 200, 88 },
+    { 0, 200, 106 },
+    { 0, 200, 125 },
+    { 0, 200, 144 },
+    { 0, 200, 162 },
+    { 0, 200, 181 },
+    { 0, 200, 200 },
+    { 0, 181, 200 },
+    { 0, 162, 200 },
+    { 0, 144, 200 },
+    { 0, 125, 200 },
+    { 0, 106, 200 },
+    { 0, 88, 200 },
+    { 0, 69, 200 },
+    { 0, 50, 200 },
+    { 0, 31, 200 },
+    { 0, 12, 200 },
+    { 6, 0, 200 },
+    { 25, 0, 200 },
+    { 44, 0, 200 },
+    { 62, 0, 200 },
+    { 81, 0, 200 },
+    { 100, 0, 200 },
+    { 119, 0, 200 },
+    { 138, 0, 200 },
+    { 156, 0, 200 },
+    { 175, 0, 200 },
+    { 194, 0, 200 },
+    { 200, 0, 188 },
+    { 200, 0, 169 },
+    { 200, 0, 150 },
+    { 200, 0, 131 },
+    { 200, 0, 112 },
+    { 200, 0, 94 },
+    { 200, 0, 75 },
+    { 200, 0, 56 },
+    { 200, 0, 38 },
+    { 200, 0, 19 }
+};
+
+// Black through red and yellow to white, in writeColor order
+static const unsigned char fire_palette[PALETTE_SIZE][3] = {
+    { 0, 0, 0 },
+    { 12, 0, 0 },
+    { 24, 0, 0 },
+    { 36, 0, 0 },
+    { 49, 0, 0 },
+    { 61, 0, 0 },
+    { 73, 0, 0 },
+    { 85, 0, 0 },
+    { 97, 0, 0 },
+    { 109, 0, 0 },
+    { 121, 0, 0 },
+    { 134, 0, 0 },
+    { 146, 0, 0 },
+    { 158, 0, 0 },
+    { 170, 0, 0 },
+    { 182, 0, 0 },
+    { 194, 0, 0 },
+    { 206, 0, 0 },
+    { 219, 0, 0 },
+    { 231, 0, 0 },
+    { 243, 0, 0 },
+    { 255, 0, 0 },
+    { 255, 10, 0 },
+    { 255, 19, 0 },
+    { 255, 29, 0 },
+    { 255, 38, 0 },
+    { 255, 48, 0 },
+    { 255, 57, 0 },
+    { 255, 67, 0 },
+    { 255, 76, 0 },
+    { 255, 86, 0 },
+    { 255, 95, 0 },
+    { 255, 105, 0 },
+    { 255, 114, 0 },
+    { 255, 124, 0 },
+    { 255, 133, 0 },
+    { 255, 143, 0 },
+    { 255, 152, 0 },
+    { 255, 162, 0 },
+    { 255, 171, 0 },
+    { 255, 181, 0 },
+    { 255, 190, 0 },
+    { 255, 200, 0 },
+    { 255, 200, 6 },
+    { 255, 200, 11 },
+    { 255, 200, 17 },
+    { 255, 200, 23 },
+    { 255, 200, 29 },
+    { 255, 200, 34 },
+    { 255, 200, 40 },
+    { 255, 200, 46 },
+    { 255, 200, 51 },
+    { 255, 200, 57 },
+    { 255, 200, 63 },
+    { 255, 200, 69 },
+    { 255, 200, 74 },
+    { 255, 200, 80 },
+    { 255, 200, 86 },
+    { 255, 200, 91 },
+    { 255, 200, 97 },
+    { 255, 200, 103 },
+    { 255, 200, 109 },
+    { 255, 200, 114 },
+    { 255, 200, 120 }
+};
+
+static unsigned char current;       // Effect being played
+static unsigned char ripple_x;      // Column the ripple starts from
+static unsigned int phase[3];       // Plasma phases, Q8.8
+static unsigned int color_phase;    // Plasma palette shift, Q8.8
+static unsigned int radius;         // Ripple radius, Q8.8 pixels
+static unsigned char amplitude;     // Ripple strength, fades to 0
+static unsigned char heat[FRAME_HEIGHT + 1][FRAME_WIDTH]; // Last row is the hidden fuel row
+static unsigned int lfsr = 0xACE1;  // Random numbers for the fire
+static effect_stats_t totals;
+
+/*
+ * Description
+ *      Next value of a 16-bit Galois LFSR (taps 16, 14, 13, 11), which repeats after 65535 values.
+ * Parameters 
+ *      void
+ * Return
+ *      unsigned int, pseudo random number, never 0
+ */
+static unsigned int next_random(void)
+{
+    lfsr = (lfsr >> 1) ^ (-(lfsr & 1) & 0xB400);
+    return lfsr;
+}
+
+/*
+ * Description
+ *      Sum of four sine waves across the matrix (along x, along y, along the diagonal and around 
+ *      the center), each moving at its own speed, looked up in the color wheel.
+ * Parameters 
+ *      void
+ * Return
+ *      void
+ */
+static void render_plasma(void)
+{
+    unsigned char x, y, dx, dy, index;
+    int v;
+
+    phase[0] += PLASMA_SPEED_1;
+    phase[1] += PLASMA_SPEED_2;
+    phase[2] += PLASMA_SPEED_3;
+    color_phase += PLASMA_COLOR_SPEED;
+
+    for (y = 0; y < FRAME_HEIGHT; y++) {
+        dy = y < 4 ? 4 - y : y - 4;
+        for (x = 0; x < FRAME_WIDTH; x++) {
+            dx = x < 4 ? 4 - x : x - 4;
+            v = sine[(unsigned char) (x * 20 + (phase[0] >> 8))];
+            v += sine[(unsigned char) (y * 24 + (phase[1] >> 8))];
+            v += sine[(unsigned char) ((x + y) * 12 + (phase[2] >> 8))];
+            v += sine[(unsigned char) (distance[dy * FRAME_WIDTH + dx] * 2 - (phase[0] >> 8))];
+            index = (unsigned char) ((v >> 2) + 128 + (color_phase >> 8)) >> 2; // 0 to 63
+            frame_set_pixel(x, y, plasma_palette[index][0], plasma_palette[index][1], plasma_palette[index][2]);
+        }
+    }
+}
+
+/*
+ * Description
+ *      Every cell takes the average heat of the three cells below it and cools down by a random 
+ *      amount, so heat rises from the hidden fuel row and fades on the way up. Rows are done 
+ *      from the top, so the row below still holds the last frame.
+ * Parameters 
+ *      void
+ * Return
+ *      void
+ */
+static void render_fire(void)
+{
+    unsigned char x, y, left, right;
+    unsigned int sum, cooling;
+
+    for (x = 0; x < FRAME_WIDTH; x++)
+        heat[FRAME_HEIGHT][x] = FIRE_SPARK_MIN + (next_random() & (255 - FIRE_SPARK_MIN));
+
+    for (y = 0; y < FRAME_HEIGHT; y++) {
+        for (x = 0; x < FRAME_WIDTH; x++) {
+            left = x > 0 ? x - 1 : x;
+            right = x < FRAME_WIDTH - 1 ? x + 1 : x;
+            sum = heat[y + 1][left] + 2 * heat[y + 1][x] + heat[y + 1][right];
+            cooling = next_random() & FIRE_COOLING;
+            heat[y][x] = (sum >> 2) > cooling ? (sum >> 2) - cooling : 0;
+            frame_set_pixel(x, y, fire_palette[heat[y][x] >> 2][0], fire_palette[heat[y][x] >> 2][1], 
+                            fire_palette[heat[y][x] >> 2][2]);
+        }
+    }
+}
+
+/*
+ * Description
+ *      Rings 4 pixels apart spreading from the fruit that was touched. Pixels the front has not 
+ *      reached yet stay dark, and the whole ripple fades as it grows.
+ * Parameters 
+ *      void
+ * Return
+ *      void
+ */
+static void render_ripple(void)
+{
+    unsigned char x, y, dx, dy, level;
+    unsigned int d;
+
+    radius += RIPPLE_SPEED;
+    amplitude = amplitude > RIPPLE_FADE ? amplitude - RIPPLE_FADE : 0;
+
+    for (y = 0; y < FRAME_HEIGHT; y++) {
+        dy = y < RIPPLE_Y ? RIPPLE_Y - y : y - RIPPLE_Y;
+        for (x = 0; x < FRAME_WIDTH; x++) {
+            dx = x < ripple_x ? ripple_x - x : x - ripple_x;
+            d = (unsigned int) distance[dy * FRAME_WIDTH + dx] << 4; // Q4.4 to Q8.8
+            if (d > radius) {
+                level = 0;
+            } else { // cos of the distance behind the front, one period every 4 pixels
+                // The product reaches 255 * 255, past a signed int
+                level = ((unsigned int) (sine[(unsigned char) (((radius - d) >> 2) + 64)] + 128) * amplitude) >> 8;
+            }
+            frame_set_pixel(x, y, 0, level >> 1, level);
+        }
+    }
+}
+
+/*
+ * Description
+ *      Starts an effect from its first frame.
+ * Parameters 
+ *      1. unsigned char effect, one of the EFFECT_ numbers
+ *      2. unsigned char arg, depends on the effect
+ * Return
+ *      void
+ */
+void effect_start(unsigned char effect, unsigned char arg)
+{
+    unsigned char x, y;
+
+    current = effect < EFFECT_COUNT ? effect : EFFECT_PLASMA;
+    phase[0] = 0;
+    phase[1] = 0x4000;
+    phase[2] = 0x8000;
+    color_phase = 0;
+    radius = 0;
+    amplitude = 255;
+    ripple_x = (arg & 3) * 2 + 1; // Fruits are 2 columns apart, left to right
+    for (y = 0; y <= FRAME_HEIGHT; y++)
+        for (x = 0; x < FRAME_WIDTH; x++)
+            heat[y][x] = 0;
+}
+
+/*
+ * Description
+ *      Draws the next frame of the effect started last into the frame buffer.
+ * Parameters 
+ *      void
+ * Return
+ *      void
+ */
+void effect_render(void)
+{
+    unsigned long started = timer_now();
+    unsigned long cycles;
+
+    if (current == EFFECT_FIRE)
+        render_fire();
+    else if (current == EFFECT_RIPPLE)
+        render_ripple();
+    else
+        render_plasma();
+
+    cycles = timer_now() - started; // Timer2/3 counts instruction cycles
+    if (cycles > totals.max_cycles[current])
+        totals.max_cycles[current] = cycles;
+    if (cycles > EFFECT_BUDGET_CYCLES)
+        totals.over_budget++;
+    totals.frames++;
+}
+
+/*
+ * Description
+ *      Plays an effect at EFFECT_FRAME_MS per frame, running the sensor jobs in the gaps, and 
+ *      stops early as soon as an event is queued (a touch, for example).
+ * Parameters 
+ *      1. unsigned char effect, one of the EFFECT_ numbers
+ *      2. unsigned char arg, depends on the effect
+ *      3. unsigned int frames, number of frames, 0 to play until an event is queued
+ * Return
+ *      unsigned int, frames shown
+ */
+unsigned int effect_play(unsigned char effect, unsigned char arg, unsigned int frames)
+{
+    deadline_t deadline = timer_now();
+    unsigned int shown = 0;
+
+    effect_start(effect, arg);
+    while ((frames == 0 || shown < frames) && !event_pending()) {
+        effect_render();
+        frame_show();
+        shown++;
+        deadline += (unsigned long) EFFECT_FRAME_MS * TIMER_COUNTS_PER_MS;
+        bus_wait_until(deadline);
+    }
+    return shown;
+}
+
+/*
+ * Description
+ *      Drawing time statistics since start up.
+ * Parameters 
+ *      1. effect_stats_t *stats, filled in with the statistics
+ * Return
+ *      void
+ */
+void effect_stats(effect_stats_t *stats)
+{
+    *stats = totals;
+}
@@ -0,0 +1,98 @@
+/*
+ * File Description
+ *      Header file for the procedural effects (plasma, fire and touch ripple) shown while nobody 
+ *      is touching the fruits.
+ * 
+ * Background
+ *      The effects are computed for every pixel of every frame instead of being stored, using 
+ *      integer math only: positions, phases and the ripple radius are Q8.8 fixed point (8 integer 
+ *      bits, 8 fraction bits), and sine, distance and color palettes are tables in flash. The 
+ *      sine table holds one period in 256 steps, so the high byte of a Q8.8 phase indexes it 
+ *      directly and phases wrap for free.
+ * 
+ *      Each effect draws into the frame buffer with frame_set_pixel and effect_play sends it with 
+ *      frame_show, the same way as the fruit animations. A frame is due every EFFECT_FRAME_MS (30 
+ *      fps); the push takes about 2 ms, which leaves EFFECT_BUDGET_CYCLES for drawing the next 
+ *      frame. effect_stats gives the longest time each effect took to draw a frame, measured in 
+ *      instruction cycles on the Timer2/3 counter, and how many frames went over the budget.
+ */
+
+#ifndef EFFECTS_H
+#define	EFFECTS_H
+
+#include <xc.h> // include processor files - each processor file is guarded.  
+#include "Timer.h"
+
+#ifdef	__cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+    #define EFFECT_PLASMA 0     // Moving color bands, arg unused
+    #define EFFECT_FIRE 1       // Flames rising from the bottom row, arg unused
+    #define EFFECT_RIPPLE 2     // Rings spreading from a fruit, arg = touch channel (0 to 3)
+    #define EFFECT_COUNT 3
+
+    #define EFFECT_FRAME_MS 33          // Time per frame, 30 fps
+    #define EFFECT_PUSH_MS 3            // Frame push with some margin
+    #define EFFECT_BUDGET_CYCLES ((unsigned long) (EFFECT_FRAME_MS - EFFECT_PUSH_MS) * TIMER_COUNTS_PER_MS)
+    #define EFFECT_RIPPLE_FRAMES 32     // Frames until a ripple has faded out
+
+    #if EFFECT_FRAME_MS > 33
+    #error "The effects have to run at 30 fps or more"
+    #endif
+
+    typedef struct {
+        unsigned long max_cycles[EFFECT_COUNT]; // Longest time to draw one frame of each effect
+        unsigned long frames;                   // Frames drawn
+        unsigned int over_budget;               // Frames that took more than EFFECT_BUDGET_CYCLES
+    } effect_stats_t;
+
+    /*
+     * Description
+     *      Starts an effect from its first frame.
+     * Parameters 
+     *      1. unsigned char effect, one of the EFFECT_ numbers
+     *      2. unsigned char arg, depends on the effect
+     * Return
+     *      void
+     */
+    void effect_start(unsigned char effect, unsigned char arg);
+
+    /*
+     * Description
+     *      Draws the next frame of the effect started last into the frame buffer.
+     * Parameters 
+     *      void
+     * Return
+     *      void
+     */
+    void effect_render(void);
+
+    /*
+     * Description
+     *      Plays an effect at EFFECT_FRAME_MS per frame, running the sensor jobs in the gaps, and 
+     *      stops early as soon as an event is queued (a touch, for example).
+     * Parameters 
+     *      1. unsigned char effect, one of the EFFECT_ numbers
+     *      2. unsigned char arg, depends on the effect
+     *      3. unsigned int frames, number of frames, 0 to play until an event is queued
+     * Return
+     *      unsigned int, frames shown
+     */
+    unsigned int effect_play(unsigned char effect, unsigned char arg, unsigned int frames);
+
+    /*
+     * Description
+     *      Drawing time statistics since start up.
+     * Parameters 
+     *      1. effect_stats_t *stats, filled in with the statistics
+     * Return
+     *      void
+     */
+    void effect_stats(effect_stats_t *stats);
+
+#ifdef	__cplusplus
+}
+#endif /* __cplusplus */
+
+#endif	/* EFFECTS_H */
@@ -0,0 +1,99 @@
+/*
+ * File Description
+ *      Source file for the lock-free event queue between the interrupt handlers and the main loop. 
+ *      head and tail count up forever (mod 256) and are masked when used as an index, so a full 
+ *      queue and an empty queue are told apart without wasting a slot.
+ */
+
+#include "xc.h"
+#include "Event_queue.h"
+#include "Timer.h"
+
+#define EVENT_MASK (EVENT_QUEUE_SIZE - 1)
+
+// Keeps the compiler from moving the slot accesses to the other side of a head or tail update
+#define COMPILER_BARRIER() __asm__ volatile ("" ::: "memory")
+
+static event_t events[EVENT_QUEUE_SIZE];
+static volatile unsigned char head;      // Next slot to write, only changed by the producer
+static volatile unsigned char tail;      // Next slot to read, only changed by the consumer
+static volatile unsigned int overflows;  // Only changed by the producer
+
+/*
+ * Description
+ *      Adds an event with the current time. Only called from interrupt handlers (the producer). 
+ *      The slot is filled before head moves, so the consumer never sees a half written event.
+ * Parameters 
+ *      1. unsigned char type, one of the EVENT_ types
+ *      2. unsigned char arg, argument for the event
+ * Return
+ *      unsigned char, 1 if the event was queued, 0 if the queue was full and it was dropped
+ */
+unsigned char event_push(unsigned char type, unsigned char arg)
+{
+    unsigned char h = head;
+    event_t *slot;
+
+    if ((unsigned char) (h - tail) >= EVENT_QUEUE_SIZE) {
+        if (overflows != 0xFFFF)
+            overflows++;
+        return 0;
+    }
+
+    slot = &events[h & EVENT_MASK];
+    slot->type = type;
+    slot->arg = arg;
+    slot->time = timer_now();
+    COMPILER_BARRIER();
+    head = h + 1;
+    return 1;
+}
+
+/*
+ * Description
+ *      Takes the oldest event out of the queue. Only called from the main loop (the consumer). 
+ *      The event is copied out before tail moves, so the producer cannot overwrite it early.
+ * Parameters 
+ *      1. event_t *event, filled in with the event
+ * Return
+ *      unsigned char, 1 if an event was returned, 0 if the queue was empty
+ */
+unsigned char event_pop(event_t *event)
+{
+    unsigned char t = tail;
+
+    if (t == head)
+        return 0;
+
+    COMPILER_BARRIER();
+    *event = events[t & EVENT_MASK];
+    COMPILER_BARRIER();
+    tail = t + 1;
+    return 1;
+}
+
+/*
+ * Description
+ *      Checks whether there is an event waiting without taking it out.
+ * Parameters 
+ *      void
+ * Return
+ *      unsigned char, 1 if the queue is not empty
+ */
+unsigned char event_pending(void)
+{
+    return tail != head;
+}
+
+/*
+ * Description
+ *      Number of events dropped because the queue was full, since start up.
+ * Parameters 
+ *      void
+ * Return
+ *      unsigned int, dropped events (saturates at 65535)
+ */
+unsigned int event_overflows(void)
+{
+    return overflows;
+}
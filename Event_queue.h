@@ -0,0 +1,88 @@
+/*
+ * File Description
+ *      Header file for the event queue that carries timestamped events from the interrupt handlers 
+ *      to the main loop.
+ * 
+ * Background
+ *      The queue is a single-producer/single-consumer ring buffer. The interrupt handlers are the 
+ *      producer and only move the head, the main loop is the consumer and only moves the tail, so 
+ *      neither side has to mask interrupts. Both indices are single bytes, which the PIC24 reads and 
+ *      writes in one instruction. The handlers that push events all run at the same priority (the 
+ *      default 4), so they never interrupt each other and act as one producer. When the queue is 
+ *      full the new event is dropped and counted, so bursts are never silently lost.
+ */
+
+#ifndef EVENT_QUEUE_H
+#define	EVENT_QUEUE_H
+
+#include <xc.h> // include processor files - each processor file is guarded.  
+
+#ifdef	__cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+    #define EVENT_QUEUE_SIZE 32 // Must be a power of two, at most 128
+
+    #if (EVENT_QUEUE_SIZE & (EVENT_QUEUE_SIZE - 1)) != 0 || EVENT_QUEUE_SIZE > 128
+    #error "EVENT_QUEUE_SIZE must be a power of two no larger than 128"
+    #endif
+
+    // Event types
+    #define EVENT_TOUCH_DOWN 1  // arg = touch channel (0 to 3 for RA1 to RA4)
+    #define EVENT_TOUCH_UP 2    // arg = touch channel (0 to 3 for RA1 to RA4)
+    #define EVENT_I2C_DONE 3    // arg = transaction status
+    #define EVENT_FRAME_TICK 4  // arg = 0, see power_set_frame_period
+    #define EVENT_STREAM_RX 5   // arg = 0, UART bytes arrived in an empty ring (Stream.h)
+
+    typedef struct {
+        unsigned char type;  // One of the EVENT_ types above
+        unsigned char arg;   // Depends on the type
+        unsigned long time;  // timer_now() when the event was pushed
+    } event_t;
+
+    /*
+     * Description
+     *      Adds an event with the current time. Only called from interrupt handlers (the producer).
+     * Parameters 
+     *      1. unsigned char type, one of the EVENT_ types
+     *      2. unsigned char arg, argument for the event
+     * Return
+     *      unsigned char, 1 if the event was queued, 0 if the queue was full and it was dropped
+     */
+    unsigned char event_push(unsigned char type, unsigned char arg);
+
+    /*
+     * Description
+     *      Takes the oldest event out of the queue. Only called from the main loop (the consumer).
+     * Parameters 
+     *      1. event_t *event, filled in with the event
+     * Return
+     *      unsigned char, 1 if an event was returned, 0 if the queue was empty
+     */
+    unsigned char event_pop(event_t *event);
+
+    /*
+     * Description
+     *      Checks whether there is an event waiting without taking it out.
+     * Parameters 
+     *      void
+     * Return
+     *      unsigned char, 1 if the queue is not empty
+     */
+    unsigned char event_pending(void);
+
+    /*
+     * Description
+     *      Number of events dropped because the queue was full, since start up.
+     * Parameters 
+     *      void
+     * Return
+     *      unsigned int, dropped events (saturates at 65535)
+     */
+    unsigned int event_overflows(void);
+
+#ifdef	__cplusplus
+}
+#endif /* __cplusplus */
+
+#endif	/* EVENT_QUEUE_H */
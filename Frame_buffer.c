@@ -0,0 +1,346 @@
+/*
+ * File Description
+ *      Source file for the frame buffer that sits between the animations and the LED matrix. 
+ *      Pixels are stored in chain order with the 3 color bytes in the order they are sent, and 
+ *      frame_show only clocks out the pixels up to the last one that changed. Every channel goes 
+ *      through brightness_lut (Gamma.h) on the way out.
+ */
+
+#include "xc.h"
+#include "Support_fruit.h"
+#include "Assembly.h"
+#include "Frame_buffer.h"
+#include "Pixel_map.h"
+#include "Gamma.h"
+#include "Trace.h"
+#include "Transition.h"
+
+static unsigned char frame[FRAME_PIXELS][3]; // Pixel colors in chain order
+static unsigned char back[FRAME_PIXELS][3];  // Incoming frame of a transition, in chain order
+static unsigned char drawing_back;           // Drawing goes to back until the next frame_show
+static unsigned char dirty_end = FRAME_PIXELS; // Pixels [0, dirty_end) still need to be sent
+static unsigned long frame_load;  // Sum of gamma_table[] over every channel in the frame
+static unsigned int current_ma;   // Estimate for the last frame sent
+#if LED_STRINGS > 1
+static unsigned char planes[LED_STRING_PIXELS * 3 * 8]; // One byte per bit time for all strings
+#endif
+
+/*
+ * Description
+ *      Stores one pixel of the front buffer by its chain index, keeping the load sum and the 
+ *      dirty mark up to date.
+ * Parameters 
+ *      1. unsigned char index, position of the LED in the chain
+ *      2. unsigned char r, first color byte (same as writeColor)
+ *      3. unsigned char g, second color byte (same as writeColor)
+ *      4. unsigned char b, third color byte (same as writeColor)
+ * Return
+ *      void
+ */
+static void store_pixel(unsigned char index, unsigned char r, unsigned char g, unsigned char b) {
+
+    unsigned char *pixel = frame[index];
+
+    if (pixel[0] == r && pixel[1] == g && pixel[2] == b)
+        return;
+
+    frame_load -= gamma_table[pixel[0]] + gamma_table[pixel[1]] + gamma_table[pixel[2]];
+    frame_load += gamma_table[r] + gamma_table[g] + gamma_table[b];
+    pixel[0] = r;
+    pixel[1] = g;
+    pixel[2] = b;
+    if (index >= dirty_end)
+        dirty_end = index + 1;
+}
+
+/*
+ * Description
+ *      Sets one pixel of the frame buffer. The colors are given in the same order as writeColor. 
+ *      If the pixel changes, the dirty mark is moved up to it so the next frame_show sends it. 
+ *      After frame_draw_back the pixel goes to the back buffer instead.
+ * Parameters 
+ *      1. unsigned char x, column (0 is the left-most LED)
+ *      2. unsigned char y, row (0 is the top row)
+ *      3. unsigned char r, first color byte (same as writeColor)
+ *      4. unsigned char g, second color byte (same as writeColor)
+ *      5. unsigned char b, third color byte (same as writeColor)
+ * Return
+ *      void
+ */
+void frame_set_pixel(unsigned char x, unsigned char y, unsigned char r, unsigned char g, unsigned char b) {
+
+    unsigned char index = pixel_map[y * FRAME_WIDTH + x]; // Position of this LED in the chain
+
+    if (drawing_back) {
+        back[index][0] = r;
+        back[index][1] = g;
+        back[index][2] = b;
+    } else {
+        store_pixel(index, r, g, b);
+    }
+}
+
+/*
+ * Description
+ *      Draws one row from a bit pattern like the ones used by the animations: bit 0x80 is the 
+ *      left-most LED and only the low 8 bits are used. Lit pixels get the given color and the 
+ *      others are turned off.
+ * Parameters 
+ *      1. unsigned char y, row (0 is the top row)
+ *      2. unsigned int bits, row pattern
+ *      3. unsigned char r, first color byte (same as writeColor)
+ *      4. unsigned char g, second color byte (same as writeColor)
+ *      5. unsigned char b, third color byte (same as writeColor)
+ * Return
+ *      void
+ */
+void frame_draw_row(unsigned char y, unsigned int bits, unsigned char r, unsigned char g, unsigned char b) {
+
+    unsigned char x;
+
+    for (x = 0; x < FRAME_WIDTH; x++) {
+        if (bits & 0x80)
+            frame_set_pixel(x, y, r, g, b);
+        else
+            frame_set_pixel(x, y, 0, 0, 0);
+        bits = bits << 1;
+    }
+}
+
+/*
+ * Description
+ *      Turns every pixel of the frame buffer off.
+ * Parameters 
+ *      void
+ * Return
+ *      void
+ */
+void frame_clear(void) {
+
+    unsigned char x, y;
+
+    for (y = 0; y < FRAME_HEIGHT; y++) {
+        for (x = 0; x < FRAME_WIDTH; x++)
+            frame_set_pixel(x, y, 0, 0, 0);
+    }
+}
+
+/*
+ * Description
+ *      Estimated LED current for the frame at a brightness level. Scaling the level before the gamma 
+ *      curve scales every gamma-corrected value by about gamma_table[level] / 255, so the estimate 
+ *      only needs the running sum of the frame.
+ * Parameters 
+ *      1. unsigned char level, brightness from 0 (off) to 255 (full)
+ * Return
+ *      unsigned long, current in milliamps
+ */
+static unsigned long estimate_ma(unsigned char level) {
+
+    unsigned long load = frame_load * gamma_table[level] / 255; // Sum of the values that will be sent
+
+    return load * LED_MA_PER_CHANNEL / 255 + (unsigned long) LED_IDLE_MA * FRAME_PIXELS;
+}
+
+/*
+ * Description
+ *      Highest brightness level, up to the one set with set_brightness, that keeps the frame inside 
+ *      LED_BUDGET_MA. gamma_table only goes up, so this is a binary search over the level.
+ * Parameters 
+ *      void
+ * Return
+ *      unsigned char, brightness level to send the frame with
+ */
+static unsigned char power_limit(void) {
+
+    unsigned char low = 0;
+    unsigned char high = get_brightness();
+
+    if (estimate_ma(high) <= LED_BUDGET_MA)
+        return high;
+    while (low < high) { // Keep estimate_ma(low) inside the budget
+        unsigned char mid = low + (high - low + 1) / 2;
+        if (estimate_ma(mid) <= LED_BUDGET_MA)
+            low = mid;
+        else
+            high = mid - 1;
+    }
+    return low;
+}
+
+#if LED_STRINGS > 1
+/*
+ * Description
+ *      Sends the dirty part of the frame on LED_STRINGS strings at once. All strings send the 
+ *      same number of pixels, so if anything past the first string changed every string is sent 
+ *      in full. The bytes go through brightness_lut and are transposed into planes, then pushed 
+ *      by write_parallel with interrupts held off like writeColor.
+ * Parameters 
+ *      void
+ * Return
+ *      void
+ */
+static void send_strings(void) {
+
+    unsigned char length = dirty_end > LED_STRING_PIXELS ? LED_STRING_PIXELS : dirty_end;
+    unsigned char *plane = planes;
+    unsigned char p, c, s, bit, data, mask;
+    int save;
+
+    for (p = 0; p < length; p++) {
+        for (c = 0; c < 3; c++) { // Byte c of pixel p of every string into 8 planes, MSB first
+            for (bit = 0; bit < 8; bit++)
+                plane[bit] = 0;
+            for (s = 0, mask = 1; s < LED_STRINGS; s++, mask = mask << 1) {
+                data = brightness_lut[frame[s * LED_STRING_PIXELS + p][c]];
+                for (bit = 0; bit < 8; bit++) {
+                    if (data & 0x80)
+                        plane[bit] |= mask;
+                    data = data << 1;
+                }
+            }
+            plane += 8;
+        }
+    }
+
+    SET_AND_SAVE_CPU_IPL(save, 7); // An interrupt inside a high pulse would turn a '0' into a '1'
+    write_parallel(planes, (unsigned int) length * 3 * 8, (unsigned char) ((1 << LED_STRINGS) - 1));
+    RESTORE_CPU_IPL(save);
+}
+#endif
+
+/*
+ * Description
+ *      Sends the frame buffer to the matrix, up to and including the highest pixel (in chain 
+ *      order) that changed since the last call. Nothing is sent if nothing changed. The first 
+ *      call after reset sends the whole chain. If the frame would draw more than LED_BUDGET_MA, 
+ *      the output level is lowered first, which resends the whole chain. Interrupts are held 
+ *      off while the pixels are sent. The LEDs latch once the line stays low, which the delay 
+ *      between frames takes care of. After frame_draw_back the transition is played first.
+ * Parameters 
+ *      void
+ * Return
+ *      void
+ */
+void frame_show(void) {
+
+#if LED_STRINGS == 1
+    unsigned char i;
+    int save;
+#endif
+
+    if (drawing_back) { // First frame after frame_draw_back, blend it in before going on
+        drawing_back = 0;
+        transition_run();
+    }
+
+    limit_brightness(power_limit()); // Resends everything if the level changes
+    current_ma = estimate_ma(get_output_level());
+
+    TRACE_RECORD(TRACE_FRAME, 0, dirty_end);
+#if LED_STRINGS > 1
+    send_strings();
+#else
+    SET_AND_SAVE_CPU_IPL(save, 7); // An interrupt inside a high pulse would turn a '0' into a '1'
+    for (i = 0; i < dirty_end; i++)
+        writeColor(brightness_lut[frame[i][0]], brightness_lut[frame[i][1]], brightness_lut[frame[i][2]]);
+    RESTORE_CPU_IPL(save);
+#endif
+    dirty_end = 0;
+}
+
+/*
+ * Description
+ *      Number of pixels the next frame_show will send.
+ * Parameters 
+ *      void
+ * Return
+ *      unsigned char, pixels from the start of the chain that need to be sent
+ */
+unsigned char frame_dirty_length(void) {
+    return dirty_end;
+}
+
+/*
+ * Description
+ *      Marks the whole chain as changed so the next frame_show resends every pixel. Used when 
+ *      the wire values change without the frame changing, for example a new brightness.
+ * Parameters 
+ *      void
+ * Return
+ *      void
+ */
+void frame_invalidate(void) {
+    dirty_end = FRAME_PIXELS;
+}
+
+/*
+ * Description
+ *      Estimated LED current of the last frame sent by frame_show, after any power limiting.
+ * Parameters 
+ *      void
+ * Return
+ *      unsigned int, current in milliamps
+ */
+unsigned int frame_current_ma(void) {
+    return current_ma;
+}
+
+/*
+ * Description
+ *      Sends the frames drawn from now until the next frame_show to the back buffer, which 
+ *      frame_show then blends in with transition_run. That frame has to set every pixel, as all 
+ *      the animations do.
+ * Parameters 
+ *      void
+ * Return
+ *      void
+ */
+void frame_draw_back(void) {
+    drawing_back = 1;
+}
+
+/*
+ * Description
+ *      Moves every channel of the front buffer part of the way to the back buffer, in one pass: 
+ *      weight / 256 of the difference. Weight 256 makes the front equal to the back, and is a plain 
+ *      copy. A difference of up to 255 times a weight of up to 255 does not fit in an int, so the 
+ *      product is worked out in long.
+ * Parameters 
+ *      1. unsigned int weight, 0 to 256
+ * Return
+ *      void
+ */
+void frame_blend_back(unsigned int weight) {
+
+    unsigned char i, c;
+    unsigned char mixed[3];
+
+    if (weight >= 256) {
+        for (i = 0; i < FRAME_PIXELS; i++)
+            store_pixel(i, back[i][0], back[i][1], back[i][2]);
+        return;
+    }
+
+    for (i = 0; i < FRAME_PIXELS; i++) {
+        for (c = 0; c < 3; c++)
+            mixed[c] = frame[i][c] + (int) (((long) back[i][c] - (long) frame[i][c]) * (int) weight >> 8);
+        store_pixel(i, mixed[0], mixed[1], mixed[2]);
+    }
+}
+
+/*
+ * Description
+ *      Copies one pixel from the back buffer to the front buffer.
+ * Parameters 
+ *      1. unsigned char x, column (0 is the left-most LED)
+ *      2. unsigned char y, row (0 is the top row)
+ * Return
+ *      void
+ */
+void frame_take_back(unsigned char x, unsigned char y) {
+
+    unsigned char index = pixel_map[y * FRAME_WIDTH + x];
+
+    store_pixel(index, back[index][0], back[index][1], back[index][2]);
+}
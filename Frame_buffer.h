@@ -0,0 +1,187 @@
+/*
+ * File Description
+ *      Header file for the frame buffer that sits between the animations and the LED matrix.
+ * 
+ * Background
+ *      Instead of calling writeColor 64 times per frame, the animations draw into a frame buffer 
+ *      and then call frame_show. The buffer is kept in chain order (the order the pixels are 
+ *      clocked out), and every write that changes a pixel moves a dirty mark up to that pixel. 
+ *      Because each LED forwards whatever it does not keep to the next one, sending only the first 
+ *      K pixels and then latching leaves the rest of the chain unchanged. frame_show therefore 
+ *      stops after the highest changed pixel, which cuts the wire time for small updates and for 
+ *      long chains of panels.
+ * 
+ *      The drawing position (x, y) is turned into a chain index with pixel_map (Pixel_map.h) when the 
+ *      pixel is written, so rotated, mirrored or serpentine panels cost nothing when sending.
+ * 
+ *      Colors in the frame buffer are perceptual levels. frame_show passes every channel through 
+ *      brightness_lut (Gamma.h), which applies the global brightness and gamma correction in one lookup.
+ * 
+ *      The frame buffer also keeps a running sum of the gamma-corrected channel values, updated only 
+ *      when a pixel changes. frame_show turns that sum into an estimate of the LED current, and if the 
+ *      frame would go over LED_BUDGET_MA it lowers the output level with limit_brightness before it 
+ *      starts sending, so the limit costs no extra pass over the frame.
+ * 
+ *      With LED_STRINGS above 1 the chain is wired as that many strings of equal length, string n 
+ *      holding chain indexes n * LED_STRING_PIXELS and up and driven on RB(8+n) instead of RA0. 
+ *      frame_show then transposes the frame into bit planes (one byte per bit time, one bit per 
+ *      string) and sends every string at once with write_parallel, so the push takes the time of 
+ *      one string. The plane buffer, 1536 / LED_STRINGS bytes, only exists in that build.
+ */
+
+#ifndef FRAME_BUFFER_H
+#define	FRAME_BUFFER_H
+
+#include <xc.h> // include processor files - each processor file is guarded.  
+
+#ifdef	__cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+    #define FRAME_WIDTH 8
+    #define FRAME_HEIGHT 8
+    #define FRAME_PIXELS (FRAME_WIDTH * FRAME_HEIGHT)
+
+    #ifndef LED_BUDGET_MA
+    #define LED_BUDGET_MA 2000     // Current the 5 V supply can give the LEDs
+    #endif
+    #define LED_MA_PER_CHANNEL 20  // Current of one channel sent at 255
+    #define LED_IDLE_MA 1          // Current of one LED that is off
+
+    #ifndef LED_STRINGS
+    #define LED_STRINGS 1          // Strings the chain is split over, string n on RB(8+n) above 1
+    #endif
+    #define LED_STRING_PIXELS (FRAME_PIXELS / LED_STRINGS)
+    #if LED_STRINGS < 1 || LED_STRINGS > 8 || FRAME_PIXELS % LED_STRINGS != 0
+    #error "LED_STRINGS must be 1 to 8 and divide the chain evenly"
+    #endif
+    #if LED_STRINGS > 4 && defined(SPI_FLASH_PLAYER)
+    #error "Strings 4 to 7 are on the SPI1 pins of SPI_FLASH_PLAYER"
+    #endif
+
+    /*
+     * Description
+     *      Sets one pixel of the frame buffer. The colors are given in the same order as writeColor. 
+     *      If the pixel changes, the dirty mark is moved up to it so the next frame_show sends it.
+     * Parameters 
+     *      1. unsigned char x, column (0 is the left-most LED)
+     *      2. unsigned char y, row (0 is the top row)
+     *      3. unsigned char r, first color byte (same as writeColor)
+     *      4. unsigned char g, second color byte (same as writeColor)
+     *      5. unsigned char b, third color byte (same as writeColor)
+     * Return
+     *      void
+     */
+    void frame_set_pixel(unsigned char x, unsigned char y, unsigned char r, unsigned char g, unsigned char b);
+
+    /*
+     * Description
+     *      Draws one row from a bit pattern like the ones used by the animations: bit 0x80 is the 
+     *      left-most LED and only the low 8 bits are used. Lit pixels get the given color and the 
+     *      others are turned off.
+     * Parameters 
+     *      1. unsigned char y, row (0 is the top row)
+     *      2. unsigned int bits, row pattern
+     *      3. unsigned char r, first color byte (same as writeColor)
+     *      4. unsigned char g, second color byte (same as writeColor)
+     *      5. unsigned char b, third color byte (same as writeColor)
+     * Return
+     *      void
+     */
+    void frame_draw_row(unsigned char y, unsigned int bits, unsigned char r, unsigned char g, unsigned char b);
+
+    /*
+     * Description
+     *      Turns every pixel of the frame buffer off.
+     * Parameters 
+     *      void
+     * Return
+     *      void
+     */
+    void frame_clear(void);
+
+    /*
+     * Description
+     *      Sends the frame buffer to the matrix, up to and including the highest pixel (in chain 
+     *      order) that changed since the last call. Nothing is sent if nothing changed. The first 
+     *      call after reset sends the whole chain. If the frame would draw more than LED_BUDGET_MA, 
+     *      the output level is lowered first, which resends the whole chain. Interrupts are held 
+     *      off while the pixels are sent. The LEDs latch once the line stays low, which the delay 
+     *      between frames takes care of.
+     * Parameters 
+     *      void
+     * Return
+     *      void
+     */
+    void frame_show(void);
+
+    /*
+     * Description
+     *      Number of pixels the next frame_show will send.
+     * Parameters 
+     *      void
+     * Return
+     *      unsigned char, pixels from the start of the chain that need to be sent
+     */
+    unsigned char frame_dirty_length(void);
+
+    /*
+     * Description
+     *      Marks the whole chain as changed so the next frame_show resends every pixel. Used when 
+     *      the wire values change without the frame changing, for example a new brightness.
+     * Parameters 
+     *      void
+     * Return
+     *      void
+     */
+    void frame_invalidate(void);
+
+    /*
+     * Description
+     *      Estimated LED current of the last frame sent by frame_show, after any power limiting.
+     * Parameters 
+     *      void
+     * Return
+     *      unsigned int, current in milliamps
+     */
+    unsigned int frame_current_ma(void);
+
+    /*
+     * Description
+     *      Sends the frames drawn from now until the next frame_show to the back buffer, which 
+     *      frame_show then blends in with transition_run. That frame has to set every pixel, as all 
+     *      the animations do.
+     * Parameters 
+     *      void
+     * Return
+     *      void
+     */
+    void frame_draw_back(void);
+
+    /*
+     * Description
+     *      Moves every channel of the front buffer part of the way to the back buffer, in one pass: 
+     *      weight / 256 of the difference. Weight 256 makes the front equal to the back.
+     * Parameters 
+     *      1. unsigned int weight, 0 to 256
+     * Return
+     *      void
+     */
+    void frame_blend_back(unsigned int weight);
+
+    /*
+     * Description
+     *      Copies one pixel from the back buffer to the front buffer.
+     * Parameters 
+     *      1. unsigned char x, column (0 is the left-most LED)
+     *      2. unsigned char y, row (0 is the top row)
+     * Return
+     *      void
+     */
+    void frame_take_back(unsigned char x, unsigned char y);
+
+#ifdef	__cplusplus
+}
+#endif /* __cplusplus */
+
+#endif	/* FRAME_BUFFER_H */
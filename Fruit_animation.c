@@ -23,19 +23,34 @@
  *      1 1 1 1 1 1 0 0     252
  *      0 1 1 1 0 0 0 0     112
  * 
- *      unsigned int banana[24] = {0,0,0,0,0,0,0,0, 2,7,7,15,30,126,252,112,0,0,0,0,0,0,0,0} 
+ *      const unsigned char banana_rows[8] = {2, 7, 7, 15, 30, 126, 252, 112} 
  * 
- *      If this frame is to be displayed on the LED matrix, a for loop of 64 iterations is needed to 
- *      process each individual LED. Within this for loop, there are 8 separate modes for each row 
- *      (8 if-else if statements). Using bit-masking, each LED location is checked to determine if it 
- *      should be lit or unlit (1 or 0). writeColor can be modified to produce the desired color. 
+ *      If this frame is to be displayed on the LED matrix, each of the 8 rows is handed to 
+ *      frame_draw_row together with the color for that row. Using bit-masking, each LED location is 
+ *      checked to determine if it should be lit or unlit (1 or 0) and written into the frame buffer 
+ *      (Frame_buffer.h). frame_show then sends the frame, only clocking out the pixels up to the last 
+ *      one that changed. 
  */
 
 
 #include "xc.h"
 #include "Assembly.h"
 #include "Support_fruit.h"
-#define PERIOD 2000
+#include "Frame_buffer.h"
+#include "Bitboard.h"
+#include "Fruit_animation.h"
+#include "Motion.h"
+#define PERIOD (FRUIT_PERIOD_MS * 10) // In the 100 us steps of Ndelay
+#define LEVEL 99      // Color level sent as 32 at full brightness (see Gamma.h)
+#define LEVEL_LOW 53  // Color level sent as 8 at full brightness
+#define APPLE_STEM 0xFFFFFF0000000000ULL // Top 3 rows of the apple are the stem
+#define BANANA 0x0207070F1E7EFC70ULL     // Banana from the figure in Fruit_animation.h
+#define BANANA_SLIDE_FRAMES (16 * FRUIT_PERIOD_MS / MOTION_FRAME_MS)
+
+static const motion_t banana_moves[2] = {
+    { BANANA, MOTION_PIXELS(-8), 0, MOTION_PIXELS(8), 0, BANANA_SLIDE_FRAMES, EASE_IN_OUT, LEVEL, LEVEL, 0 },
+    { BANANA, 0, MOTION_PIXELS(-8), 0, MOTION_PIXELS(8), BANANA_SLIDE_FRAMES, EASE_IN, LEVEL, LEVEL, 0 }
+};
 volatile int z;
 volatile int f;
 volatile int y;
@@ -43,21 +58,13 @@ volatile int y;
 /*
  * Description
  *      The purpose of this function is to animate a banana sliding first across the matrix 
- *      from left to right and then from top to bottom. Both of these animations use the 
- *      aforementioned banana array using different shift operations. For the horizontal sliding, 
- *      only elements banana[8-15] (those highlighted in red) are considered. The animation itself 
- *      consists of three distinct modes contained within a for loop. The first 8 steps involve 
- *      left-shifting each row entry by 8-n, where n=0 for the first step, n=1 for the second, and 
- *      so on (0 <= n <= 7). This has the effect of moving the banana to the right. The second mode 
- *      is when the banana is centered in the matrix (shown in the figure above). At this step, 
- *      when n=8, the banana array is left unchanged. The final mode involves right-shifting each 
- *      row entry by n-8, producing the effect of the banana moving right (9 <= n <= 16). 
- * 
- *      For the banana sliding down, the extra ?0? entries in the original banana array become relevant. 
- *      This animation involves using an 8-element placeholder array to store the rows required for each 
- *      frame. Specifically, elements 23-n to 16-n from the initial banana array are used for each frame 
- *      (0 <= n <= 16). This animation produces the effect of the banana moving down. Both of these 
- *      animations use the 1D array method, which exploits the constancy of the banana image.
+ *      from left to right and then from top to bottom. The banana is packed into a bitboard 
+ *      (Bitboard.h) and moved as a sprite (Motion.h) at fractional positions, so it glides at 50 fps 
+ *      instead of jumping a whole pixel every FRUIT_PERIOD_MS. The horizontal slide goes from 8 
+ *      columns left of the center (shown in the figure above) to 8 columns right of it, easing in 
+ *      and out, and the slide down from 8 rows above to 8 rows below, speeding up as it falls. 
+ *      Each slide takes as long as the 16 whole-pixel steps it replaces. Pixels that move off the 
+ *      matrix are dropped, so the image needs no padding rows above and below it. 
  * Parameters 
  *      void 
  * Return
@@ -65,165 +72,31 @@ volatile int y;
  */
 void banana_slide(void) {
     /* -------------------------- Banana Animation --------------------------- */
-        unsigned int banana[24] = {0, 0, 0, 0, 0, 0, 0, 0, 2, 7, 7, 15, 30, 126, 252, 112, 0, 0, 0, 0, 0, 0, 0, 0};
-
-        for (y = 0; y < 17; y++) { // Banana sliding right
-
-            unsigned int hold[8];
-            int j;
-
-            if (y < 8) {
-                for (j = 0; j < 8; j++) {
-                    hold[j] = banana[j + 8] << (8 - y);
-                }
-            } else if (y == 8) {
-                for (j = 0; j < 8; j++) {
-                    hold[j] = banana[j + 8];
-                }
-            } else {
-                for (j = 0; j < 8; j++) {
-                    hold[j] = banana[j + 8] >> (y - 8);
-                }
-            }
-
-            Ndelay(PERIOD);
-            int i;
-            int r;
-           
-            for (i = 0; i < 64; i++) {
-                if (i < 8) {
-                    r = hold[0] & 0x80;
-                    hold[0] = hold[0] << 1;
-                    if (r)
-                        writeColor(32, 32, 0);
-                    else
-                        writeColor(0, 0, 0);
-                } else if (i < 16) {
-                    r = hold[1] & 0x80;
-                    hold[1] = hold[1] << 1;
-                    if (r)
-                        writeColor(32, 32, 0);
-                    else
-                        writeColor(0, 0, 0);
-                } else if (i < 24) {
-                    r = hold[2] & 0x80;
-                    hold[2] = hold[2] << 1;
-                    if (r)
-                        writeColor(32, 32, 0);
-                    else
-                        writeColor(0, 0, 0);
-                } else if (i < 32) {
-                    r = hold[3] & 0x80;
-                    hold[3] = hold[3] << 1;
-                    if (r)
-                        writeColor(32, 32, 0);
-                    else
-                        writeColor(0, 0, 0);
-                } else if (i < 40) {
-                    r = hold[4] & 0x80;
-                    hold[4] = hold[4] << 1;
-                    if (r)
-                        writeColor(32, 32, 0);
-                    else
-                        writeColor(0, 0, 0);
-                } else if (i < 48) {
-                    r = hold[5] & 0x80;
-                    hold[5] = hold[5] << 1;
-                    if (r)
-                        writeColor(32, 32, 0);
-                    else
-                        writeColor(0, 0, 0);
-                } else if (i < 56) {
-                    r = hold[6] & 0x80;
-                    hold[6] = hold[6] << 1;
-                    if (r)
-                        writeColor(32, 32, 0);
-                    else
-                        writeColor(0, 0, 0);
-                } else {
-                    r = hold[7] & 0x80;
-                    hold[7] = hold[7] << 1;
-                    if (r)
-                        writeColor(32, 32, 0);
-                    else
-                        writeColor(0, 0, 0);
-                }
-            }
-        }
-       
-        for (y = 16; y >= 0; y--) { //Banana going down
+        Ndelay(PERIOD);
+        motion_play(&banana_moves[0]); // Banana sliding right
+        motion_play(&banana_moves[1]); // Banana going down
+}
 
-            unsigned int hold[8];
-            int j;
+/*
+ * Description
+ *      Draws the apple with its stem rows in green and the rest in red. The stem and the body never 
+ *      share a row, so the color is picked per row from the moved stem bitboard.
+ * Parameters 
+ *      1. bitboard apple, the whole apple after moving
+ *      2. bitboard stem, only the stem pixels after the same move
+ * Return
+ *      void 
+ */
+static void draw_apple(bitboard apple, bitboard stem) {
 
-            for (j = 0; j < 8; j++) {
-                hold[j] = banana[j + y];
-            }
+    unsigned char j;
 
-            Ndelay(PERIOD);
-            int i;
-            int r;
-           
-            for (i = 0; i < 64; i++) {
-                if (i < 8) {
-                    r = hold[0] & 0x80;
-                    hold[0] = hold[0] << 1;
-                    if (r)
-                        writeColor(32, 32, 0);
-                    else
-                        writeColor(0, 0, 0);
-                } else if (i < 16) {
-                    r = hold[1] & 0x80;
-                    hold[1] = hold[1] << 1;
-                    if (r)
-                        writeColor(32, 32, 0);
-                    else
-                        writeColor(0, 0, 0);
-                } else if (i < 24) {
-                    r = hold[2] & 0x80;
-                    hold[2] = hold[2] << 1;
-                    if (r)
-                        writeColor(32, 32, 0);
-                    else
-                        writeColor(0, 0, 0);
-                } else if (i < 32) {
-                    r = hold[3] & 0x80;
-                    hold[3] = hold[3] << 1;
-                    if (r)
-                        writeColor(32, 32, 0);
-                    else
-                        writeColor(0, 0, 0);
-                } else if (i < 40) {
-                    r = hold[4] & 0x80;
-                    hold[4] = hold[4] << 1;
-                    if (r)
-                        writeColor(32, 32, 0);
-                    else
-                        writeColor(0, 0, 0);
-                } else if (i < 48) {
-                    r = hold[5] & 0x80;
-                    hold[5] = hold[5] << 1;
-                    if (r)
-                        writeColor(32, 32, 0);
-                    else
-                        writeColor(0, 0, 0);
-                } else if (i < 56) {
-                    r = hold[6] & 0x80;
-                    hold[6] = hold[6] << 1;
-                    if (r)
-                        writeColor(32, 32, 0);
-                    else
-                        writeColor(0, 0, 0);
-                } else {
-                    r = hold[7] & 0x80;
-                    hold[7] = hold[7] << 1;
-                    if (r)
-                        writeColor(32, 32, 0);
-                    else
-                        writeColor(0, 0, 0);
-                }
-            }
-        }
+    for (j = 0; j < 8; j++) {
+        if (bb_row(stem, j))
+            frame_draw_row(j, bb_row(apple, j), LEVEL, 0, 0);
+        else
+            frame_draw_row(j, bb_row(apple, j), 0, LEVEL, 0);
+    }
 }
 
 /*
@@ -232,9 +105,10 @@ void banana_slide(void) {
  *      1D array method, the apple has the same animations as the banana: sliding left to right first 
  *      and then top to bottom. The only extra point to consider in this mode of operation is the fact 
  *      that the apple has three possible states for any one of its LEDs: green, red, or off. This 
- *      introduces a slight increase in difficulty in the form of a color array that stores the color 
- *      information for any given row. This is only relevant in the downward sliding animation, when the 
- *      rows corresponding to red and green change in every frame.
+ *      is handled by keeping the stem (the top 3 rows) as its own bitboard that is moved together with 
+ *      the apple. Each row is drawn green if it holds part of the stem and red otherwise, which also 
+ *      covers the downward sliding animation, when the rows corresponding to red and green change in 
+ *      every frame. 
  * 
  *      The 2D array method is needed for the third animation of the apple, which shows the apple being 
  *      eaten. Because the shape of the apple changes in each frame, symmetry cannot be exploited. This 
@@ -250,174 +124,20 @@ void banana_slide(void) {
  */
 void munching_apple(void) {
     /* ---------------------- Apple Animation --------------------------------- */
-        unsigned int apple[24] = {0, 0, 0, 0, 0, 0, 0, 0, 14, 12, 24, 36, 126, 126, 126, 60, 0, 0, 0, 0, 0, 0, 0, 0};
-        for (y = 0; y < 17; y++) { // Apple going right
-            unsigned int hold[8];
-            int j;
-            if (y < 8) {
-                for (j = 0; j < 8; j++) {
-                    hold[j] = apple[j + 8] << (8 - y);
-                }
-            } else if (y == 8) {
-                for (j = 0; j < 8; j++) {
-                    hold[j] = apple[j + 8];
-                }
-            } else {
-                for (j = 0; j < 8; j++) {
-                    hold[j] = apple[j + 8]>>(y - 8);
-                }
-            }
+        const unsigned char apple_rows[8] = {14, 12, 24, 36, 126, 126, 126, 60};
+        bitboard apple = bb_from_rows(apple_rows);
+        bitboard stem = apple & APPLE_STEM;
 
+        for (y = 0; y < 17; y++) { // Apple going right
             Ndelay(PERIOD);
-            int i;
-            int r;
-           
-            for (i = 0; i < 64; i++) {
-                if (i < 8) {
-                    r = hold[0] & 0x80;
-                    hold[0] = hold[0] << 1;
-                    if (r)
-                        writeColor(32, 0, 0);
-                    else
-                        writeColor(0, 0, 0);
-                } else if (i < 16) {
-                    r = hold[1] & 0x80;
-                    hold[1] = hold[1] << 1;
-                    if (r)
-                        writeColor(32, 0, 0);
-                    else
-                        writeColor(0, 0, 0);
-                } else if (i < 24) {
-                    r = hold[2] & 0x80;
-                    hold[2] = hold[2] << 1;
-                    if (r)
-                        writeColor(32, 0, 0);
-                    else
-                        writeColor(0, 0, 0);
-                } else if (i < 32) {
-                    r = hold[3] & 0x80;
-                    hold[3] = hold[3] << 1;
-                    if (r)
-                        writeColor(0, 32, 0);
-                    else
-                        writeColor(0, 0, 0);
-                } else if (i < 40) {
-                    r = hold[4] & 0x80;
-                    hold[4] = hold[4] << 1;
-                    if (r)
-                        writeColor(0, 32, 0);
-                    else
-                        writeColor(0, 0, 0);
-                } else if (i < 48) {
-                    r = hold[5] & 0x80;
-                    hold[5] = hold[5] << 1;
-                    if (r)
-                        writeColor(0, 32, 0);
-                    else
-                        writeColor(0, 0, 0);
-                } else if (i < 56) {
-                    r = hold[6] & 0x80;
-                    hold[6] = hold[6] << 1;
-                    if (r)
-                        writeColor(0, 32, 0);
-                    else
-                        writeColor(0, 0, 0);
-                } else {
-                    r = hold[7] & 0x80;
-                    hold[7] = hold[7] << 1;
-                    if (r)
-                        writeColor(0, 32, 0);
-                    else
-                        writeColor(0, 0, 0);
-                }
-            }
+            draw_apple(bb_shift(apple, y - 8, 0), bb_shift(stem, y - 8, 0));
+            frame_show();
         }
        
-        unsigned int color[8];
-       
         for (y = 16; y >= 0; y--) { // Apple going down
-            unsigned int hold[8];
-            int j;
-            for (j = 0; j < 8; j++) {
-                hold[j] = apple[j + y];
-                if (y > 10) {
-                    if ((y + j) < 17)
-                        color[j] = 1;
-                    else
-                        color[j] = 0;
-                } else {
-                    if ((y + j) < 8)
-                        color[j] = 0;
-                    else if (((y + j) >= 8)&&((y + j) < 11))
-                        color[j] = 2;
-                    else
-                        color[j] = 1;
-                }
-            }
-
             Ndelay(PERIOD);
-            int i;
-            int r;
-           
-            for (i = 0; i < 64; i++) {
-                if (i < 8) {
-                    r = hold[0] & 0x80;
-                    hold[0] = hold[0] << 1;
-                    if (r)
-                        writeColor(16 * (2 & color[0]), 32 * (1 & color[0]), 0);
-                    else
-                        writeColor(0, 0, 0);
-                } else if (i < 16) {
-                    r = hold[1] & 0x80;
-                    hold[1] = hold[1] << 1;
-                    if (r)
-                        writeColor(16 * (2 & color[1]), 32 * (1 & color[1]), 0);
-                    else
-                        writeColor(0, 0, 0);
-                } else if (i < 24) {
-                    r = hold[2] & 0x80;
-                    hold[2] = hold[2] << 1;
-                    if (r)
-                        writeColor(16 * (2 & color[2]), 32 * (1 & color[2]), 0);
-                    else
-                        writeColor(0, 0, 0);
-                } else if (i < 32) {
-                    r = hold[3] & 0x80;
-                    hold[3] = hold[3] << 1;
-                    if (r)
-                        writeColor(16 * (2 & color[3]), 32 * (1 & color[3]), 0);
-                    else
-                        writeColor(0, 0, 0);
-                } else if (i < 40) {
-                    r = hold[4] & 0x80;
-                    hold[4] = hold[4] << 1;
-                    if (r)
-                        writeColor(16 * (2 & color[4]), 32 * (1 & color[4]), 0);
-                    else
-                        writeColor(0, 0, 0);
-                } else if (i < 48) {
-                    r = hold[5] & 0x80;
-                    hold[5] = hold[5] << 1;
-                    if (r)
-                        writeColor(16 * (2 & color[5]), 32 * (1 & color[5]), 0);
-                    else
-                        writeColor(0, 0, 0);
-                } else if (i < 56) {
-                    r = hold[6] & 0x80;
-                    hold[6] = hold[6] << 1;
-                    if (r)
-                        writeColor(16 * (2 & color[6]), 32 * (1 & color[6]), 0);
-                    else
-                        writeColor(0, 0, 0);
-                } else {
-                    r = hold[7] & 0x80;
-                    hold[7] = hold[7] << 1;
-                    if (r)
-                        writeColor(16 * (2 & color[7]), 32 * (1 & color[7]), 0);
-                    else
-                        writeColor(0, 0, 0);
-                }
-            }
+            draw_apple(bb_shift(apple, 0, 8 - y), bb_shift(stem, 0, 8 - y));
+            frame_show();
         }
         /*Apple being eaten*/
         unsigned int newapple[8][8];
@@ -509,68 +229,13 @@ void munching_apple(void) {
             
 
             Ndelay(PERIOD);
-            int i;
-            int r;
-           
-            for (i = 0; i < 64; i++) {
-                if (i < 8) {
-                    r = hold[0] & 0x80;
-                    hold[0] = hold[0] << 1;
-                    if (r)
-                        writeColor(32, 0, 0);
-                    else
-                        writeColor(0, 0, 0);
-                } else if (i < 16) {
-                    r = hold[1] & 0x80;
-                    hold[1] = hold[1] << 1;
-                    if (r)
-                        writeColor(32, 0, 0);
-                    else
-                        writeColor(0, 0, 0);
-                } else if (i < 24) {
-                    r = hold[2] & 0x80;
-                    hold[2] = hold[2] << 1;
-                    if (r)
-                        writeColor(32, 0, 0);
-                    else
-                        writeColor(0, 0, 0);
-                } else if (i < 32) {
-                    r = hold[3] & 0x80;
-                    hold[3] = hold[3] << 1;
-                    if (r)
-                        writeColor(0, 32, 0);
-                    else
-                        writeColor(0, 0, 0);
-                } else if (i < 40) {
-                    r = hold[4] & 0x80;
-                    hold[4] = hold[4] << 1;
-                    if (r)
-                        writeColor(0, 32, 0);
-                    else
-                        writeColor(0, 0, 0);
-                } else if (i < 48) {
-                    r = hold[5] & 0x80;
-                    hold[5] = hold[5] << 1;
-                    if (r)
-                        writeColor(0, 32, 0);
-                    else
-                        writeColor(0, 0, 0);
-                } else if (i < 56) {
-                    r = hold[6] & 0x80;
-                    hold[6] = hold[6] << 1;
-                    if (r)
-                        writeColor(0, 32, 0);
-                    else
-                        writeColor(0, 0, 0);
-                } else {
-                    r = hold[7] & 0x80;
-                    hold[7] = hold[7] << 1;
-                    if (r)
-                        writeColor(0, 32, 0);
-                    else
-                        writeColor(0, 0, 0);
-                }
+            for (j = 0; j < 8; j++) {
+                if (j < 3)
+                    frame_draw_row(j, hold[j], LEVEL, 0, 0);
+                else
+                    frame_draw_row(j, hold[j], 0, LEVEL, 0);
             }
+            frame_show();
         }
 }
 
@@ -749,68 +414,13 @@ void annoying_orange(void) {
             
 
             Ndelay(PERIOD);
-            int i;
-            int r;
-           
-            for (i = 0; i < 64; i++) {
-                if (i < 8) {
-                    r = hold[0] & 0x80;
-                    hold[0] = hold[0] << 1;
-                    if (r)
-                        writeColor(32, 0, 0);
-                    else
-                        writeColor(0, 0, 0);
-                } else if (i < 16) {
-                    r = hold[1] & 0x80;
-                    hold[1] = hold[1] << 1;
-                    if (r)
-                        writeColor(32, 0, 0);
-                    else
-                        writeColor(0, 0, 0);
-                } else if (i < 24) {
-                    r = hold[2] & 0x80;
-                    hold[2] = hold[2] << 1;
-                    if (r)
-                        writeColor(8, 32, 0);
-                    else
-                        writeColor(0, 0, 0);
-                } else if (i < 32) {
-                    r = hold[3] & 0x80;
-                    hold[3] = hold[3] << 1;
-                    if (r)
-                        writeColor(8, 32, 0);
-                    else
-                        writeColor(0, 0, 0);
-                } else if (i < 40) {
-                    r = hold[4] & 0x80;
-                    hold[4] = hold[4] << 1;
-                    if (r)
-                        writeColor(8, 32, 0);
-                    else
-                        writeColor(0, 0, 0);
-                } else if (i < 48) {
-                    r = hold[5] & 0x80;
-                    hold[5] = hold[5] << 1;
-                    if (r)
-                        writeColor(8, 32, 0);
-                    else
-                        writeColor(0, 0, 0);
-                } else if (i < 56) {
-                    r = hold[6] & 0x80;
-                    hold[6] = hold[6] << 1;
-                    if (r)
-                        writeColor(8, 32, 0);
-                    else
-                        writeColor(0, 0, 0);
-                } else {
-                    r = hold[7] & 0x80;
-                    hold[7] = hold[7] << 1;
-                    if (r)
-                        writeColor(8, 32, 0);
-                    else
-                        writeColor(0, 0, 0);
-                }
+            for (j = 0; j < 8; j++) {
+                if (j < 2)
+                    frame_draw_row(j, hold[j], LEVEL, 0, 0);
+                else
+                    frame_draw_row(j, hold[j], LEVEL_LOW, LEVEL, 0);
             }
+            frame_show();
         }
 }
 
@@ -972,68 +582,43 @@ void grapes_of_wrath(void) {
             
 
             Ndelay(PERIOD);
-            int i;
-            int r;
-           
-            for (i = 0; i < 64; i++) {
-                if (i < 8) {
-                    r = hold[0] & 0x80;
-                    hold[0] = hold[0] << 1;
-                    if (r)
-                        writeColor(32, 0, 0);
-                    else
-                        writeColor(0, 0, 0);
-                } else if (i < 16) {
-                    r = hold[1] & 0x80;
-                    hold[1] = hold[1] << 1;
-                    if (r)
-                        writeColor(32, 0, 0);
-                    else
-                        writeColor(0, 0, 0);
-                } else if (i < 24) {
-                    r = hold[2] & 0x80;
-                    hold[2] = hold[2] << 1;
-                    if (r)
-                        writeColor(0, 32, 32);
-                    else
-                        writeColor(0, 0, 0);
-                } else if (i < 32) {
-                    r = hold[3] & 0x80;
-                    hold[3] = hold[3] << 1;
-                    if (r)
-                        writeColor(0, 32, 32);
-                    else
-                        writeColor(0, 0, 0);
-                } else if (i < 40) {
-                    r = hold[4] & 0x80;
-                    hold[4] = hold[4] << 1;
-                    if (r)
-                        writeColor(0, 32, 32);
-                    else
-                        writeColor(0, 0, 0);
-                } else if (i < 48) {
-                    r = hold[5] & 0x80;
-                    hold[5] = hold[5] << 1;
-                    if (r)
-                        writeColor(0, 32, 32);
-                    else
-                        writeColor(0, 0, 0);
-                } else if (i < 56) {
-                    r = hold[6] & 0x80;
-                    hold[6] = hold[6] << 1;
-                    if (r)
-                        writeColor(0, 32, 32);
-                    else
-                        writeColor(0, 0, 0);
-                } else {
-                    r = hold[7] & 0x80;
-                    hold[7] = hold[7] << 1;
-                    if (r)
-                        writeColor(0, 32, 32);
-                    else
-                        writeColor(0, 0, 0);
-                }
+            for (j = 0; j < 8; j++) {
+                if (j < 2)
+                    frame_draw_row(j, hold[j], LEVEL, 0, 0);
+                else
+                    frame_draw_row(j, hold[j], 0, LEVEL, LEVEL);
             }
+            frame_show();
         }
 }
 
+/*
+ * Description
+ *      Fills the matrix with the color of one fruit, scaled by level. Used to light up a fruit 
+ *      more and more as a hand comes closer to it.
+ * Parameters 
+ *      1. unsigned char fruit, 0 banana, 1 apple, 2 orange, 3 grapes (anything else clears the matrix)
+ *      2. unsigned char level, 0 for off to 255 for the full fruit color
+ * Return
+ *      void
+ */
+void fruit_glow(unsigned char fruit, unsigned char level)
+{
+    static const unsigned char colors[4][3] = { // Same colors as the animations
+        {LEVEL, LEVEL, 0},      // Banana, yellow
+        {0, LEVEL, 0},          // Apple, red
+        {LEVEL_LOW, LEVEL, 0},  // Orange
+        {0, LEVEL, LEVEL}       // Grapes, purple
+    };
+    unsigned char r = 0, g = 0, b = 0;
+    int j;
+
+    if (fruit < 4) {
+        r = (colors[fruit][0] * level) >> 8;
+        g = (colors[fruit][1] * level) >> 8;
+        b = (colors[fruit][2] * level) >> 8;
+    }
+    for (j = 0; j < 8; j++)
+        frame_draw_row(j, 0xFF, r, g, b);
+    frame_show();
+}
@@ -20,12 +20,13 @@
  *      1 1 1 1 1 1 0 0     252
  *      0 1 1 1 0 0 0 0     112
  * 
- *      unsigned int banana[24] = {0,0,0,0,0,0,0,0, 2,7,7,15,30,126,252,112,0,0,0,0,0,0,0,0} 
+ *      const unsigned char banana_rows[8] = {2, 7, 7, 15, 30, 126, 252, 112} 
  * 
- *      If this frame is to be displayed on the LED matrix, a for loop of 64 iterations is needed to 
- *      process each individual LED. Within this for loop, there are 8 separate modes for each row 
- *      (8 if-else if statements). Using bit-masking, each LED location is checked to determine if it 
- *      should be lit or unlit (1 or 0). writeColor can be modified to produce the desired color. 
+ *      If this frame is to be displayed on the LED matrix, each of the 8 rows is handed to 
+ *      frame_draw_row together with the color for that row. Using bit-masking, each LED location is 
+ *      checked to determine if it should be lit or unlit (1 or 0) and written into the frame buffer 
+ *      (Frame_buffer.h). frame_show then sends the frame, only clocking out the pixels up to the last 
+ *      one that changed. 
  * 
  */
 
@@ -40,24 +41,18 @@
 extern "C" {
 #endif /* __cplusplus */
     
+    #define FRUIT_PERIOD_MS 200 // Time between the frames of the fruit animations
+
     /*
      * Description
      *      The purpose of this function is to animate a banana sliding first across the matrix 
-     *      from left to right and then from top to bottom. Both of these animations use the 
-     *      aforementioned banana array using different shift operations. For the horizontal sliding, 
-     *      only elements banana[8-15] (those highlighted in red) are considered. The animation itself 
-     *      consists of three distinct modes contained within a for loop. The first 8 steps involve 
-     *      left-shifting each row entry by 8-n, where n=0 for the first step, n=1 for the second, and 
-     *      so on (0 <= n <= 7). This has the effect of moving the banana to the right. The second mode 
-     *      is when the banana is centered in the matrix (shown in the figure above). At this step, 
-     *      when n=8, the banana array is left unchanged. The final mode involves right-shifting each 
-     *      row entry by n-8, producing the effect of the banana moving right (9 <= n <= 16). 
-     * 
-     *      For the banana sliding down, the extra ?0? entries in the original banana array become relevant. 
-     *      This animation involves using an 8-element placeholder array to store the rows required for each 
-     *      frame. Specifically, elements 23-n to 16-n from the initial banana array are used for each frame 
-     *      (0 <= n <= 16). This animation produces the effect of the banana moving down. Both of these 
-     *      animations use the 1D array method, which exploits the constancy of the banana image.
+     *      from left to right and then from top to bottom. The banana is packed into a bitboard 
+     *      (Bitboard.h) and moved as a sprite (Motion.h) at fractional positions, so it glides at 50 fps 
+     *      instead of jumping a whole pixel every FRUIT_PERIOD_MS. The horizontal slide goes from 8 
+     *      columns left of the center (shown in the figure above) to 8 columns right of it, easing in 
+     *      and out, and the slide down from 8 rows above to 8 rows below, speeding up as it falls. 
+     *      Each slide takes as long as the 16 whole-pixel steps it replaces. Pixels that move off the 
+     *      matrix are dropped, so the image needs no padding rows above and below it. 
      * Parameters 
      *      void 
      * Return
@@ -71,9 +66,10 @@ extern "C" {
      *      1D array method, the apple has the same animations as the banana: sliding left to right first 
      *      and then top to bottom. The only extra point to consider in this mode of operation is the fact 
      *      that the apple has three possible states for any one of its LEDs: green, red, or off. This 
-     *      introduces a slight increase in difficulty in the form of a color array that stores the color 
-     *      information for any given row. This is only relevant in the downward sliding animation, when the 
-     *      rows corresponding to red and green change in every frame.
+     *      is handled by keeping the stem (the top 3 rows) as its own bitboard that is moved together with 
+     *      the apple. Each row is drawn green if it holds part of the stem and red otherwise, which also 
+     *      covers the downward sliding animation, when the rows corresponding to red and green change in 
+     *      every frame. 
      * 
      *      The 2D array method is needed for the third animation of the apple, which shows the apple being 
      *      eaten. Because the shape of the apple changes in each frame, symmetry cannot be exploited. This 
@@ -132,6 +128,18 @@ extern "C" {
      */
     void grapes_of_wrath(void);
 
+    /*
+     * Description
+     *      Fills the matrix with the color of one fruit, scaled by level. Used to light up a fruit 
+     *      more and more as a hand comes closer to it.
+     * Parameters 
+     *      1. unsigned char fruit, 0 banana, 1 apple, 2 orange, 3 grapes (anything else clears the matrix)
+     *      2. unsigned char level, 0 for off to 255 for the full fruit color
+     * Return
+     *      void
+     */
+    void fruit_glow(unsigned char fruit, unsigned char level);
+
     // TODO If C++ is being used, regular C code needs function names to have C 
     // linkage so the functions can be used by the c code. 
 
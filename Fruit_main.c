@@ -13,8 +13,25 @@
 #include "Assembly.h"
 #include "Fruit_animation.h"
 #include "Touch_sensor.h"
+#include "Gamma.h"
 #define FCY 16000000UL
 #include <libpic30.h>
+#include "Power.h"
+#include "Event_queue.h"
+#include "Gesture.h"
+#include "Frame_buffer.h"
+#include "Proximity.h"
+#include "Bus.h"
+#include "Stream.h"
+#include "Anim_store.h"
+#include "Spi_flash.h"
+#include "Stack.h"
+#include "Profile.h"
+#include "Trace.h"
+#include "Effects.h"
+#include "Marquee.h"
+#include "Motion.h"
+#include "Transition.h"
 
 #include "xc.h"
 
@@ -50,6 +67,222 @@ void setup(void)
     TRISB = 0x0000; // set all output, should be overwritten for SPI 
 }
 
+#ifdef TRANSITIONS
+#define BLEND_IN(kind) transition_next(kind, TRANSITION_FRAMES) // Into the next frame drawn
+#else
+#define BLEND_IN(kind) ((void) 0)
+#endif
+
+/*
+ * Description
+ *      Plays the animation of one fruit.
+ * Parameters 
+ *      1. unsigned char channel, touch channel of the fruit
+ * Return
+ *      void
+ */
+void play_fruit(unsigned char channel)
+{
+    TRACE_RECORD(TRACE_ANIM_START, channel, channel == 0 ? MOTION_FRAME_MS : FRUIT_PERIOD_MS); // The banana glides
+    if (channel == 0) // pin 3 and RA1
+        banana_slide();
+    else if (channel == 1) // pin 9 and RA2
+        munching_apple();
+    else if (channel == 2) // pin 10 and RA3
+        annoying_orange();
+    else if (channel == 3) // pin 12 and RA4
+        grapes_of_wrath();
+    TRACE_RECORD(TRACE_ANIM_STOP, channel, 0);
+}
+
+/*
+ * Description
+ *      Acts on one gesture. A tap plays the fruit (after a ripple from it with ATTRACT defined), 
+ *      a double-tap plays the uploaded animation with 
+ *      the same number as the fruit (Anim_store.h) or, if there is none, the fruit twice, a 
+ *      long-press switches between full and quarter brightness, and a swipe plays every fruit 
+ *      from the left-most one of the swipe to the right (or, with SPI_FLASH_PLAYER defined, the 
+ *      long animation on the SPI flash chip if it holds one). With TRANSITIONS defined, a tap 
+ *      crossfades into the fruit, a double-tap dissolves into it and a swipe wipes from fruit to 
+ *      fruit.
+ * Parameters 
+ *      1. const gesture_t *gesture, the gesture
+ * Return
+ *      void
+ */
+void handle_gesture(const gesture_t *gesture)
+{
+    unsigned char c, page;
+
+    LATBbits.LATB5 = !LATBbits.LATB5;
+    TRACE_RECORD(TRACE_GESTURE, gesture->type, gesture->channel);
+    if (gesture->type == GESTURE_TAP)
+    {
+#ifdef ATTRACT
+        effect_play(EFFECT_RIPPLE, gesture->channel, EFFECT_RIPPLE_FRAMES);
+#endif
+        BLEND_IN(TRANSITION_CROSSFADE);
+        play_fruit(gesture->channel);
+    }
+    else if (gesture->type == GESTURE_DOUBLE_TAP)
+    {
+        page = anim_store_find(gesture->channel);
+        BLEND_IN(TRANSITION_DISSOLVE);
+        if (page != ANIM_NONE)
+            anim_store_play(page);
+        else
+        {
+            play_fruit(gesture->channel);
+            BLEND_IN(TRANSITION_DISSOLVE);
+            play_fruit(gesture->channel);
+        }
+    }
+    else if (gesture->type == GESTURE_LONG_PRESS)
+        set_brightness(get_brightness() == BRIGHTNESS_DEFAULT ? BRIGHTNESS_DEFAULT / 4 : BRIGHTNESS_DEFAULT);
+    else if (gesture->type == GESTURE_SWIPE)
+    {
+#ifdef SPI_FLASH_PLAYER
+        if (spi_flash_play())
+            return;
+#endif
+        for (c = gesture->channel; c < GESTURE_CHANNELS; c++)
+        {
+            BLEND_IN(TRANSITION_WIPE);
+            play_fruit(c);
+        }
+    }
+}
+
+#if TOUCH_DEVICE_COUNT > 1
+/*
+ * Description
+ *      Bus job that reads the next CAP1188 of the scan. Runs every TOUCH_SCAN_SLOT_MS, also in the 
+ *      gaps between the frames of an animation.
+ * Parameters 
+ *      void
+ * Return
+ *      void
+ */
+void scan_job_run(void)
+{
+    touch_scan_next();
+}
+
+// A status read plus the INT clear, and the read repeated after it
+bus_job_t scan_job = { scan_job_run, TOUCH_SCAN_SLOT_MS, 1500 };
+
+/*
+ * Description
+ *      Plays the fruit of every channel of the scanned CAP1188s that was touched since the last 
+ *      call. The fruits of a wall with several sensors repeat the four animations, channel by 
+ *      channel. The first CAP1188 is left out: its touches already come in as gestures through 
+ *      its LED pins, and taking them here too would play the fruit twice.
+ * Parameters 
+ *      void
+ * Return
+ *      void
+ */
+void handle_wall_touch(void)
+{
+    unsigned char device, c;
+    unsigned char pressed;
+
+    touch_take_pressed(0); // Handled as gestures
+    for (device = 1; device < TOUCH_DEVICE_COUNT; device++)
+    {
+        pressed = touch_take_pressed(device);
+        for (c = 0; c < TOUCH_CHANNELS; c++)
+        {
+            if (pressed & (1 << c))
+            {
+                power_set_frame_period(0); // Don't fill the queue with ticks while a fruit plays
+                LATBbits.LATB5 = !LATBbits.LATB5;
+                play_fruit((device * TOUCH_CHANNELS + c) % GESTURE_CHANNELS);
+            }
+        }
+    }
+}
+#endif
+
+#ifdef PROXIMITY_GLOW
+/*
+ * Description
+ *      Bus job that reads the delta counts for the proximity glow.
+ * Parameters 
+ *      void
+ * Return
+ *      void
+ */
+void proximity_job_run(void)
+{
+    proximity_update(&touch_devices[0]);
+}
+
+// One burst read, done twice if a write just happened
+bus_job_t proximity_job = { proximity_job_run, PROXIMITY_FRAME_MS, 2500 };
+#endif
+
+#ifdef TOUCH_LATENCY_MODE
+#define TOUCH_LATENCY_CHANNEL 0  // CAP1188 channel with the test pad (TOUCH_STIMULUS_LAT)
+#define TOUCH_LATENCY_SAMPLES 8  // Touches averaged for each profile
+#define TOUCH_LATENCY_REST_MS 50 // Pause after a touch, plus a little more each time
+
+unsigned long touch_latency_us[TOUCH_PROFILE_COUNT]; // Results, read them with the debugger
+
+/*
+ * Description
+ *      Latency measurement mode. Loads every touch profile in turn and averages the latency of 
+ *      TOUCH_LATENCY_SAMPLES touches made by the test pad on TOUCH_LATENCY_CHANNEL. The pause 
+ *      between touches grows by a prime number of milliseconds each time, so the touches land at 
+ *      different points of the CAP1188 cycle instead of locking to it. The results are left in 
+ *      touch_latency_us and shown on the matrix, one row per profile and one pixel per 10 ms. 
+ *      The boot profile is loaded again at the end.
+ * Parameters 
+ *      void 
+ * Return
+ *      void
+ */
+void touch_latency_report(void)
+{
+    unsigned char profile, samples, pixels;
+    unsigned long us, total;
+
+    frame_clear();
+    for (profile = 0; profile < TOUCH_PROFILE_COUNT; profile++)
+    {
+        load_touch_profile(&touch_profiles[profile]);
+        total = 0;
+        samples = 0;
+        while (samples < TOUCH_LATENCY_SAMPLES)
+        {
+            us = touch_measure_latency(TOUCH_LATENCY_CHANNEL, 10000);
+            if (us == 0)
+                break; // The test pad does not register, give up on this profile
+            total += us;
+            samples++;
+            delay_ms(TOUCH_LATENCY_REST_MS + 7 * samples);
+        }
+        touch_latency_us[profile] = samples ? total / samples : 0;
+
+        pixels = touch_latency_us[profile] / 10000;
+        if (pixels > FRAME_WIDTH)
+            pixels = FRAME_WIDTH;
+        frame_draw_row(profile, (0xFF00 >> pixels) & 0xFF, 0, 0, 100);
+        frame_show();
+    }
+    load_touch_profile(&touch_profiles[TOUCH_PROFILE_BOOT]);
+}
+#endif
+
+#ifdef ATTRACT
+#define ATTRACT_IDLE_MS 30000UL  // Time without a gesture before the effects start
+#define ATTRACT_FRAMES 300       // Frames of each effect before the next one (10 s)
+#define ATTRACT_POLL_MS 250      // Tick while waiting to start them, so deep sleep can't wait forever
+#define ATTRACT_TEXT "TOUCH A FRUIT!"
+#endif
+
+unsigned int stack_peak; // Most stack used so far in bytes, read it with the debugger
+
 /*
  * Description
  *      Main function to run the infinite loop out of. 
@@ -60,35 +293,115 @@ void setup(void)
  */
 int main(void)
 {
+    stack_paint(); // Before anything else has used the stack
     setup();
+    timer_init(); // The I2C waits of setup_touch_sensor time out on it
     setup_touch_sensor();
+    set_brightness(BRIGHTNESS_DEFAULT);
+    power_init();
+#if TOUCH_DEVICE_COUNT > 1
+    touch_scan_start();
+    bus_add(&scan_job);
+#endif
+#ifdef PROXIMITY_GLOW
+    bus_add(&proximity_job);
+#endif
+#ifdef UART_STREAM
+    stream_init();
+#endif
+#ifdef PROFILE
+    profile_init();
+#endif
+#ifdef SPI_FLASH_PLAYER
+    spi_flash_init();
+#endif
+#ifdef TOUCH_LATENCY_MODE
+    touch_latency_report();
+#endif
     
     // Set LED high 
     LATBbits.LATB5 = 1;
 
+#ifdef PROXIMITY_GLOW
+    deadline_t glow_next = deadline_in_ms(PROXIMITY_FRAME_MS);
+#endif
+#ifdef ATTRACT
+    deadline_t attract_at = deadline_in_ms(ATTRACT_IDLE_MS);
+    unsigned char attract_step = 0; // Plasma, the message, fire, the message again
+#endif
+
     while (1)
     {
-       __delay_ms(500);
-       if (PORTAbits.RA1 == 0) // pin 3
-       {
-           LATBbits.LATB5 = !LATBbits.LATB5;
-           banana_slide();
-       }
-       else if (PORTAbits.RA2 == 0) // pin 9
+       event_t event;
+       gesture_t gesture;
+       unsigned int tick;
+
+#if TOUCH_DEVICE_COUNT > 1
+       // The sensors on the bus are scanned every slot, so the ticks never stop
+       tick = TOUCH_SCAN_SLOT_MS;
+#else
+       // Ticks are only needed while the recognizer has something to time out
+       tick = gesture_busy() ? GESTURE_POLL_MS : 0;
+#endif
+#ifdef PROXIMITY_GLOW
+       if (tick == 0 || tick > PROXIMITY_FRAME_MS)
+           tick = PROXIMITY_FRAME_MS;
+#endif
+#ifdef ATTRACT
+       if (tick == 0)
+           tick = ATTRACT_POLL_MS;
+#endif
+       power_set_frame_period(tick);
+       power_wait_for_event(); // Idle (or Sleep) until a touch or tick is queued
+       while (event_pop(&event))
+           gesture_feed(&event);
+       gesture_poll(timer_now());
+       bus_poll(); // Sensor jobs that came due while waiting
+#ifdef UART_STREAM
+       stream_poll(); // Frames from the PC replace whatever is on the matrix
+       stream_show();
+#endif
+#if TOUCH_DEVICE_COUNT > 1
+       handle_wall_touch();
+#endif
+#ifdef PROXIMITY_GLOW
+       if (deadline_expired(glow_next))
        {
-           LATBbits.LATB5 = !LATBbits.LATB5;
-           munching_apple();
+           // Light the fruit the hand is closest to, brighter as it comes closer
+           glow_next = deadline_in_ms(PROXIMITY_FRAME_MS);
+           fruit_glow(proximity_nearest(), proximity_level(proximity_nearest()));
        }
-       else if (PORTAbits.RA3 == 0) // pin 10 
+#endif
+
+       while (gesture_next(&gesture))
        {
-           LATBbits.LATB5 = !LATBbits.LATB5;
-           annoying_orange();
+           power_set_frame_period(0); // Don't fill the queue with ticks while a fruit plays
+           handle_gesture(&gesture);
+           stack_peak = stack_high_water(); // Animations are the deepest calls
+#ifdef ATTRACT
+           attract_at = deadline_in_ms(ATTRACT_IDLE_MS);
+#endif
        }
-       else if (PORTAbits.RA4 == 0) // pin 12
+#ifdef ATTRACT
+       if (deadline_expired(attract_at) && !gesture_busy())
        {
-           LATBbits.LATB5 = !LATBbits.LATB5;
-           grapes_of_wrath();
+           // Nobody has played for a while, show the effects until a touch comes in
+           power_set_frame_period(0);
+           if (attract_step & 1)
+               marquee_play(ATTRACT_TEXT, 100, 100, 100);
+           else
+               effect_play(attract_step == 0 ? EFFECT_PLASMA : EFFECT_FIRE, 0, ATTRACT_FRAMES);
+           attract_step = (attract_step + 1) & 3;
+           if (event_pending())
+           {
+               frame_clear();
+               frame_show();
+               attract_at = deadline_in_ms(ATTRACT_IDLE_MS);
+           }
+           else
+               attract_at = timer_now(); // Still due, but never far enough behind to wrap
        }
+#endif
     }
     
     return 0;
@@ -0,0 +1,112 @@
+/*
+ * File Description
+ *      Source file for the global brightness and gamma correction of the LED matrix. The gamma table 
+ *      is constant and stays in flash; brightness_lut is the only RAM copy and is rebuilt when the 
+ *      brightness changes.
+ */
+
+#include "xc.h"
+#include "Gamma.h"
+#include "Frame_buffer.h"
+
+const unsigned char gamma_table[256] = {
+      0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   1,
+      1,   1,   1,   1,   1,   1,   1,   1,   1,   2,   2,   2,   2,   2,   2,   2,
+      3,   3,   3,   3,   3,   4,   4,   4,   4,   5,   5,   5,   5,   6,   6,   6,
+      6,   7,   7,   7,   8,   8,   8,   9,   9,   9,  10,  10,  11,  11,  11,  12,
+     12,  13,  13,  13,  14,  14,  15,  15,  16,  16,  17,  17,  18,  18,  19,  19,
+     20,  20,  21,  22,  22,  23,  23,  24,  25,  25,  26,  26,  27,  28,  28,  29,
+     30,  30,  31,  32,  33,  33,  34,  35,  35,  36,  37,  38,  39,  39,  40,  41,
+     42,  43,  43,  44,  45,  46,  47,  48,  49,  49,  50,  51,  52,  53,  54,  55,
+     56,  57,  58,  59,  60,  61,  62,  63,  64,  65,  66,  67,  68,  69,  70,  71,
+     73,  74,  75,  76,  77,  78,  79,  81,  82,  83,  84,  85,  87,  88,  89,  90,
+     91,  93,  94,  95,  97,  98,  99, 100, 102, 103, 105, 106, 107, 109, 110, 111,
+    113, 114, 116, 117, 119, 120, 121, 123, 124, 126, 127, 129, 130, 132, 133, 135,
+    137, 138, 140, 141, 143, 145, 146, 148, 149, 151, 153, 154, 156, 158, 159, 161,
+    163, 165, 166, 168, 170, 172, 173, 175, 177, 179, 181, 182, 184, 186, 188, 190,
+    192, 194, 196, 197, 199, 201, 203, 205, 207, 209, 211, 213, 215, 217, 219, 221,
+    223, 225, 227, 229, 231, 234, 236, 238, 240, 242, 244, 246, 248, 251, 253, 255
+};
+
+unsigned char brightness_lut[256];
+static unsigned char brightness; // Level asked for by set_brightness
+static unsigned char lut_level;  // Level brightness_lut was built for
+
+/*
+ * Description
+ *      Rebuilds brightness_lut for a brightness level and marks the frame buffer for a full resend, 
+ *      because the wire value of every pixel changes.
+ * Parameters 
+ *      1. unsigned char level, brightness from 0 (off) to 255 (full)
+ * Return
+ *      void
+ */
+static void build_lut(unsigned char level) {
+
+    unsigned int i;
+    unsigned int scale = level + 1; // 256 keeps every level unchanged
+
+    lut_level = level;
+    for (i = 0; i < 256; i++)
+        brightness_lut[i] = gamma_table[(i * scale) >> 8];
+    frame_invalidate(); // Same frame, new wire values
+}
+
+/*
+ * Description
+ *      Sets the global brightness and rebuilds brightness_lut. Animation colors are not touched; 
+ *      the next frame_show resends the whole frame at the new level. Should be called once at 
+ *      start up.
+ * Parameters 
+ *      1. unsigned char level, brightness from 0 (off) to 255 (full)
+ * Return
+ *      void
+ */
+void set_brightness(unsigned char level) {
+
+    brightness = level;
+    build_lut(level);
+}
+
+/*
+ * Description
+ *      Lowers the level actually sent below the brightness set by set_brightness, for example to stay 
+ *      inside the power budget. The table is only rebuilt when the level changes, and asking for more 
+ *      than set_brightness allows gives the set_brightness level back.
+ * Parameters 
+ *      1. unsigned char level, highest brightness allowed for the next frame
+ * Return
+ *      void
+ */
+void limit_brightness(unsigned char level) {
+
+    if (level > brightness)
+        level = brightness;
+    if (level != lut_level)
+        build_lut(level);
+}
+
+/*
+ * Description
+ *      Returns the level brightness_lut is currently built for. This is lower than get_brightness 
+ *      while limit_brightness is holding the output back.
+ * Parameters 
+ *      void
+ * Return
+ *      unsigned char, brightness from 0 (off) to 255 (full)
+ */
+unsigned char get_output_level(void) {
+    return lut_level;
+}
+
+/*
+ * Description
+ *      Returns the brightness set by set_brightness.
+ * Parameters 
+ *      void
+ * Return
+ *      unsigned char, brightness from 0 (off) to 255 (full)
+ */
+unsigned char get_brightness(void) {
+    return brightness;
+}
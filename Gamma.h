@@ -0,0 +1,87 @@
+/*
+ * File Description
+ *      Header file for the global brightness and gamma correction of the LED matrix.
+ * 
+ * Background
+ *      The LEDs are linear in the value they are sent, but the eye is not, so low values look like big 
+ *      steps and dimming by scaling the raw values looks posterized. The colors used by the animations 
+ *      are therefore perceptual levels (0-255) that go through a gamma 2.2 table before they are sent. 
+ *      The global brightness scales the level before the gamma table, so dimming keeps the same smooth 
+ *      steps. Both are folded into one 256-entry table in RAM that is rebuilt only when the brightness 
+ *      changes, so encoding a channel stays a single table lookup.
+ */
+
+#ifndef GAMMA_H
+#define	GAMMA_H
+
+#include <xc.h> // include processor files - each processor file is guarded.  
+
+#ifdef	__cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+    #define BRIGHTNESS_DEFAULT 255 // Full brightness
+
+    /*
+     * Description
+     *      Gamma 2.2 table kept in flash: gamma_table[level] = 255 * (level / 255)^2.2.
+     */
+    extern const unsigned char gamma_table[256];
+
+    /*
+     * Description
+     *      Wire value for every color level at the current brightness. Used by frame_show for every 
+     *      channel of every pixel it sends.
+     */
+    extern unsigned char brightness_lut[256];
+
+    /*
+     * Description
+     *      Sets the global brightness and rebuilds brightness_lut. Animation colors are not touched; 
+     *      the next frame_show resends the whole frame at the new level. Should be called once at 
+     *      start up.
+     * Parameters 
+     *      1. unsigned char level, brightness from 0 (off) to 255 (full)
+     * Return
+     *      void
+     */
+    void set_brightness(unsigned char level);
+
+    /*
+     * Description
+     *      Returns the brightness set by set_brightness.
+     * Parameters 
+     *      void
+     * Return
+     *      unsigned char, brightness from 0 (off) to 255 (full)
+     */
+    unsigned char get_brightness(void);
+
+    /*
+     * Description
+     *      Lowers the level actually sent below the brightness set by set_brightness, for example to stay 
+     *      inside the power budget. The table is only rebuilt when the level changes, and asking for more 
+     *      than set_brightness allows gives the set_brightness level back.
+     * Parameters 
+     *      1. unsigned char level, highest brightness allowed for the next frame
+     * Return
+     *      void
+     */
+    void limit_brightness(unsigned char level);
+
+    /*
+     * Description
+     *      Returns the level brightness_lut is currently built for. This is lower than get_brightness 
+     *      while limit_brightness is holding the output back.
+     * Parameters 
+     *      void
+     * Return
+     *      unsigned char, brightness from 0 (off) to 255 (full)
+     */
+    unsigned char get_output_level(void);
+
+#ifdef	__cplusplus
+}
+#endif /* __cplusplus */
+
+#endif	/* GAMMA_H */
@@ -0,0 +1,245 @@
+/*
+ * File Description
+ *      Source file for touch debouncing and gesture recognition. Times are timer_now() counts and 
+ *      are only ever compared as differences, so the counter wrapping around does not matter.
+ */
+
+#include "xc.h"
+#include "Gesture.h"
+
+#define MS(ms) ((unsigned long) (ms) * TIMER_COUNTS_PER_MS)
+#define ELAPSED(now, then) ((unsigned long) ((now) - (then)))
+
+#define GESTURE_QUEUE_SIZE 8 // Power of two
+
+typedef struct {
+    unsigned char raw;         // Last state reported by the touch events, 1 = held
+    unsigned char held;        // Debounced state
+    unsigned char tap_waiting; // A tap is waiting to see if it becomes a double-tap
+    unsigned char used;        // This touch already made a long-press or swipe, no tap for it
+    unsigned long changed;     // Time of the last debounced edge
+    unsigned long tap_time;    // Release time of the waiting tap
+} channel_t;
+
+static channel_t channels[GESTURE_CHANNELS];
+static unsigned char swipe_count;   // Neighbouring fruits touched in order so far
+static unsigned char swipe_channel; // Last fruit of the swipe so far
+static unsigned long swipe_time;    // Time of that touch
+
+static gesture_t gestures[GESTURE_QUEUE_SIZE];
+static unsigned char gesture_head, gesture_tail;
+
+/*
+ * Description
+ *      Queues a recognized gesture, dropping it if gesture_next has fallen far behind.
+ * Parameters 
+ *      1. unsigned char type, one of the GESTURE_ types
+ *      2. unsigned char channel, the touch channel
+ * Return
+ *      void
+ */
+static void emit(unsigned char type, unsigned char channel)
+{
+    if ((unsigned char) (gesture_head - gesture_tail) >= GESTURE_QUEUE_SIZE)
+        return;
+    gestures[gesture_head & (GESTURE_QUEUE_SIZE - 1)].type = type;
+    gestures[gesture_head & (GESTURE_QUEUE_SIZE - 1)].channel = channel;
+    gesture_head++;
+}
+
+/*
+ * Description
+ *      Checks whether a waiting tap could still turn out to be part of a swipe: its channel is in 
+ *      the run of neighbouring fruits touched so far, the run is short of a swipe with room to 
+ *      its right to finish it, and the next touch can still come in time.
+ * Parameters 
+ *      1. unsigned char c, the touch channel of the tap
+ *      2. unsigned long now, timer_now()
+ * Return
+ *      unsigned char, 1 if the tap has to keep waiting
+ */
+static unsigned char swipe_possible(unsigned char c, unsigned long now)
+{
+    return swipe_count != 0 && swipe_count < GESTURE_SWIPE_COUNT 
+        && c <= swipe_channel && c + swipe_count > swipe_channel 
+        && swipe_channel + GESTURE_SWIPE_COUNT - swipe_count < GESTURE_CHANNELS 
+        && ELAPSED(now, swipe_time) <= MS(GESTURE_SWIPE_GAP_MS);
+}
+
+/*
+ * Description
+ *      Touch down after debouncing. Continues or restarts the swipe.
+ * Parameters 
+ *      1. unsigned char c, the touch channel
+ *      2. unsigned long time, time of the edge
+ * Return
+ *      void
+ */
+static void touch_down(unsigned char c, unsigned long time)
+{
+    unsigned char i;
+
+    channels[c].used = 0;
+
+    if (swipe_count != 0 && c == swipe_channel + 1 && ELAPSED(time, swipe_time) <= MS(GESTURE_SWIPE_GAP_MS))
+        swipe_count++;
+    else
+        swipe_count = 1;
+    swipe_channel = c;
+    swipe_time = time;
+
+    if (swipe_count == GESTURE_SWIPE_COUNT) {
+        for (i = c + 1 - GESTURE_SWIPE_COUNT; i <= c; i++) {
+            channels[i].used = 1;
+            channels[i].tap_waiting = 0;
+        }
+        emit(GESTURE_SWIPE, c + 1 - GESTURE_SWIPE_COUNT);
+    } else if (swipe_count > GESTURE_SWIPE_COUNT) { // Swipe carries on past the count, no tap
+        channels[c].used = 1;
+    }
+}
+
+/*
+ * Description
+ *      Touch up after debouncing. Turns a short touch into a tap or, if a tap is already waiting 
+ *      and this one came soon enough, a double-tap. A waiting tap can be older than that, if a 
+ *      swipe kept it waiting or the edges were fed late, and then stays a tap of its own.
+ * Parameters 
+ *      1. unsigned char c, the touch channel
+ *      2. unsigned long time, time of the edge
+ * Return
+ *      void
+ */
+static void touch_up(unsigned char c, unsigned long time)
+{
+    channel_t *ch = &channels[c];
+
+    if (ch->used)
+        return;
+
+    if (ch->tap_waiting && ELAPSED(time, ch->tap_time) <= MS(GESTURE_DOUBLE_MS)) {
+        ch->tap_waiting = 0;
+        emit(GESTURE_DOUBLE_TAP, c);
+    } else {
+        if (ch->tap_waiting)
+            emit(GESTURE_TAP, c);
+        ch->tap_waiting = 1;
+        ch->tap_time = time;
+    }
+}
+
+/*
+ * Description
+ *      Takes a new debounced state for a channel.
+ * Parameters 
+ *      1. unsigned char c, the touch channel
+ *      2. unsigned long time, time of the edge
+ * Return
+ *      void
+ */
+static void accept(unsigned char c, unsigned long time)
+{
+    channels[c].held = channels[c].raw;
+    channels[c].changed = time;
+    if (channels[c].held)
+        touch_down(c, time);
+    else
+        touch_up(c, time);
+}
+
+/*
+ * Description
+ *      Passes one event from the event queue to the recognizer. Events other than touch down and 
+ *      touch up are ignored.
+ * Parameters 
+ *      1. const event_t *event, the event
+ * Return
+ *      void
+ */
+void gesture_feed(const event_t *event)
+{
+    channel_t *ch;
+
+    if ((event->type != EVENT_TOUCH_DOWN && event->type != EVENT_TOUCH_UP) || event->arg >= GESTURE_CHANNELS)
+        return;
+
+    ch = &channels[event->arg];
+    ch->raw = (event->type == EVENT_TOUCH_DOWN);
+    if (ch->raw != ch->held && ELAPSED(event->time, ch->changed) >= MS(GESTURE_DEBOUNCE_MS))
+        accept(event->arg, event->time);
+}
+
+/*
+ * Description
+ *      Handles everything that happens because time has passed: late debounced edges, 
+ *      long-presses and taps whose double-tap window has closed and that can no longer be part of 
+ *      a swipe.
+ * Parameters 
+ *      1. unsigned long now, timer_now()
+ * Return
+ *      void
+ */
+void gesture_poll(unsigned long now)
+{
+    unsigned char c;
+    channel_t *ch;
+
+    for (c = 0; c < GESTURE_CHANNELS; c++) {
+        ch = &channels[c];
+
+        if (ch->raw != ch->held && ELAPSED(now, ch->changed) >= MS(GESTURE_DEBOUNCE_MS))
+            accept(c, ch->changed + MS(GESTURE_DEBOUNCE_MS));
+
+        if (ch->held && !ch->used && ELAPSED(now, ch->changed) >= MS(GESTURE_LONG_MS)) {
+            ch->used = 1;
+            if (ch->tap_waiting) { // The first touch was still a tap
+                ch->tap_waiting = 0;
+                emit(GESTURE_TAP, c);
+            }
+            emit(GESTURE_LONG_PRESS, c);
+        }
+
+        if (ch->tap_waiting && !ch->held && ELAPSED(now, ch->tap_time) >= MS(GESTURE_DOUBLE_MS) 
+            && !swipe_possible(c, now)) {
+            ch->tap_waiting = 0;
+            emit(GESTURE_TAP, c);
+        }
+    }
+}
+
+/*
+ * Description
+ *      Checks whether gesture_poll has anything to time out, so the caller knows it has to keep 
+ *      calling it every GESTURE_POLL_MS.
+ * Parameters 
+ *      void
+ * Return
+ *      unsigned char, 1 if a fruit is held, a tap is waiting or an edge is being debounced
+ */
+unsigned char gesture_busy(void)
+{
+    unsigned char c;
+
+    for (c = 0; c < GESTURE_CHANNELS; c++) {
+        if ((channels[c].held && !channels[c].used) || channels[c].tap_waiting || channels[c].raw != channels[c].held)
+            return 1;
+    }
+    return 0;
+}
+
+/*
+ * Description
+ *      Takes the oldest recognized gesture.
+ * Parameters 
+ *      1. gesture_t *gesture, filled in with the gesture
+ * Return
+ *      unsigned char, 1 if a gesture was returned, 0 if there are none
+ */
+unsigned char gesture_next(gesture_t *gesture)
+{
+    if (gesture_tail == gesture_head)
+        return 0;
+    *gesture = gestures[gesture_tail & (GESTURE_QUEUE_SIZE - 1)];
+    gesture_tail++;
+    return 1;
+}
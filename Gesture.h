@@ -0,0 +1,98 @@
+/*
+ * File Description
+ *      Header file for touch debouncing and gesture recognition. Touch events from the event queue 
+ *      go in, and taps, double-taps, long-presses and left-to-right swipes across the fruits come out.
+ * 
+ * Background
+ *      Each channel is debounced by taking the first edge right away and then ignoring the pin for 
+ *      GESTURE_DEBOUNCE_MS; if the pin ended up in a different state by then, that state is taken 
+ *      late. A release shorter than GESTURE_LONG_MS is a tap, but it is only reported once 
+ *      GESTURE_DOUBLE_MS has passed without a second tap, so single taps arrive that much later. 
+ *      Touching GESTURE_SWIPE_COUNT neighbouring fruits from left to right, each within 
+ *      GESTURE_SWIPE_GAP_MS of the last, is a swipe, and the taps of those touches are dropped. 
+ *      Since the first touch of a swipe can be released long before the last one comes, a tap is 
+ *      also held back while the touches so far could still grow into a swipe, which is until 
+ *      GESTURE_SWIPE_GAP_MS after the latest of them. 
+ *      gesture_feed and gesture_poll do a fixed amount of work per call (at most one pass over 
+ *      the channels), whatever the touch history.
+ */
+
+#ifndef GESTURE_H
+#define	GESTURE_H
+
+#include <xc.h> // include processor files - each processor file is guarded.  
+#include "Event_queue.h"
+#include "Timer.h"
+
+#ifdef	__cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+    #define GESTURE_CHANNELS 4        // Touch channels 0 to 3, left to right
+    #define GESTURE_DEBOUNCE_MS 20    // Edges this soon after the last accepted one are bounce
+    #define GESTURE_LONG_MS 600       // Held this long is a long-press
+    #define GESTURE_DOUBLE_MS 250     // Second tap within this time of the first is a double-tap
+    #define GESTURE_SWIPE_GAP_MS 250  // Most time between the touches of a swipe
+    #define GESTURE_SWIPE_COUNT 3     // Neighbouring fruits touched in order to make a swipe
+    #define GESTURE_POLL_MS 10        // How often gesture_poll should run while gesture_busy
+
+    // Gesture types
+    #define GESTURE_TAP 1
+    #define GESTURE_DOUBLE_TAP 2
+    #define GESTURE_LONG_PRESS 3
+    #define GESTURE_SWIPE 4           // channel = left-most fruit of the swipe
+
+    typedef struct {
+        unsigned char type;     // One of the GESTURE_ types above
+        unsigned char channel;  // Touch channel the gesture happened on
+    } gesture_t;
+
+    /*
+     * Description
+     *      Passes one event from the event queue to the recognizer. Events other than touch down and 
+     *      touch up are ignored.
+     * Parameters 
+     *      1. const event_t *event, the event
+     * Return
+     *      void
+     */
+    void gesture_feed(const event_t *event);
+
+    /*
+     * Description
+     *      Handles everything that happens because time has passed: late debounced edges, 
+     *      long-presses and taps whose double-tap window has closed and that can no longer be part 
+     *      of a swipe.
+     * Parameters 
+     *      1. unsigned long now, timer_now()
+     * Return
+     *      void
+     */
+    void gesture_poll(unsigned long now);
+
+    /*
+     * Description
+     *      Checks whether gesture_poll has anything to time out, so the caller knows it has to keep 
+     *      calling it every GESTURE_POLL_MS.
+     * Parameters 
+     *      void
+     * Return
+     *      unsigned char, 1 if a fruit is held, a tap is waiting or an edge is being debounced
+     */
+    unsigned char gesture_busy(void);
+
+    /*
+     * Description
+     *      Takes the oldest recognized gesture.
+     * Parameters 
+     *      1. gesture_t *gesture, filled in with the gesture
+     * Return
+     *      unsigned char, 1 if a gesture was returned, 0 if there are none
+     */
+    unsigned char gesture_next(gesture_t *gesture);
+
+#ifdef	__cplusplus
+}
+#endif /* __cplusplus */
+
+#endif	/* GESTURE_H */
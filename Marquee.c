@@ -0,0 +1,202 @@
+/*
+ * File Description
+ *      Source file for the marquee. The state is the bitboard on the matrix, the character being 
+ *      fed in and the column of it that comes next.
+ */
+
+#include "xc.h"
+#include "Marquee.h"
+#include "Bitboard.h"
+#include "Frame_buffer.h"
+#include "Event_queue.h"
+#include "Timer.h"
+#include "Bus.h"
+
+#define GAP_COLUMN MARQUEE_GLYPH_WIDTH  // Blank column after every character
+
+// 5x7 font, one byte per column from the left, bit 0 is the top row
+static const unsigned char font[MARQUEE_LAST - MARQUEE_FIRST + 1][MARQUEE_GLYPH_WIDTH] = {
+    { 0x00, 0x00, 0x00, 0x00, 0x00 }, //  
+    { 0x00, 0x00, 0x5F, 0x00, 0x00 }, // !
+    { 0x00, 0x07, 0x00, 0x07, 0x00 }, // "
+    { 0x14, 0x7F, 0x14, 0x7F, 0x14 }, // #
+    { 0x24, 0x2A, 0x7F, 0x2A, 0x12 }, // $
+    { 0x23, 0x13, 0x08, 0x64, 0x62 }, // %
+    { 0x36, 0x49, 0x55, 0x22, 0x50 }, // &
+    { 0x00, 0x05, 0x03, 0x00, 0x00 }, // '
+    { 0x00, 0x1C, 0x22, 0x41, 0x00 }, // (
+    { 0x00, 0x41, 0x22, 0x1C, 0x00 }, // )
+    { 0x14, 0x08, 0x3E, 0x08, 0x14 }, // *
+    { 0x08, 0x08, 0x3E, 0x08, 0x08 }, // +
+    { 0x00, 0x50, 0x30, 0x00, 0x00 }, // ,
+    { 0x08, 0x08, 0x08, 0x08, 0x08 }, // -
+    { 0x00, 0x60, 0x60, 0x00, 0x00 }, // .
+    { 0x20, 0x10, 0x08, 0x04, 0x02 }, // /
+    { 0x3E, 0x51, 0x49, 0x45, 0x3E }, // 0
+    { 0x00, 0x42, 0x7F, 0x40, 0x00 }, // 1
+    { 0x42, 0x61, 0x51, 0x49, 0x46 }, // 2
+    { 0x21, 0x41, 0x45, 0x4B, 0x31 }, // 3
+    { 0x18, 0x14, 0x12, 0x7F, 0x10 }, // 4
+    { 0x27, 0x45, 0x45, 0x45, 0x39 }, // 5
+    { 0x3C, 0x4A, 0x49, 0x49, 0x30 }, // 6
+    { 0x01, 0x71, 0x09, 0x05, 0x03 }, // 7
+    { 0x36, 0x49, 0x49, 0x49, 0x36 }, // 8
+    { 0x06, 0x49, 0x49, 0x29, 0x1E }, // 9
+    { 0x00, 0x36, 0x36, 0x00, 0x00 }, // :
+    { 0x00, 0x56, 0x36, 0x00, 0x00 }, // ;
+    { 0x08, 0x14, 0x22, 0x41, 0x00 }, // <
+    { 0x14, 0x14, 0x14, 0x14, 0x14 }, // =
+    { 0x00, 0x41, 0x22, 0x14, 0x08 }, // >
+    { 0x02, 0x01, 0x51, 0x09, 0x06 }, // ?
+    { 0x32, 0x49, 0x79, 0x41, 0x3E }, // @
+    { 0x7E, 0x11, 0x11, 0x11, 0x7E }, // A
+    { 0x7F, 0x49, 0x49, 0x49, 0x36 }, // B
+    { 0x3E, 0x41, 0x41, 0x41, 0x22 }, // C
+    { 0x7F, 0x41, 0x41, 0x22, 0x1C }, // D
+    { 0x7F, 0x49, 0x49, 0x49, 0x41 }, // E
+    { 0x7F, 0x09, 0x09, 0x01, 0x01 }, // F
+    { 0x3E, 0x41, 0x41, 0x51, 0x32 }, // G
+    { 0x7F, 0x08, 0x08, 0x08, 0x7F }, // H
+    { 0x00, 0x41, 0x7F, 0x41, 0x00 }, // I
+    { 0x20, 0x40, 0x41, 0x3F, 0x01 }, // J
+    { 0x7F, 0x08, 0x14, 0x22, 0x41 }, // K
+    { 0x7F, 0x40, 0x40, 0x40, 0x40 }, // L
+    { 0x7F, 0x02, 0x04, 0x02, 0x7F }, // M
+    { 0x7F, 0x04, 0x08, 0x10, 0x7F }, // N
+    { 0x3E, 0x41, 0x41, 0x41, 0x3E }, // O
+    { 0x7F, 0x09, 0x09, 0x09, 0x06 }, // P
+    { 0x3E, 0x41, 0x51, 0x21, 0x5E }, // Q
+    { 0x7F, 0x09, 0x19, 0x29, 0x46 }, // R
+    { 0x46, 0x49, 0x49, 0x49, 0x31 }, // S
+    { 0x01, 0x01, 0x7F, 0x01, 0x01 }, // T
+    { 0x3F, 0x40, 0x40, 0x40, 0x3F }, // U
+    { 0x1F, 0x20, 0x40, 0x20, 0x1F }, // V
+    { 0x7F, 0x20, 0x18, 0x20, 0x7F }, // W
+    { 0x63, 0x14, 0x08, 0x14, 0x63 }, // X
+    { 0x07, 0x08, 0x70, 0x08, 0x07 }, // Y
+    { 0x61, 0x51, 0x49, 0x45, 0x43 }, // Z
+};
+
+static bitboard window;         // What is on the matrix
+static const char *next_char;   // Character being fed in, 0 at the end of the text
+static unsigned char column;     // Next column of it, GAP_COLUMN for the gap
+static unsigned char trailing;   // Blank columns fed in after the text
+static marquee_stats_t totals;
+
+/*
+ * Description
+ *      Font columns of one character.
+ * Parameters 
+ *      1. char c, the character
+ * Return
+ *      const unsigned char *, MARQUEE_GLYPH_WIDTH columns
+ */
+static const unsigned char *glyph(char c)
+{
+    if (c >= 'a' && c <= 'z')
+        c -= 'a' - 'A';
+    if (c < MARQUEE_FIRST || c > MARQUEE_LAST)
+        c = '?';
+    return font[c - MARQUEE_FIRST];
+}
+
+/*
+ * Description
+ *      Starts scrolling a message in from the right edge. The text is read while it scrolls, 
+ *      so it has to stay where it is until the marquee is done.
+ * Parameters 
+ *      1. const char *text, message ending with 0
+ * Return
+ *      void
+ */
+void marquee_start(const char *text)
+{
+    window = 0;
+    next_char = text;
+    column = 0;
+    trailing = 0;
+}
+
+/*
+ * Description
+ *      Scrolls the message one column to the left and draws it into the frame buffer.
+ * Parameters 
+ *      1. unsigned char r, first color byte (same as writeColor)
+ *      2. unsigned char g, second color byte (same as writeColor)
+ *      3. unsigned char b, third color byte (same as writeColor)
+ * Return
+ *      unsigned char, 1 while the message is still on the matrix, 0 once it has left
+ */
+unsigned char marquee_step(unsigned char r, unsigned char g, unsigned char b)
+{
+    unsigned long started = timer_now();
+    unsigned long cycles;
+    unsigned char bits = 0;
+    unsigned char y;
+
+    if (*next_char) {
+        if (column < MARQUEE_GLYPH_WIDTH)
+            bits = glyph(*next_char)[column];
+        if (++column > GAP_COLUMN) {
+            column = 0;
+            next_char++;
+        }
+    } else if (trailing < FRAME_WIDTH) {
+        trailing++; // Blank columns push the end of the text off the left edge
+    } else {
+        return 0;
+    }
+
+    window = bb_shift(window, -1, 0);
+    for (y = 0; bits; y++, bits >>= 1) {
+        if (bits & 1)
+            window |= (bitboard) 1 << (56 - 8 * y); // Right-most LED of row y
+    }
+    bb_draw(window, r, g, b);
+
+    cycles = timer_now() - started;
+    if (cycles > totals.max_cycles)
+        totals.max_cycles = cycles;
+    totals.steps++;
+    return 1;
+}
+
+/*
+ * Description
+ *      Scrolls a message across the matrix at MARQUEE_COLUMN_MS per column, running the sensor 
+ *      jobs in the gaps, and stops early as soon as an event is queued.
+ * Parameters 
+ *      1. const char *text, message ending with 0
+ *      2. unsigned char r, first color byte (same as writeColor)
+ *      3. unsigned char g, second color byte (same as writeColor)
+ *      4. unsigned char b, third color byte (same as writeColor)
+ * Return
+ *      unsigned char, 1 if the whole message went by, 0 if an event stopped it
+ */
+unsigned char marquee_play(const char *text, unsigned char r, unsigned char g, unsigned char b)
+{
+    deadline_t deadline = timer_now();
+
+    marquee_start(text);
+    while (marquee_step(r, g, b)) {
+        frame_show();
+        deadline += (unsigned long) MARQUEE_COLUMN_MS * TIMER_COUNTS_PER_MS;
+        bus_wait_until(deadline);
+        if (event_pending())
+            return 0;
+    }
+    return 1;
+}
+
+/*
+ * Description
+ *      Step time statistics since start up.
+ * Parameters 
+ *      1. marquee_stats_t *stats, filled in with the statistics
+ * Return
+ *      void
+ */
+void marquee_stats(marquee_stats_t *stats)
+{
+    *stats = totals;
+}
@@ -0,0 +1,89 @@
+/*
+ * File Description
+ *      Header file for the marquee, which scrolls short messages across the matrix.
+ * 
+ * Background
+ *      The font is 5x7 (upper case, digits and punctuation, space to 'Z'), stored in flash one 
+ *      byte per column with bit 0 as the top row, 5 bytes per character. Lower case letters are 
+ *      shown in upper case and anything else as '?'. 
+ * 
+ *      Scrolling works like banana_slide: the matrix is a bitboard (Bitboard.h), and every step 
+ *      moves it one column to the left with bb_shift and fills the right-most column with the 
+ *      next font column, after a blank column between characters. The string is read one column 
+ *      at a time straight from where it is stored, so a message takes no RAM beyond the bitboard 
+ *      and a position. The text starts off the right edge and the marquee is done once its last 
+ *      column has left on the left. marquee_stats gives the longest time one step took, in 
+ *      instruction cycles.
+ */
+
+#ifndef MARQUEE_H
+#define	MARQUEE_H
+
+#include <xc.h> // include processor files - each processor file is guarded.  
+
+#ifdef	__cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+    #define MARQUEE_FIRST ' '       // First character in the font
+    #define MARQUEE_LAST 'Z'        // Last character in the font
+    #define MARQUEE_GLYPH_WIDTH 5
+    #define MARQUEE_COLUMN_MS 60    // Time per one column step, about 16 columns a second
+
+    typedef struct {
+        unsigned long steps;        // Columns scrolled
+        unsigned long max_cycles;   // Longest step, drawing into the frame buffer included
+    } marquee_stats_t;
+
+    /*
+     * Description
+     *      Starts scrolling a message in from the right edge. The text is read while it scrolls, 
+     *      so it has to stay where it is until the marquee is done.
+     * Parameters 
+     *      1. const char *text, message ending with 0
+     * Return
+     *      void
+     */
+    void marquee_start(const char *text);
+
+    /*
+     * Description
+     *      Scrolls the message one column to the left and draws it into the frame buffer.
+     * Parameters 
+     *      1. unsigned char r, first color byte (same as writeColor)
+     *      2. unsigned char g, second color byte (same as writeColor)
+     *      3. unsigned char b, third color byte (same as writeColor)
+     * Return
+     *      unsigned char, 1 while the message is still on the matrix, 0 once it has left
+     */
+    unsigned char marquee_step(unsigned char r, unsigned char g, unsigned char b);
+
+    /*
+     * Description
+     *      Scrolls a message across the matrix at MARQUEE_COLUMN_MS per column, running the sensor 
+     *      jobs in the gaps, and stops early as soon as an event is queued.
+     * Parameters 
+     *      1. const char *text, message ending with 0
+     *      2. unsigned char r, first color byte (same as writeColor)
+     *      3. unsigned char g, second color byte (same as writeColor)
+     *      4. unsigned char b, third color byte (same as writeColor)
+     * Return
+     *      unsigned char, 1 if the whole message went by, 0 if an event stopped it
+     */
+    unsigned char marquee_play(const char *text, unsigned char r, unsigned char g, unsigned char b);
+
+    /*
+     * Description
+     *      Step time statistics since start up.
+     * Parameters 
+     *      1. marquee_stats_t *stats, filled in with the statistics
+     * Return
+     *      void
+     */
+    void marquee_stats(marquee_stats_t *stats);
+
+#ifdef	__cplusplus
+}
+#endif /* __cplusplus */
+
+#endif	/* MARQUEE_H */
@@ -0,0 +1,190 @@
+/*
+ * File Description
+ *      Source file for smooth sprite motion.
+ */
+
+#include "xc.h"
+#include "Motion.h"
+#include "Frame_buffer.h"
+#include "Timer.h"
+#include "Bus.h"
+
+#define EASE_STEPS 64 // Table entries over a move, plus one for the end
+
+// Fraction done (0 to 256) at 65 evenly spaced times, one table per curve after EASE_LINEAR
+static const unsigned int ease_tables[3][EASE_STEPS + 1] = {
+    { // EASE_IN, t squared
+        0, 0, 0, 1, 1, 2, 2, 3, 4, 5, 6, 8, 9, 11, 12, 14,
+        16, 18, 20, 23, 25, 28, 30, 33, 36, 39, 42, 46, 49, 53, 56, 60,
+        64, 68, 72, 77, 81, 86, 90, 95, 100, 105, 110, 116, 121, 127, 132, 138,
+        144, 150, 156, 163, 169, 176, 182, 189, 196, 203, 210, 218, 225, 233, 240, 248,
+        256
+    },
+    { // EASE_IN_OUT, (1 - cos(pi t)) / 2
+        0, 0, 1, 1, 2, 4, 6, 7, 10, 12, 15, 18, 22, 25, 29, 33,
+        37, 42, 47, 52, 57, 62, 68, 73, 79, 85, 91, 97, 103, 109, 115, 122,
+        128, 134, 141, 147, 153, 159, 165, 171, 177, 183, 188, 194, 199, 204, 209, 214,
+        219, 223, 227, 231, 234, 238, 241, 244, 246, 249, 250, 252, 254, 255, 255, 256,
+        256
+    },
+    { // EASE_BOUNCE, falls and bounces three times, each lower
+        0, 0, 2, 4, 8, 12, 17, 23, 30, 38, 47, 57, 68, 80, 93, 106,
+        121, 137, 153, 171, 189, 208, 229, 250, 248, 238, 230, 222, 215, 209, 203, 199,
+        196, 194, 192, 192, 193, 194, 197, 200, 204, 210, 216, 223, 231, 240, 250, 254,
+        249, 245, 243, 241, 240, 240, 241, 243, 246, 250, 255, 254, 253, 252, 252, 254,
+        256
+    }
+};
+
+static motion_stats_t totals;
+
+/*
+ * Description
+ *      Fraction of a move done at a point in time, along an easing curve.
+ * Parameters 
+ *      1. unsigned char ease, one of the EASE_ curves
+ *      2. unsigned int t, time from 0 (start) to 256 (end)
+ * Return
+ *      int, fraction done from 0 to 256
+ */
+int motion_ease(unsigned char ease, unsigned int t)
+{
+    const unsigned int *table;
+    unsigned char i, f;
+
+    if (t > 256)
+        t = 256;
+    if (ease == EASE_LINEAR || ease > EASE_BOUNCE)
+        return t;
+
+    table = ease_tables[ease - 1];
+    i = t >> 2;     // Entry before t
+    f = t & 3;      // Quarters of the way to the next entry
+    if (f == 0)
+        return table[i];
+    return table[i] + (((int) table[i + 1] - (int) table[i]) * f >> 2);
+}
+
+/*
+ * Description
+ *      Adds a share to one pixel of the coverage map, if the pixel is on the matrix.
+ * Parameters 
+ *      1. unsigned char level[FRAME_HEIGHT][FRAME_WIDTH], coverage of every pixel (255 is full)
+ *      2. int x, column
+ *      3. int y, row
+ *      4. unsigned int share, coverage to add (256 is a whole pixel)
+ * Return
+ *      void
+ */
+static void add_share(unsigned char level[FRAME_HEIGHT][FRAME_WIDTH], int x, int y, unsigned int share)
+{
+    unsigned int sum;
+
+    if (share == 0 || x < 0 || x >= FRAME_WIDTH || y < 0 || y >= FRAME_HEIGHT)
+        return;
+    sum = level[y][x] + share;
+    level[y][x] = sum > 255 ? 255 : sum;
+}
+
+/*
+ * Description
+ *      Draws a sprite at a fractional offset into the frame buffer, splitting every lit pixel 
+ *      over the pixels it covers. Pixels the sprite does not cover are turned off, and pixels 
+ *      that end up off the matrix are dropped.
+ * Parameters 
+ *      1. bitboard shape, lit pixels of the sprite
+ *      2. int x, offset in Q8.8 columns (positive is to the right)
+ *      3. int y, offset in Q8.8 rows (positive is down)
+ *      4. unsigned char r, first color byte (same as writeColor)
+ *      5. unsigned char g, second color byte (same as writeColor)
+ *      6. unsigned char b, third color byte (same as writeColor)
+ * Return
+ *      void
+ */
+void sprite_draw(bitboard shape, int x, int y, unsigned char r, unsigned char g, unsigned char b)
+{
+    unsigned long started = timer_now();
+    unsigned long cycles;
+    unsigned char level[FRAME_HEIGHT][FRAME_WIDTH];
+    unsigned int fx = x & 0xFF, fy = y & 0xFF;  // Fractions, also for negative offsets
+    int ix = x >> 8, iy = y >> 8;               // Whole pixels, rounded down
+    unsigned int w00, w10, w01, w11;
+    unsigned char row, sx, sy, scale;
+
+    // Share of a lit pixel that lands on each of the 2x2 pixels it covers, adding up to 256. 
+    // (256 - fx) * (256 - fy) can be 65536, one more than an unsigned int holds, so the first 
+    // share is what the other three leave.
+    w10 = (fx * (256 - fy)) >> 8;
+    w01 = ((256 - fx) * fy) >> 8;
+    w11 = (fx * fy) >> 8;
+    w00 = 256 - w10 - w01 - w11;
+
+    for (sy = 0; sy < FRAME_HEIGHT; sy++)
+        for (sx = 0; sx < FRAME_WIDTH; sx++)
+            level[sy][sx] = 0;
+
+    for (sy = 0; sy < FRAME_HEIGHT; sy++) {
+        row = bb_row(shape, sy);
+        for (sx = 0; row; sx++, row <<= 1) {
+            if (row & 0x80) {
+                add_share(level, ix + sx, iy + sy, w00);
+                add_share(level, ix + sx + 1, iy + sy, w10);
+                add_share(level, ix + sx, iy + sy + 1, w01);
+                add_share(level, ix + sx + 1, iy + sy + 1, w11);
+            }
+        }
+    }
+
+    for (sy = 0; sy < FRAME_HEIGHT; sy++) {
+        for (sx = 0; sx < FRAME_WIDTH; sx++) {
+            scale = level[sy][sx];
+            frame_set_pixel(sx, sy, ((unsigned int) r * (scale + 1u)) >> 8, 
+                            ((unsigned int) g * (scale + 1u)) >> 8, ((unsigned int) b * (scale + 1u)) >> 8);
+        }
+    }
+
+    cycles = timer_now() - started;
+    if (cycles > totals.max_cycles)
+        totals.max_cycles = cycles;
+    totals.frames++;
+}
+
+/*
+ * Description
+ *      Plays a move at MOTION_FRAME_MS per frame, from its first position to its last one, 
+ *      running the sensor jobs in the gaps.
+ * Parameters 
+ *      1. const motion_t *motion, the move
+ * Return
+ *      void
+ */
+void motion_play(const motion_t *motion)
+{
+    deadline_t deadline = timer_now();
+    unsigned int frame;
+    int done;
+
+    for (frame = 0; frame <= motion->frames; frame++) {
+        done = motion_ease(motion->ease, motion->frames ? ((unsigned long) frame << 8) / motion->frames : 256);
+        sprite_draw(motion->shape, 
+                    motion->from_x + (int) (((long) (motion->to_x - motion->from_x) * done) >> 8), 
+                    motion->from_y + (int) (((long) (motion->to_y - motion->from_y) * done) >> 8), 
+                    motion->r, motion->g, motion->b);
+        frame_show();
+        deadline += (unsigned long) MOTION_FRAME_MS * TIMER_COUNTS_PER_MS;
+        bus_wait_until(deadline);
+    }
+}
+
+/*
+ * Description
+ *      Drawing time statistics since start up.
+ * Parameters 
+ *      1. motion_stats_t *stats, filled in with the statistics
+ * Return
+ *      void
+ */
+void motion_stats(motion_stats_t *stats)
+{
+    *stats = totals;
+}
@@ -0,0 +1,111 @@
+/*
+ * File Description
+ *      Header file for smooth sprite motion: sprites at fractional positions, moved along easing 
+ *      curves.
+ * 
+ * Background
+ *      A sprite is a bitboard (Bitboard.h) drawn at a Q8.8 fixed point offset, 8 integer bits and 
+ *      8 fraction bits, so it can sit between pixels. Each lit pixel of the sprite is split over 
+ *      the 2x2 pixels it covers, in proportion to how much of each it covers (bilinear weights 
+ *      from the fractions), and the shares are added up per pixel and used to scale the color. A 
+ *      sprite a quarter of the way between two columns shows 3/4 in the one and 1/4 in the other, 
+ *      so it moves in steps of 1/256 pixel instead of jumping a whole pixel. All of it is integer 
+ *      math: four multiplies for the weights per frame and a few adds per lit pixel.
+ * 
+ *      A move goes from one position to another over a number of frames. The fraction of the way 
+ *      done is looked up in an easing table (65 entries over the move, interpolated between them), 
+ *      so the same move can start slowly, end slowly or bounce at the end, and changing the speed 
+ *      only means changing the number of frames. At MOTION_FRAME_MS per frame it runs at 50 fps. 
+ *      motion_stats gives the longest time drawing a sprite took, in instruction cycles.
+ */
+
+#ifndef MOTION_H
+#define	MOTION_H
+
+#include <xc.h> // include processor files - each processor file is guarded.  
+#include "Bitboard.h"
+
+#ifdef	__cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+    #define EASE_LINEAR 0   // Same speed all the way
+    #define EASE_IN 1       // Starts slowly and speeds up
+    #define EASE_IN_OUT 2   // Starts and ends slowly
+    #define EASE_BOUNCE 3   // Bounces a few times at the end
+
+    #define MOTION_FRAME_MS 20                      // Time per frame, 50 fps
+    #define MOTION_PIXELS(n) ((int) (n) * 256)      // Whole pixels to Q8.8
+
+    typedef struct {
+        bitboard shape;     // Lit pixels of the sprite at offset (0, 0)
+        int from_x;         // Start offset, Q8.8 columns (positive is to the right)
+        int from_y;         // Start offset, Q8.8 rows (positive is down)
+        int to_x;           // End offset, Q8.8 columns
+        int to_y;           // End offset, Q8.8 rows
+        unsigned int frames; // Frames from start to end
+        unsigned char ease; // One of the EASE_ curves
+        unsigned char r;    // Color, in the same order as writeColor
+        unsigned char g;
+        unsigned char b;
+    } motion_t;
+
+    typedef struct {
+        unsigned long frames;       // Sprites drawn
+        unsigned long max_cycles;   // Longest sprite_draw
+    } motion_stats_t;
+
+    /*
+     * Description
+     *      Fraction of a move done at a point in time, along an easing curve.
+     * Parameters 
+     *      1. unsigned char ease, one of the EASE_ curves
+     *      2. unsigned int t, time from 0 (start) to 256 (end)
+     * Return
+     *      int, fraction done from 0 to 256
+     */
+    int motion_ease(unsigned char ease, unsigned int t);
+
+    /*
+     * Description
+     *      Draws a sprite at a fractional offset into the frame buffer, splitting every lit pixel 
+     *      over the pixels it covers. Pixels the sprite does not cover are turned off, and pixels 
+     *      that end up off the matrix are dropped.
+     * Parameters 
+     *      1. bitboard shape, lit pixels of the sprite
+     *      2. int x, offset in Q8.8 columns (positive is to the right)
+     *      3. int y, offset in Q8.8 rows (positive is down)
+     *      4. unsigned char r, first color byte (same as writeColor)
+     *      5. unsigned char g, second color byte (same as writeColor)
+     *      6. unsigned char b, third color byte (same as writeColor)
+     * Return
+     *      void
+     */
+    void sprite_draw(bitboard shape, int x, int y, unsigned char r, unsigned char g, unsigned char b);
+
+    /*
+     * Description
+     *      Plays a move at MOTION_FRAME_MS per frame, from its first position to its last one, 
+     *      running the sensor jobs in the gaps.
+     * Parameters 
+     *      1. const motion_t *motion, the move
+     * Return
+     *      void
+     */
+    void motion_play(const motion_t *motion);
+
+    /*
+     * Description
+     *      Drawing time statistics since start up.
+     * Parameters 
+     *      1. motion_stats_t *stats, filled in with the statistics
+     * Return
+     *      void
+     */
+    void motion_stats(motion_stats_t *stats);
+
+#ifdef	__cplusplus
+}
+#endif /* __cplusplus */
+
+#endif	/* MOTION_H */
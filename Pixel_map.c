@@ -0,0 +1,15 @@
+/*
+ * File Description
+ *      Source file for the wiring and orientation table of the LED matrix. Every entry is a constant 
+ *      expression, so the table is filled in by the compiler for the settings in Pixel_map.h.
+ */
+
+#include "Pixel_map.h"
+
+#define PIXEL_MAP_ROW(y) PIXEL_MAP(0, y), PIXEL_MAP(1, y), PIXEL_MAP(2, y), PIXEL_MAP(3, y), \
+                         PIXEL_MAP(4, y), PIXEL_MAP(5, y), PIXEL_MAP(6, y), PIXEL_MAP(7, y)
+
+const unsigned char pixel_map[FRAME_PIXELS] = {
+    PIXEL_MAP_ROW(0), PIXEL_MAP_ROW(1), PIXEL_MAP_ROW(2), PIXEL_MAP_ROW(3),
+    PIXEL_MAP_ROW(4), PIXEL_MAP_ROW(5), PIXEL_MAP_ROW(6), PIXEL_MAP_ROW(7)
+};
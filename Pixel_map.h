@@ -0,0 +1,74 @@
+/*
+ * File Description
+ *      Header file for the wiring and orientation of the LED matrix. 
+ * 
+ * Background
+ *      The animations are drawn as if the matrix is wired row by row, top row first and left-most 
+ *      LED first. Some enclosures mount the matrix rotated, mirrored, or use serpentine panels where 
+ *      every other row runs right to left. The settings below describe the panel, and PIXEL_MAP turns 
+ *      a drawing position into the position of that LED in the chain. Because PIXEL_MAP only uses 
+ *      constants, pixel_map[] is computed by the compiler and lives in flash, and the frame buffer 
+ *      stores pixels directly in chain order so frame_show never has to remap anything.
+ * 
+ *      Order of the steps: the drawing is rotated clockwise by MATRIX_ROTATION, then mirrored left to 
+ *      right if MATRIX_MIRROR is 1, then the row and column are turned into a chain index using 
+ *      MATRIX_WIRING. The defaults match the original wiring.
+ */
+
+#ifndef PIXEL_MAP_H
+#define	PIXEL_MAP_H
+
+#include "Frame_buffer.h"
+
+#ifdef	__cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+    #define MATRIX_WIRING_ROWS 0        // Every row runs left to right
+    #define MATRIX_WIRING_SERPENTINE 1  // Even rows left to right, odd rows right to left
+
+    #ifndef MATRIX_WIRING
+    #define MATRIX_WIRING MATRIX_WIRING_ROWS
+    #endif
+    #ifndef MATRIX_ROTATION
+    #define MATRIX_ROTATION 0           // 0, 90, 180 or 270 degrees clockwise
+    #endif
+    #ifndef MATRIX_MIRROR
+    #define MATRIX_MIRROR 0             // 1 to mirror left to right
+    #endif
+
+    #if (MATRIX_ROTATION != 0) && (MATRIX_ROTATION != 90) && (MATRIX_ROTATION != 180) && (MATRIX_ROTATION != 270)
+    #error "MATRIX_ROTATION must be 0, 90, 180 or 270"
+    #endif
+    #if (FRAME_WIDTH != 8) || (FRAME_HEIGHT != 8)
+    #error "pixel_map[] is written out for an 8x8 matrix"
+    #endif
+
+    // Position after rotating the drawing clockwise
+    #define PIXEL_ROT_X(x, y) (MATRIX_ROTATION == 90 ? (FRAME_WIDTH - 1 - (y)) : \
+                               MATRIX_ROTATION == 180 ? (FRAME_WIDTH - 1 - (x)) : \
+                               MATRIX_ROTATION == 270 ? (y) : (x))
+    #define PIXEL_ROT_Y(x, y) (MATRIX_ROTATION == 90 ? (x) : \
+                               MATRIX_ROTATION == 180 ? (FRAME_HEIGHT - 1 - (y)) : \
+                               MATRIX_ROTATION == 270 ? (FRAME_HEIGHT - 1 - (x)) : (y))
+
+    // Column after the optional mirror
+    #define PIXEL_MIR_X(x, y) (MATRIX_MIRROR ? (FRAME_WIDTH - 1 - PIXEL_ROT_X(x, y)) : PIXEL_ROT_X(x, y))
+
+    // Chain index of the LED that shows drawing position (x, y)
+    #define PIXEL_MAP(x, y) (PIXEL_ROT_Y(x, y) * FRAME_WIDTH + \
+                             ((MATRIX_WIRING == MATRIX_WIRING_SERPENTINE) && (PIXEL_ROT_Y(x, y) & 1) ? \
+                              (FRAME_WIDTH - 1 - PIXEL_MIR_X(x, y)) : PIXEL_MIR_X(x, y)))
+
+    /*
+     * Description
+     *      Chain index for every drawing position, indexed by y * FRAME_WIDTH + x. Built from 
+     *      PIXEL_MAP at compile time and kept in flash.
+     */
+    extern const unsigned char pixel_map[FRAME_PIXELS];
+
+#ifdef	__cplusplus
+}
+#endif /* __cplusplus */
+
+#endif	/* PIXEL_MAP_H */
@@ -0,0 +1,193 @@
+/*
+ * File Description
+ *      Source file for the low-power idle support. Holds the Timer1 tick and change notification 
+ *      interrupts, the idle and sleep waits, and the counters used for the awake fraction. The two 
+ *      interrupts are the producers for the event queue: touch edges and frame ticks.
+ */
+
+#include "xc.h"
+#include "Power.h"
+#include "Event_queue.h"
+#include "Trace.h"
+
+// Bit n is set while touch channel n is held (pins are active low, RA1 to RA4)
+#define TOUCH_PINS() ((~PORTA >> 1) & 0x0F)
+
+static volatile unsigned long ticks;       // Timer1 ticks since power_init
+static volatile unsigned long awake_ticks; // Ticks that found the CPU awake
+static volatile unsigned char idling;      // Set while the CPU is in Idle
+static unsigned char touch_state;          // Last TOUCH_PINS() seen by the CN interrupt
+static volatile unsigned int frame_period; // Ticks between frame tick events, 0 for none
+static unsigned int frame_count;           // Ticks since the last frame tick event
+
+/*
+ * Description
+ *      Timer1 interrupt, once per tick. Counts the tick and whether the CPU was awake for it, and 
+ *      queues a frame tick event every frame_period ticks.
+ */
+void __attribute__((interrupt, no_auto_psv)) _T1Interrupt(void)
+{
+    IFS0bits.T1IF = 0;
+    ticks++;
+    if (!idling)
+        awake_ticks++;
+
+    if (frame_period != 0 && ++frame_count >= frame_period) {
+        frame_count = 0;
+        event_push(EVENT_FRAME_TICK, 0);
+    }
+}
+
+/*
+ * Description
+ *      Change notification interrupt. Compares the touch pins with the last state and queues a 
+ *      touch down or touch up event for every channel that changed.
+ */
+void __attribute__((interrupt, no_auto_psv)) _CNInterrupt(void)
+{
+    unsigned char now, changed, channel;
+
+    IFS1bits.CNIF = 0;
+    now = TOUCH_PINS();
+    changed = now ^ touch_state;
+    touch_state = now;
+
+    for (channel = 0; changed != 0; channel++, changed >>= 1, now >>= 1) {
+        if (changed & 1) {
+            event_push((now & 1) ? EVENT_TOUCH_DOWN : EVENT_TOUCH_UP, channel);
+            TRACE_RECORD((now & 1) ? TRACE_TOUCH_DOWN : TRACE_TOUCH_UP, channel, 0);
+        }
+    }
+}
+
+/*
+ * Description
+ *      Starts the Timer1 tick and enables the change notification interrupt on the touch pins 
+ *      (CN3/RA1, CN30/RA2, CN29/RA3 and CN0/RA4). Should be called once after setup_touch_sensor.
+ * Parameters 
+ *      void
+ * Return
+ *      void
+ */
+void power_init(void)
+{
+    T1CON = 0;             // Timer1 off, 1:1 prescale, clocked from FCY
+    TMR1 = 0;
+    PR1 = FCY / POWER_TICK_HZ - 1;
+    IFS0bits.T1IF = 0;
+    IEC0bits.T1IE = 1;
+    T1CONbits.TON = 1;
+
+    CNEN1bits.CN3IE = 1;   // Pin 3 and RA1
+    CNEN2bits.CN30IE = 1;  // Pin 9 and RA2
+    CNEN2bits.CN29IE = 1;  // Pin 10 and RA3
+    CNEN1bits.CN0IE = 1;   // Pin 12 and RA4
+    touch_state = TOUCH_PINS();
+    IFS1bits.CNIF = 0;
+    IEC1bits.CNIE = 1;
+}
+
+/*
+ * Description
+ *      Milliseconds since power_init, counted by the Timer1 tick.
+ * Parameters 
+ *      void
+ * Return
+ *      unsigned long, tick count
+ */
+unsigned long power_ticks(void)
+{
+    unsigned long now;
+
+    do { // The count is two words, read again if the tick changed it in between
+        now = ticks;
+    } while (now != ticks);
+    return now;
+}
+
+/*
+ * Description
+ *      Puts the CPU in Idle until the next interrupt (at most one tick).
+ * Parameters 
+ *      void
+ * Return
+ *      void
+ */
+void power_idle(void)
+{
+    idling = 1;
+    Idle();
+    idling = 0;
+}
+
+/*
+ * Description
+ *      Sets how often the Timer1 interrupt queues an EVENT_FRAME_TICK.
+ * Parameters 
+ *      1. unsigned int period, ticks (ms) between frame ticks, 0 to stop them
+ * Return
+ *      void
+ */
+void power_set_frame_period(unsigned int period)
+{
+    IEC0bits.T1IE = 0; // Change both together without a tick in between
+    frame_period = period;
+    frame_count = 0;
+    IEC0bits.T1IE = 1;
+}
+
+/*
+ * Description
+ *      Returns as soon as there is an event in the queue. Until then the CPU waits in Idle, or in 
+ *      Sleep if POWER_DEEP_SLEEP is defined and no frame ticks are wanted (Timer1 stops in Sleep), 
+ *      and is woken by the interrupt that queues one. The queue is checked with interrupts masked, so an event that comes in just before the wait 
+ *      still wakes the CPU (a pending enabled interrupt ends Idle and Sleep even while it is masked).
+ * Parameters 
+ *      void
+ * Return
+ *      void
+ */
+void power_wait_for_event(void)
+{
+    int save;
+
+    SET_AND_SAVE_CPU_IPL(save, 7);
+    while (!event_pending()) {
+        idling = 1;
+#ifdef POWER_DEEP_SLEEP
+        if (frame_period == 0)
+            Sleep();
+        else
+            Idle();
+#else
+        Idle();
+#endif
+        RESTORE_CPU_IPL(save); // Let the tick and CN interrupts run, still counted as idle
+        idling = 0;
+        SET_AND_SAVE_CPU_IPL(save, 7);
+    }
+    RESTORE_CPU_IPL(save);
+}
+
+/*
+ * Description
+ *      Fraction of the ticks since power_init during which the CPU was awake.
+ * Parameters 
+ *      void
+ * Return
+ *      unsigned int, awake time in 1/1000 (1000 means the CPU never idled)
+ */
+unsigned int power_awake_permille(void)
+{
+    unsigned long total, awake;
+    int save;
+
+    SET_AND_SAVE_CPU_IPL(save, 7); // Read both counters from the same tick
+    total = ticks;
+    awake = awake_ticks;
+    RESTORE_CPU_IPL(save);
+
+    if (total == 0)
+        return 1000;
+    return (unsigned int) (((unsigned long long) awake * 1000) / total);
+}
@@ -0,0 +1,94 @@
+/*
+ * File Description
+ *      Header file for the low-power idle support. Timer1 gives a 1 ms tick that wakes the CPU from 
+ *      Idle, and the change notification (CN) interrupt on the touch pins wakes it when a fruit is 
+ *      touched, so waiting no longer burns nop loops at full speed.
+ * 
+ * Background
+ *      The CPU stops in Idle while the peripherals keep running, so Timer1 keeps counting and wakes it 
+ *      every millisecond. Waiting for an event can use Sleep instead (define POWER_DEEP_SLEEP), which 
+ *      also stops the clocks and only wakes on the CN interrupt. Every tick also records whether the 
+ *      CPU was awake, which gives the fraction of time spent awake. Time spent in Sleep is not seen 
+ *      by the tick, so it is left out of that fraction.
+ */
+
+#ifndef POWER_H
+#define	POWER_H
+
+#include <xc.h> // include processor files - each processor file is guarded.  
+#include "Timer.h"
+
+#ifdef	__cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+    #define POWER_TICK_HZ 1000 // Timer1 tick rate
+
+    /*
+     * Description
+     *      Starts the Timer1 tick and enables the change notification interrupt on the touch pins 
+     *      (CN3/RA1, CN30/RA2, CN29/RA3 and CN0/RA4). Should be called once after setup_touch_sensor.
+     * Parameters 
+     *      void
+     * Return
+     *      void
+     */
+    void power_init(void);
+
+    /*
+     * Description
+     *      Milliseconds since power_init, counted by the Timer1 tick.
+     * Parameters 
+     *      void
+     * Return
+     *      unsigned long, tick count
+     */
+    unsigned long power_ticks(void);
+
+    /*
+     * Description
+     *      Puts the CPU in Idle until the next interrupt (at most one tick).
+     * Parameters 
+     *      void
+     * Return
+     *      void
+     */
+    void power_idle(void);
+
+    /*
+     * Description
+     *      Sets how often the Timer1 interrupt queues an EVENT_FRAME_TICK.
+     * Parameters 
+     *      1. unsigned int period, ticks (ms) between frame ticks, 0 to stop them
+     * Return
+     *      void
+     */
+    void power_set_frame_period(unsigned int period);
+
+    /*
+     * Description
+     *      Returns as soon as there is an event in the queue. Until then the CPU waits in Idle, or in 
+     *      Sleep if POWER_DEEP_SLEEP is defined and no frame ticks are wanted, and is woken by the 
+     *      interrupt that queues one.
+     * Parameters 
+     *      void
+     * Return
+     *      void
+     */
+    void power_wait_for_event(void);
+
+    /*
+     * Description
+     *      Fraction of the ticks since power_init during which the CPU was awake.
+     * Parameters 
+     *      void
+     * Return
+     *      unsigned int, awake time in 1/1000 (1000 means the CPU never idled)
+     */
+    unsigned int power_awake_permille(void);
+
+#ifdef	__cplusplus
+}
+#endif /* __cplusplus */
+
+#endif	/* POWER_H */
@@ -0,0 +1,117 @@
+/*
+ * File Description
+ *      Source file for the sampling profiler. The interrupt only ever adds to the counts and the 
+ *      main loop only reads them with Timer4 stopped, so neither side needs to mask interrupts.
+ */
+
+#include "xc.h"
+#include "Profile.h"
+#include "Stream.h"
+#include "Timer.h"
+
+#ifdef PROFILE
+
+static unsigned int histogram[PROFILE_BUCKETS];
+static unsigned long samples;
+static unsigned long masked;
+static unsigned int outside; // Samples above PROFILE_END, which should never happen
+
+/*
+ * Description
+ *      Clears the histogram and starts Timer4. Should be called once at start up, after 
+ *      stream_init.
+ * Parameters 
+ *      void
+ * Return
+ *      void
+ */
+void profile_init(void)
+{
+    unsigned int i;
+
+    for (i = 0; i < PROFILE_BUCKETS; i++)
+        histogram[i] = 0;
+    samples = 0;
+    masked = 0;
+    outside = 0;
+
+    T4CON = 0;                  // 1:1 prescale, 16-bit
+    TMR4 = 0;
+    PR4 = FCY / PROFILE_HZ - 1;
+    IPC6bits.T4IP = 5;          // Above the other interrupts, so they get sampled too
+    IFS1bits.T4IF = 0;
+    IEC1bits.T4IE = 1;
+    T4CONbits.TON = 1;
+}
+
+/*
+ * Description
+ *      Adds one sample. Only called by the Timer4 interrupt in Assembly.s.
+ * Parameters 
+ *      1. unsigned long pc, the interrupted program address
+ *      2. unsigned int late, cycles between the timer match and the interrupt
+ * Return
+ *      void
+ */
+void profile_sample(unsigned long pc, unsigned int late)
+{
+    if (late > PROFILE_LATE_COUNTS) {
+        masked++; // Held off by a frame push
+        return;
+    }
+    if (pc >= PROFILE_END) {
+        outside++;
+        return;
+    }
+    if (histogram[pc >> PROFILE_SHIFT] != 0xFFFF)
+        histogram[pc >> PROFILE_SHIFT]++;
+    samples++;
+}
+
+/*
+ * Description
+ *      Sends the histogram to the PC. Sampling stops while it is sent.
+ * Parameters 
+ *      1. unsigned char clear, 1 to start a new histogram afterwards
+ * Return
+ *      unsigned char, 1
+ */
+unsigned char profile_dump(unsigned char clear)
+{
+    unsigned char header[15];
+    unsigned int i;
+
+    T4CONbits.TON = 0;
+    header[0] = samples;
+    header[1] = samples >> 8;
+    header[2] = samples >> 16;
+    header[3] = samples >> 24;
+    header[4] = masked;
+    header[5] = masked >> 8;
+    header[6] = masked >> 16;
+    header[7] = masked >> 24;
+    header[8] = outside;
+    header[9] = outside >> 8;
+    header[10] = PROFILE_HZ & 0xFF;
+    header[11] = PROFILE_HZ >> 8;
+    header[12] = PROFILE_SHIFT;
+    header[13] = PROFILE_BUCKETS & 0xFF;
+    header[14] = PROFILE_BUCKETS >> 8;
+
+    stream_send_start(STREAM_TYPE_PROFILE, sizeof(header) + 2 * PROFILE_BUCKETS);
+    for (i = 0; i < sizeof(header); i++)
+        stream_send_byte(header[i]);
+    for (i = 0; i < PROFILE_BUCKETS; i++) {
+        stream_send_byte(histogram[i]);
+        stream_send_byte(histogram[i] >> 8);
+    }
+    stream_send_end();
+
+    if (clear)
+        profile_init();
+    else
+        T4CONbits.TON = 1;
+    return 1;
+}
+
+#endif
@@ -0,0 +1,84 @@
+/*
+ * File Description
+ *      Header file for the sampling profiler, which shows where the CPU time goes on the board.
+ * 
+ * Background
+ *      Timer4 interrupts PROFILE_HZ times a second and the interrupted program address goes into a 
+ *      histogram of 2^PROFILE_SHIFT address units (32 instructions) per bucket. The rate is a 
+ *      prime so the samples do not lock to the 1 ms tick. Only built with PROFILE defined (compile 
+ *      with -DPROFILE and assemble Assembly.s with --defsym PROFILE=1, which has the interrupt) 
+ *      together with UART_STREAM, since the histogram is sent over the stream UART.
+ * 
+ *      The interrupt runs at priority 5, above the other interrupts, so their time is counted too. 
+ *      It cannot get in while a frame is pushed to the LEDs (IPL 7): it is then taken late, right 
+ *      after the push, and would pile the samples of the whole push onto the first instructions 
+ *      after it. A sample taken more than PROFILE_LATE_COUNTS cycles after the timer matched is 
+ *      counted in masked instead, so the histogram only holds samples from outside the pushes and 
+ *      masked tells how much of the time went to them.
+ * 
+ *      The PC asks for the histogram with a STREAM_TYPE_PROFILE frame and gets it back in a frame 
+ *      of the same type (tools/profile_report.py does both and names the functions from the link 
+ *      map). The reply payload, little endian, is
+ * 
+ *      samples (4 bytes) | masked (4 bytes) | outside (2 bytes) | PROFILE_HZ (2 bytes) | 
+ *      PROFILE_SHIFT (1 byte) | bucket count (2 bytes) | one 2 byte count per bucket
+ */
+
+#ifndef PROFILE_H
+#define	PROFILE_H
+
+#include <xc.h> // include processor files - each processor file is guarded.  
+
+#ifdef	__cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+    #if defined(PROFILE) && !defined(UART_STREAM)
+    #error "PROFILE sends the histogram over UART_STREAM"
+    #endif
+
+    #define PROFILE_HZ 1009             // Samples per second
+    #define PROFILE_SHIFT 6             // 64 address units, 32 instructions per bucket
+    #define PROFILE_END 0xAC00UL        // End of program memory (22016 instructions)
+    #define PROFILE_BUCKETS (unsigned int) (PROFILE_END >> PROFILE_SHIFT)
+    #define PROFILE_LATE_COUNTS 64      // Cycles after the match by which a sample counts as masked
+
+    #define STREAM_TYPE_PROFILE 0x20    // payload: 1 to clear the histogram after sending it, else 0
+
+    /*
+     * Description
+     *      Clears the histogram and starts Timer4. Should be called once at start up, after 
+     *      stream_init.
+     * Parameters 
+     *      void
+     * Return
+     *      void
+     */
+    void profile_init(void);
+
+    /*
+     * Description
+     *      Adds one sample. Only called by the Timer4 interrupt in Assembly.s.
+     * Parameters 
+     *      1. unsigned long pc, the interrupted program address
+     *      2. unsigned int late, cycles between the timer match and the interrupt
+     * Return
+     *      void
+     */
+    void profile_sample(unsigned long pc, unsigned int late);
+
+    /*
+     * Description
+     *      Sends the histogram to the PC. Sampling stops while it is sent.
+     * Parameters 
+     *      1. unsigned char clear, 1 to start a new histogram afterwards
+     * Return
+     *      unsigned char, 1
+     */
+    unsigned char profile_dump(unsigned char clear);
+
+#ifdef	__cplusplus
+}
+#endif /* __cplusplus */
+
+#endif	/* PROFILE_H */
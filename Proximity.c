@@ -0,0 +1,72 @@
+/*
+ * File Description
+ *      Source file for the proximity values. The averages are kept in 8.8 fixed point so small 
+ *      changes are not lost to the shift.
+ */
+
+#include "xc.h"
+#include "Proximity.h"
+
+static int average[TOUCH_CHANNELS]; // Smoothed delta counts, 8.8 fixed point
+
+/*
+ * Description
+ *      Reads the 8 delta counts of a CAP1188 in one burst and updates the smoothed values. 
+ *      Takes about 1 ms of I2C time, so it can run once per frame. If the device does not answer 
+ *      the values are left as they are.
+ * Parameters 
+ *      1. touch_device_t *device, the CAP1188 to read
+ * Return
+ *      void
+ */
+void proximity_update(touch_device_t *device)
+{
+    signed char delta[TOUCH_CHANNELS];
+    unsigned char c;
+
+    if (!touch_device_read_block(device, TOUCH_DELTA_COUNT, (unsigned char *) delta, TOUCH_CHANNELS))
+        return;
+
+    // The step is worked out in long: a full delta (127 * 256) less a negative average is more than 
+    // an int holds
+    for (c = 0; c < TOUCH_CHANNELS; c++)
+        average[c] += (int) (((long) delta[c] * 256 - average[c]) >> PROXIMITY_SHIFT);
+}
+
+/*
+ * Description
+ *      Smoothed proximity of one channel.
+ * Parameters 
+ *      1. unsigned char channel, the channel (0 to 7)
+ * Return
+ *      unsigned char, 0 for nothing near to 255 for a touch
+ */
+unsigned char proximity_level(unsigned char channel)
+{
+    int value = average[channel];
+
+    if (value <= 0) // The count drops below the baseline when nothing is near
+        return 0;
+    if (value >= PROXIMITY_FULL << 8)
+        return 255;
+    return ((unsigned long) value * 255) / (PROXIMITY_FULL << 8);
+}
+
+/*
+ * Description
+ *      Channel with the highest proximity, the fruit the hand is closest to.
+ * Parameters 
+ *      void
+ * Return
+ *      unsigned char, the channel (0 to 7)
+ */
+unsigned char proximity_nearest(void)
+{
+    unsigned char c, nearest = 0;
+
+    for (c = 1; c < TOUCH_CHANNELS; c++) {
+        if (average[c] > average[nearest])
+            nearest = c;
+    }
+    return nearest;
+}
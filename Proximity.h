@@ -0,0 +1,64 @@
+/*
+ * File Description
+ *      Header file for the proximity values made from the CAP1188 delta counts. 
+ * 
+ * Background
+ *      Besides the touched / not touched status, the CAP1188 gives a signed delta count for every 
+ *      channel (registers 0x10 to 0x17). It starts to rise before the fruit is touched, as a hand 
+ *      comes close, and reaches the touch threshold on contact. proximity_update reads all 8 delta 
+ *      counts in one burst and runs each through an exponential moving average, so the value does 
+ *      not flicker from one sample to the next. The result is scaled so PROXIMITY_FULL (the default 
+ *      touch threshold) gives 255.
+ */
+
+#ifndef PROXIMITY_H
+#define	PROXIMITY_H
+
+#include <xc.h> // include processor files - each processor file is guarded.  
+#include "Touch_sensor.h"
+
+#ifdef	__cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+    #define PROXIMITY_SHIFT 2   // Each update moves the average 1/4 of the way to the new delta count
+    #define PROXIMITY_FULL 64   // Smoothed delta count shown as full proximity
+    #define PROXIMITY_FRAME_MS 40 // How often the glow is updated when PROXIMITY_GLOW is defined
+
+    /*
+     * Description
+     *      Reads the 8 delta counts of a CAP1188 in one burst and updates the smoothed values. 
+     *      Takes about 1 ms of I2C time, so it can run once per frame. If the device does not answer 
+     *      the values are left as they are.
+     * Parameters 
+     *      1. touch_device_t *device, the CAP1188 to read
+     * Return
+     *      void
+     */
+    void proximity_update(touch_device_t *device);
+
+    /*
+     * Description
+     *      Smoothed proximity of one channel.
+     * Parameters 
+     *      1. unsigned char channel, the channel (0 to 7)
+     * Return
+     *      unsigned char, 0 for nothing near to 255 for a touch
+     */
+    unsigned char proximity_level(unsigned char channel);
+
+    /*
+     * Description
+     *      Channel with the highest proximity, the fruit the hand is closest to.
+     * Parameters 
+     *      void
+     * Return
+     *      unsigned char, the channel (0 to 7)
+     */
+    unsigned char proximity_nearest(void);
+
+#ifdef	__cplusplus
+}
+#endif /* __cplusplus */
+
+#endif	/* PROXIMITY_H */
@@ -0,0 +1,162 @@
+/*
+ * File Description
+ *      Source file for playing animations from an external SPI NOR flash chip. Frames alternate 
+ *      between two buffers: one is drawn while the other is being read.
+ */
+
+#include "xc.h"
+#include "Spi_flash.h"
+#include "Frame_buffer.h"
+#include "Bus.h"
+
+static unsigned char buffers[2][SPI_FLASH_FRAME_BYTES];
+static spi_flash_stats_t totals;
+
+/*
+ * Description
+ *      Sends one byte and returns the byte received at the same time.
+ * Parameters 
+ *      1. unsigned char byte, the byte to send
+ * Return
+ *      unsigned char, the byte received
+ */
+static unsigned char spi_transfer(unsigned char byte)
+{
+    SPI1BUF = byte;
+    while (!SPI1STATbits.SPIRBF) {}
+    return SPI1BUF;
+}
+
+/*
+ * Description
+ *      Sets up SPI1 and the chip select pin. Should be called once at start up.
+ * Parameters 
+ *      void
+ * Return
+ *      void
+ */
+void spi_flash_init(void)
+{
+    LATBbits.LATB15 = 1;    // Chip select high, chip not selected
+    TRISBbits.TRISB15 = 0;
+    TRISBbits.TRISB14 = 1;  // SDI is an input
+
+    __builtin_write_OSCCONL(OSCCON & 0xBF); // Unlock the peripheral pin select registers
+    RPOR6bits.RP12R = 8;    // SCK1 out on RP12, pin 23
+    RPOR6bits.RP13R = 7;    // SDO1 on RP13, pin 24
+    RPINR20bits.SDI1R = 14; // SDI1 on RP14, pin 25
+    __builtin_write_OSCCONL(OSCCON | 0x40); // Lock them again
+
+    SPI1STAT = 0;
+    SPI1CON1 = 0;
+    SPI1CON1bits.MSTEN = 1; // Master
+    SPI1CON1bits.CKE = 1;   // Mode 0: data changes on the falling edge, idle low
+    SPI1CON1bits.PPRE = 3;  // 1:1 primary prescale
+    SPI1CON1bits.SPRE = 6;  // 2:1 secondary prescale, SCK = FCY / 2 = 8 MHz
+    SPI1STATbits.SPIEN = 1;
+}
+
+/*
+ * Description
+ *      Reads bytes from the chip.
+ * Parameters 
+ *      1. unsigned long address, first byte on the chip
+ *      2. unsigned char *data, filled in with the bytes
+ *      3. unsigned int count, number of bytes
+ * Return
+ *      void
+ */
+void spi_flash_read(unsigned long address, unsigned char *data, unsigned int count)
+{
+    LATBbits.LATB15 = 0;
+    spi_transfer(SPI_FLASH_READ);
+    spi_transfer(address >> 16);
+    spi_transfer(address >> 8);
+    spi_transfer(address);
+    while (count--)
+        *data++ = spi_transfer(0xFF);
+    LATBbits.LATB15 = 1;
+}
+
+/*
+ * Description
+ *      Plays the animation on the chip once, reading each frame ahead while the previous one 
+ *      is on the matrix.
+ * Parameters 
+ *      void
+ * Return
+ *      unsigned char, 1 if it played, 0 if the chip holds no animation
+ */
+unsigned char spi_flash_play(void)
+{
+    unsigned char header[SPI_FLASH_HEADER_BYTES];
+    unsigned long frames, n, address, started, slack;
+    unsigned int period;
+    unsigned char current = 0;
+    unsigned char x, y;
+    const unsigned char *color;
+    deadline_t deadline;
+
+    spi_flash_read(0, header, SPI_FLASH_HEADER_BYTES);
+    if (header[0] != 'S' || header[1] != 'F')
+        return 0;
+    period = header[2] | ((unsigned int) header[3] << 8);
+    frames = header[4] | ((unsigned long) header[5] << 8) | 
+             ((unsigned long) header[6] << 16) | ((unsigned long) header[7] << 24);
+
+    totals.frames = 0;
+    totals.late = 0;
+    totals.max_read_us = 0;
+    totals.min_slack_us = 0xFFFFFFFF;
+
+    address = SPI_FLASH_HEADER_BYTES;
+    spi_flash_read(address, buffers[current], SPI_FLASH_FRAME_BYTES);
+    deadline = timer_now();
+
+    for (n = 0; n < frames; n++) {
+        color = buffers[current];
+        for (y = 0; y < FRAME_HEIGHT; y++) {
+            for (x = 0; x < FRAME_WIDTH; x++) {
+                frame_set_pixel(x, y, color[0], color[1], color[2]);
+                color += 3;
+            }
+        }
+        frame_show();
+        totals.frames++;
+        deadline += (unsigned long) period * TIMER_COUNTS_PER_MS;
+
+        if (n + 1 < frames) { // Read ahead into the other buffer, first thing in the gap
+            current ^= 1;
+            address += SPI_FLASH_FRAME_BYTES;
+            started = timer_now();
+            spi_flash_read(address, buffers[current], SPI_FLASH_FRAME_BYTES);
+            if ((timer_now() - started) / TIMER_COUNTS_PER_US > totals.max_read_us)
+                totals.max_read_us = (timer_now() - started) / TIMER_COUNTS_PER_US;
+
+            if (deadline_expired(deadline)) {
+                totals.late++;
+                totals.min_slack_us = 0;
+                deadline = timer_now(); // Carry on from now rather than rushing to catch up
+            } else {
+                slack = (deadline - timer_now()) / TIMER_COUNTS_PER_US;
+                if (slack < totals.min_slack_us)
+                    totals.min_slack_us = slack;
+            }
+        }
+        bus_wait_until(deadline); // Sensor jobs still run in what is left of the gap
+    }
+    return 1;
+}
+
+/*
+ * Description
+ *      Statistics of the last spi_flash_play.
+ * Parameters 
+ *      1. spi_flash_stats_t *stats, filled in with the statistics
+ * Return
+ *      void
+ */
+void spi_flash_stats(spi_flash_stats_t *stats)
+{
+    *stats = totals;
+}
@@ -0,0 +1,91 @@
+/*
+ * File Description
+ *      Header file for playing long animations from an external SPI NOR flash chip.
+ * 
+ * Background
+ *      The chip is on SPI1 at 8 MHz (mode 0): SCK on RP12 (pin 23), SDO on RP13 (pin 24), SDI on 
+ *      RP14 (pin 25) and chip select on RB15 (pin 26). These are the pins of strings 4 to 7 when 
+ *      LED_STRINGS (Frame_buffer.h) is above 4, so the two cannot be used together. The chip holds
+ * 
+ *      offset 0    'S', 'F' (magic)
+ *      offset 2    time per frame in ms (2 bytes, low first)
+ *      offset 4    number of frames (4 bytes, low first)
+ *      offset 8    frames, 192 bytes each: 3 bytes per pixel in writeColor order, row by row from 
+ *                  the top-left pixel
+ * 
+ *      so the length of an animation is only limited by the size of the chip (about 87000 frames 
+ *      on a 16 MB part). Reading a frame takes about 300 us. The LED push keeps the CPU busy with 
+ *      interrupts masked and there is no DMA, so the next frame cannot be read during the push 
+ *      itself. Instead it is read right after it, at the start of the gap, into the second of 
+ *      two frame buffers, so it is ready before its deadline and the push always starts on time. 
+ *      spi_flash_stats tells whether this keeps up at the frame rate of the animation.
+ */
+
+#ifndef SPI_FLASH_H
+#define	SPI_FLASH_H
+
+#include <xc.h> // include processor files - each processor file is guarded.  
+
+#ifdef	__cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+    #define SPI_FLASH_READ 0x03         // Read data command of SPI NOR chips
+    #define SPI_FLASH_HEADER_BYTES 8
+    #define SPI_FLASH_FRAME_BYTES 192   // One 8x8 frame at 3 bytes per pixel
+
+    typedef struct {
+        unsigned long frames;       // Frames shown
+        unsigned long late;         // Frames whose read-ahead was not done by their deadline
+        unsigned long max_read_us;  // Longest read of one frame
+        unsigned long min_slack_us; // Least time left between a finished read and its deadline
+    } spi_flash_stats_t;
+
+    /*
+     * Description
+     *      Sets up SPI1 and the chip select pin. Should be called once at start up.
+     * Parameters 
+     *      void
+     * Return
+     *      void
+     */
+    void spi_flash_init(void);
+
+    /*
+     * Description
+     *      Reads bytes from the chip.
+     * Parameters 
+     *      1. unsigned long address, first byte on the chip
+     *      2. unsigned char *data, filled in with the bytes
+     *      3. unsigned int count, number of bytes
+     * Return
+     *      void
+     */
+    void spi_flash_read(unsigned long address, unsigned char *data, unsigned int count);
+
+    /*
+     * Description
+     *      Plays the animation on the chip once, reading each frame ahead while the previous one 
+     *      is on the matrix.
+     * Parameters 
+     *      void
+     * Return
+     *      unsigned char, 1 if it played, 0 if the chip holds no animation
+     */
+    unsigned char spi_flash_play(void);
+
+    /*
+     * Description
+     *      Statistics of the last spi_flash_play.
+     * Parameters 
+     *      1. spi_flash_stats_t *stats, filled in with the statistics
+     * Return
+     *      void
+     */
+    void spi_flash_stats(spi_flash_stats_t *stats);
+
+#ifdef	__cplusplus
+}
+#endif /* __cplusplus */
+
+#endif	/* SPI_FLASH_H */
@@ -0,0 +1,57 @@
+/*
+ * File Description
+ *      Source file for stack painting and the stack high-water mark.
+ */
+
+#include "xc.h"
+#include "Stack.h"
+
+extern unsigned int _SP_init; // __SP_init from the linker, first word of the stack
+
+/*
+ * Description
+ *      Fills the stack above the current stack pointer with STACK_PAINT. Should be called once, 
+ *      first thing in main and before interrupts are enabled.
+ * Parameters 
+ *      void
+ * Return
+ *      void
+ */
+void stack_paint(void)
+{
+    volatile unsigned int *word = (volatile unsigned int *) WREG15 + STACK_PAINT_MARGIN;
+
+    while (word <= (volatile unsigned int *) SPLIM)
+        *word++ = STACK_PAINT;
+}
+
+/*
+ * Description
+ *      Most stack used since stack_paint, interrupts included. Scans down from SPLIM, so it takes 
+ *      longer the less has been used (about 1 ms with 6 KB unused).
+ * Parameters 
+ *      void
+ * Return
+ *      unsigned int, bytes used
+ */
+unsigned int stack_high_water(void)
+{
+    const volatile unsigned int *word = (const volatile unsigned int *) SPLIM;
+
+    while (word >= &_SP_init && *word == STACK_PAINT)
+        word--;
+    return (unsigned int) (word + 1) - (unsigned int) &_SP_init;
+}
+
+/*
+ * Description
+ *      Size of the stack set by the linker.
+ * Parameters 
+ *      void
+ * Return
+ *      unsigned int, bytes
+ */
+unsigned int stack_size(void)
+{
+    return SPLIM + 2 - (unsigned int) &_SP_init;
+}
@@ -0,0 +1,63 @@
+/*
+ * File Description
+ *      Header file for measuring how much of the stack has been used.
+ * 
+ * Background
+ *      The PIC24 stack grows up from __SP_init to SPLIM, both set by the linker from whatever RAM 
+ *      is left after the statics, and running past SPLIM is a stack error trap. The animations keep 
+ *      their pixel arrays on the stack (orange is 160 bytes, grape 192), and the interrupts push onto 
+ *      the same stack, so the deepest point is only known by running. stack_paint fills the unused 
+ *      part with a pattern at boot and stack_high_water finds the highest word that no longer holds 
+ *      it. The difference to stack_size is the RAM that can still go to new buffers; 
+ *      tools/map_report.py tells where the rest went.
+ */
+
+#ifndef STACK_H
+#define	STACK_H
+
+#include <xc.h> // include processor files - each processor file is guarded.  
+
+#ifdef	__cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+    #define STACK_PAINT 0x5AA5      // Pattern left in words the stack has never reached
+    #define STACK_PAINT_MARGIN 8    // Words above the stack pointer left alone while painting
+
+    /*
+     * Description
+     *      Fills the stack above the current stack pointer with STACK_PAINT. Should be called once, 
+     *      first thing in main and before interrupts are enabled.
+     * Parameters 
+     *      void
+     * Return
+     *      void
+     */
+    void stack_paint(void);
+
+    /*
+     * Description
+     *      Most stack used since stack_paint, interrupts included. Scans down from SPLIM, so it takes 
+     *      longer the less has been used (about 1 ms with 6 KB unused).
+     * Parameters 
+     *      void
+     * Return
+     *      unsigned int, bytes used
+     */
+    unsigned int stack_high_water(void);
+
+    /*
+     * Description
+     *      Size of the stack set by the linker.
+     * Parameters 
+     *      void
+     * Return
+     *      unsigned int, bytes
+     */
+    unsigned int stack_size(void);
+
+#ifdef	__cplusplus
+}
+#endif /* __cplusplus */
+
+#endif	/* STACK_H */
@@ -0,0 +1,355 @@
+/*
+ * File Description
+ *      Source file for the live frame streaming mode. The receive interrupt is the only producer 
+ *      of the ring buffer and the main loop the only consumer, the same way as the event queue. 
+ *      The interrupt queues an EVENT_STREAM_RX when it finds the ring empty, so the main loop can 
+ *      wait in Idle between bytes and still never miss data.
+ */
+
+#include "xc.h"
+#include "Stream.h"
+#include "Event_queue.h"
+#include "Frame_buffer.h"
+#include "Anim_store.h"
+#include "Profile.h"
+#include "Trace.h"
+
+#define RX_MASK (STREAM_RX_SIZE - 1)
+#define RGB_LENGTH (FRAME_PIXELS * 3)
+#define PALETTE_LENGTH (16 * 3)
+#define BPP4_LENGTH (PALETTE_LENGTH + FRAME_PIXELS / 2)
+#define STORE_ROW_LENGTH (2 + ANIM_ROW_BYTES)
+
+#if (STREAM_RX_SIZE & RX_MASK) != 0 || STREAM_RX_SIZE > 128
+#error "STREAM_RX_SIZE must be a power of two no larger than 128"
+#endif
+
+// Parser states, in the order the fields come
+#define WAIT_SYNC 0
+#define WAIT_TYPE 1
+#define WAIT_LENGTH_LOW 2
+#define WAIT_LENGTH_HIGH 3
+#define WAIT_PAYLOAD 4
+#define WAIT_CRC_HIGH 5
+#define WAIT_CRC_LOW 6
+
+// CRC-16/CCITT of every 4-bit value, so a byte takes two lookups instead of eight shifts
+static const unsigned int crc_nibble[16] = {
+    0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7,
+    0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF
+};
+
+static unsigned char rx[STREAM_RX_SIZE];
+static volatile unsigned char rx_head;  // Only changed by the receive interrupt
+static volatile unsigned char rx_tail;  // Only changed by stream_poll
+
+static unsigned char payload[2][RGB_LENGTH]; // Front and back frame buffers
+static unsigned char payload_type[2];
+static unsigned char back;          // Buffer the parser writes
+static unsigned char front_ready;   // The other buffer holds a frame that was not shown yet
+
+static unsigned char state = WAIT_SYNC;
+static unsigned char type;
+static unsigned int length;
+static unsigned int count;          // Payload bytes received so far
+static unsigned int crc;            // CRC of the frame so far
+static unsigned int crc_received;
+static unsigned int tx_crc;         // CRC of the frame being sent
+
+static stream_stats_t totals;
+static volatile unsigned int overruns;   // Changed by the receive interrupt
+static volatile unsigned int ring_drops; // Changed by the receive interrupt
+
+/*
+ * Description
+ *      UART1 receive interrupt. Moves every byte in the receive FIFO into the ring buffer.
+ */
+void __attribute__((interrupt, no_auto_psv)) _U1RXInterrupt(void)
+{
+    unsigned char head = rx_head;
+    unsigned char was_empty = (head == rx_tail);
+    unsigned char byte;
+
+    IFS0bits.U1RXIF = 0;
+    while (U1STAbits.URXDA) {
+        byte = U1RXREG;
+        if ((unsigned char) (head - rx_tail) < STREAM_RX_SIZE)
+            rx[head++ & RX_MASK] = byte;
+        else
+            ring_drops++;
+    }
+    if (U1STAbits.OERR) { // The FIFO filled up while interrupts were masked
+        U1STAbits.OERR = 0;
+        overruns++;
+    }
+    rx_head = head;
+
+    if (was_empty && head != rx_tail)
+        event_push(EVENT_STREAM_RX, 0);
+}
+
+/*
+ * Description
+ *      Sets up UART1 at 1 Mbaud on RP6 (RX) and RP7 (TX) and enables the receive interrupt. 
+ *      Should be called once at start up.
+ * Parameters 
+ *      void
+ * Return
+ *      void
+ */
+void stream_init(void)
+{
+    TRISBbits.TRISB6 = 1; // RX is an input
+
+    __builtin_write_OSCCONL(OSCCON & 0xBF); // Unlock the peripheral pin select registers
+    RPINR18bits.U1RXR = 6;  // U1RX on RP6, pin 15
+    RPOR3bits.RP7R = 3;     // U1TX on RP7, pin 16
+    __builtin_write_OSCCONL(OSCCON | 0x40); // Lock them again
+
+    U1MODE = 0;
+    U1MODEbits.BRGH = 1;    // 4 clocks per bit
+    U1BRG = 3;              // FCY / (4 * (3 + 1)) = 1 Mbaud, 8N1
+    U1STA = 0;              // Interrupt on every received byte
+    U1MODEbits.UARTEN = 1;
+    U1STAbits.UTXEN = 1;
+
+    IFS0bits.U1RXIF = 0;
+    IEC0bits.U1RXIE = 1;
+}
+
+/*
+ * Description
+ *      Sends one byte back to the PC, waiting while the transmit FIFO is full.
+ * Parameters 
+ *      1. unsigned char byte, the byte
+ * Return
+ *      void
+ */
+static void send(unsigned char byte)
+{
+    while (U1STAbits.UTXBF) {}
+    U1TXREG = byte;
+}
+
+/*
+ * Description
+ *      Adds one byte to the CRC of a frame. The masks cost nothing where int is 16 bits and keep 
+ *      the CRC to 16 bits where it is wider (the host test).
+ * Parameters 
+ *      1. unsigned int *sum, the CRC so far
+ *      2. unsigned char byte, the byte
+ * Return
+ *      void
+ */
+static void crc_add(unsigned int *sum, unsigned char byte)
+{
+    *sum = ((*sum << 4) & 0xFFFF) ^ crc_nibble[(*sum >> 12) ^ (byte >> 4)];
+    *sum = ((*sum << 4) & 0xFFFF) ^ crc_nibble[(*sum >> 12) ^ (byte & 0x0F)];
+}
+
+/*
+ * Description
+ *      Moves the parser one byte forward.
+ * Parameters 
+ *      1. unsigned char byte, the next byte from the ring buffer
+ * Return
+ *      void
+ */
+static void parse(unsigned char byte)
+{
+    switch (state) {
+    case WAIT_SYNC:
+        if (byte == STREAM_SYNC) {
+            crc = 0xFFFF;
+            state = WAIT_TYPE;
+        }
+        break;
+    case WAIT_TYPE:
+        type = byte;
+        crc_add(&crc, byte);
+        state = WAIT_LENGTH_LOW;
+        break;
+    case WAIT_LENGTH_LOW:
+        length = byte;
+        crc_add(&crc, byte);
+        state = WAIT_LENGTH_HIGH;
+        break;
+    case WAIT_LENGTH_HIGH:
+        length |= (unsigned int) byte << 8;
+        crc_add(&crc, byte);
+        if ((type == STREAM_TYPE_RGB && length == RGB_LENGTH) || 
+            (type == STREAM_TYPE_4BPP && length == BPP4_LENGTH) || 
+            (type == STREAM_TYPE_STORE_ERASE && length == 2) || 
+            (type == STREAM_TYPE_STORE_ROW && length == STORE_ROW_LENGTH) || 
+            (type == STREAM_TYPE_STORE_CHECK && length == 1)
+#ifdef PROFILE
+            || (type == STREAM_TYPE_PROFILE && length == 1)
+#endif
+#ifdef TRACE
+            || (type == STREAM_TYPE_TRACE && length == 1)
+#endif
+            ) {
+            count = 0;
+            state = WAIT_PAYLOAD;
+        } else { // Unknown type or wrong length, look for the next sync byte
+            totals.length_errors++;
+            send(STREAM_NAK);
+            state = WAIT_SYNC;
+        }
+        break;
+    case WAIT_PAYLOAD:
+        payload[back][count++] = byte;
+        crc_add(&crc, byte);
+        if (count == length)
+            state = WAIT_CRC_HIGH;
+        break;
+    case WAIT_CRC_HIGH:
+        crc_received = (unsigned int) byte << 8;
+        state = WAIT_CRC_LOW;
+        break;
+    case WAIT_CRC_LOW:
+        crc_received |= byte;
+#ifdef PROFILE
+        if (crc_received == crc && type == STREAM_TYPE_PROFILE) {
+            profile_dump(payload[back][0]); // The reply frame is the answer, no ACK
+        } else
+#endif
+#ifdef TRACE
+        if (crc_received == crc && type == STREAM_TYPE_TRACE) {
+            trace_dump(payload[back][0]);
+        } else
+#endif
+        if (crc_received == crc && type >= STREAM_TYPE_STORE_ERASE) { // Upload to the animation library
+            send(anim_store_command(type, payload[back]) ? STREAM_ACK : STREAM_NAK);
+        } else if (crc_received == crc) { // The back buffer becomes the front buffer
+            totals.frames++;
+            payload_type[back] = type;
+            back ^= 1;
+            front_ready = 1;
+        } else {
+            totals.crc_errors++;
+            send(STREAM_NAK);
+        }
+        state = WAIT_SYNC;
+        break;
+    }
+}
+
+/*
+ * Description
+ *      Parses every byte received so far. A complete frame with a good CRC becomes the front 
+ *      buffer, ready for stream_show.
+ * Parameters 
+ *      void
+ * Return
+ *      void
+ */
+void stream_poll(void)
+{
+    unsigned char tail = rx_tail;
+
+    while (tail != rx_head) {
+        parse(rx[tail & RX_MASK]);
+        tail++;
+        rx_tail = tail;
+    }
+}
+
+/*
+ * Description
+ *      Draws the newest complete frame into the frame buffer, sends it to the LEDs and 
+ *      acknowledges it to the PC.
+ * Parameters 
+ *      void
+ * Return
+ *      unsigned char, 1 if a frame was shown, 0 if there was no new frame
+ */
+unsigned char stream_show(void)
+{
+    const unsigned char *p, *color;
+    unsigned char x, y, index;
+
+    if (!front_ready)
+        return 0;
+
+    p = payload[back ^ 1];
+    for (y = 0; y < FRAME_HEIGHT; y++) {
+        for (x = 0; x < FRAME_WIDTH; x++) {
+            if (payload_type[back ^ 1] == STREAM_TYPE_RGB) {
+                color = p + (y * FRAME_WIDTH + x) * 3;
+            } else {
+                index = p[PALETTE_LENGTH + (y * FRAME_WIDTH + x) / 2];
+                index = (x & 1) ? (index & 0x0F) : (index >> 4);
+                color = p + index * 3;
+            }
+            frame_set_pixel(x, y, color[0], color[1], color[2]);
+        }
+    }
+    front_ready = 0;
+    frame_show();
+    totals.shown++;
+    send(STREAM_ACK); // The PC may send the next frame now that interrupts are back on
+    return 1;
+}
+
+/*
+ * Description
+ *      Starts a frame to the PC, in the same format as the frames from the PC. Must be followed 
+ *      by exactly length calls of stream_send_byte and then stream_send_end.
+ * Parameters 
+ *      1. unsigned char frame_type, the type
+ *      2. unsigned int frame_length, the payload length
+ * Return
+ *      void
+ */
+void stream_send_start(unsigned char frame_type, unsigned int frame_length)
+{
+    send(STREAM_SYNC);
+    tx_crc = 0xFFFF;
+    stream_send_byte(frame_type);
+    stream_send_byte(frame_length);
+    stream_send_byte(frame_length >> 8);
+}
+
+/*
+ * Description
+ *      Sends one payload byte of a frame to the PC.
+ * Parameters 
+ *      1. unsigned char byte, the byte
+ * Return
+ *      void
+ */
+void stream_send_byte(unsigned char byte)
+{
+    send(byte);
+    crc_add(&tx_crc, byte);
+}
+
+/*
+ * Description
+ *      Ends a frame to the PC with its CRC.
+ * Parameters 
+ *      void
+ * Return
+ *      void
+ */
+void stream_send_end(void)
+{
+    send(tx_crc >> 8);
+    send(tx_crc);
+}
+
+/*
+ * Description
+ *      Statistics since stream_init.
+ * Parameters 
+ *      1. stream_stats_t *stats, filled in with the statistics
+ * Return
+ *      void
+ */
+void stream_stats(stream_stats_t *stats)
+{
+    *stats = totals;
+    stats->overruns = overruns;
+    stats->ring_drops = ring_drops;
+}
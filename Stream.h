@@ -0,0 +1,135 @@
+/*
+ * File Description
+ *      Header file for the live frame streaming mode, which shows frames sent from a PC over UART1 
+ *      instead of the built-in animations.
+ * 
+ * Background
+ *      UART1 runs at 1 Mbaud (BRGH = 1, U1BRG = 3 at FCY = 16 MHz) with RX on RP6 (pin 15) and TX on 
+ *      RP7 (pin 16). The receive interrupt only moves bytes into a ring buffer, and the main loop 
+ *      parses them into the back one of two frame buffers while the front one is shown. Each 
+ *      frame on the wire is
+ * 
+ *      0xA5 | type | length (2 bytes, low first) | payload | CRC (2 bytes, high first)
+ * 
+ *      with a CRC-16/CCITT (polynomial 0x1021, start 0xFFFF) over type, length and payload. 
+ *      STREAM_TYPE_RGB sends 3 bytes per pixel in writeColor order, row by row from the top-left 
+ *      pixel. STREAM_TYPE_4BPP sends a 16 color palette (3 bytes each) and then one 4-bit palette 
+ *      index per pixel, left pixel in the high nibble. The STREAM_TYPE_STORE_ types upload 
+ *      animations to program flash instead (Anim_store.h), and STREAM_TYPE_PROFILE asks for the 
+ *      profiler histogram (Profile.h) and STREAM_TYPE_TRACE the trace ring (Trace.h), which come 
+ *      back in frames of the same format.
+ * 
+ *      Pushing a frame to the LEDs masks interrupts for about 2 ms, longer than the 4 byte receive 
+ *      FIFO lasts at 1 Mbaud, so the PC must not send while a frame goes out. After a frame is 
+ *      shown STREAM_ACK is sent back, and the PC sends the next frame when it gets it (a bad 
+ *      frame gets STREAM_NAK). Parsing keeps up with the bytes as they arrive, so the frame rate 
+ *      is set by the wire time of a frame plus the LED push: about 350 fps for 4bpp frames and 
+ *      250 fps for RGB frames.
+ */
+
+#ifndef STREAM_H
+#define	STREAM_H
+
+#include <xc.h> // include processor files - each processor file is guarded.  
+
+#ifdef	__cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+    #define STREAM_SYNC 0xA5
+    #define STREAM_TYPE_RGB 0x01    // 192 byte payload
+    #define STREAM_TYPE_4BPP 0x02   // 80 byte payload: 48 byte palette, 32 bytes of indices
+    #define STREAM_ACK 0x06         // Sent after a frame is shown
+    #define STREAM_NAK 0x15         // Sent for a frame with a bad CRC or length
+
+    #define STREAM_RX_SIZE 128      // Ring buffer size, a power of two no larger than 128
+
+    typedef struct {
+        unsigned long frames;       // Frames received with a good CRC
+        unsigned long shown;        // Frames shown (the rest were replaced by a newer one first)
+        unsigned int crc_errors;    // Frames dropped because of the CRC
+        unsigned int length_errors; // Frames dropped because the length does not fit the type
+        unsigned int overruns;      // Times the UART receive FIFO overflowed
+        unsigned int ring_drops;    // Bytes dropped because the ring buffer was full
+    } stream_stats_t;
+
+    /*
+     * Description
+     *      Sets up UART1 at 1 Mbaud on RP6 (RX) and RP7 (TX) and enables the receive interrupt. 
+     *      Should be called once at start up.
+     * Parameters 
+     *      void
+     * Return
+     *      void
+     */
+    void stream_init(void);
+
+    /*
+     * Description
+     *      Parses every byte received so far. A complete frame with a good CRC becomes the front 
+     *      buffer, ready for stream_show.
+     * Parameters 
+     *      void
+     * Return
+     *      void
+     */
+    void stream_poll(void);
+
+    /*
+     * Description
+     *      Draws the newest complete frame into the frame buffer, sends it to the LEDs and 
+     *      acknowledges it to the PC.
+     * Parameters 
+     *      void
+     * Return
+     *      unsigned char, 1 if a frame was shown, 0 if there was no new frame
+     */
+    unsigned char stream_show(void);
+
+    /*
+     * Description
+     *      Starts a frame to the PC, in the same format as the frames from the PC. Must be followed 
+     *      by exactly length calls of stream_send_byte and then stream_send_end.
+     * Parameters 
+     *      1. unsigned char frame_type, the type
+     *      2. unsigned int frame_length, the payload length
+     * Return
+     *      void
+     */
+    void stream_send_start(unsigned char frame_type, unsigned int frame_length);
+
+    /*
+     * Description
+     *      Sends one payload byte of a frame to the PC.
+     * Parameters 
+     *      1. unsigned char byte, the byte
+     * Return
+     *      void
+     */
+    void stream_send_byte(unsigned char byte);
+
+    /*
+     * Description
+     *      Ends a frame to the PC with its CRC.
+     * Parameters 
+     *      void
+     * Return
+     *      void
+     */
+    void stream_send_end(void);
+
+    /*
+     * Description
+     *      Statistics since stream_init.
+     * Parameters 
+     *      1. stream_stats_t *stats, filled in with the statistics
+     * Return
+     *      void
+     */
+    void stream_stats(stream_stats_t *stats);
+
+#ifdef	__cplusplus
+}
+#endif /* __cplusplus */
+
+#endif	/* STREAM_H */
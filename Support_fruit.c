@@ -11,6 +11,9 @@
 
 #include "xc.h"
 #include "Assembly.h"
+#include "Support_fruit.h"
+#include "Timer.h"
+#include "Bus.h"
 
 /*
  * Description
@@ -27,7 +30,7 @@
  * Return
  *      void
  */
-void writeColor(unsigned int r, unsigned int g, unsigned int b) {
+void writeColor(unsigned char r, unsigned char g, unsigned char b) {
 
     int on, i, j, k;
 
@@ -59,16 +62,15 @@ void writeColor(unsigned int r, unsigned int g, unsigned int b) {
 
 /*
  * Description
- *      Ndelay simply repeats the assembly function delay_MS n times to achieve the 
- *      desired delay (Only works for delays that are a multiple of 1 ms).
+ *      Ndelay waits n times 100 microseconds. The wait is a deadline on the Timer2/Timer3 counter 
+ *      (Timer.h), so loop and call overhead do not add up, and the CPU idles between Timer1 ticks 
+ *      instead of spinning on delay_hund_uS. Since this is the gap between two frames of an 
+ *      animation, the sensor jobs of the bus scheduler (Bus.h) run in it when they fit.
  * Parameters 
- *      1. int n, number of milliseconds to delay
+ *      1. int n, number of 100 microsecond steps to delay
  * Return
  *      void 
  */
 void Ndelay(int n) { // Delays for 100 microseconds n times
-    int l;
-    for (l = 0; l < n; l++) {
-        delay_hund_uS();
-    }
+    bus_wait_until(deadline_in_us((unsigned long) n * 100));
 }
@@ -9,6 +9,7 @@
 #define	SUPPORT_FRUIT_H
 
 #include <xc.h> // include processor files - each processor file is guarded.  
+#include "Timer.h"
 
 #ifdef	__cplusplus
 extern "C" {
@@ -33,14 +34,30 @@ extern "C" {
     
     /*
      * Description
-     *      Ndelay simply repeats the assembly function delay_MS n times to achieve the 
-     *      desired delay (Only works for delays that are a multiple of 1 ms).
+     *      Ndelay waits n times 100 microseconds. The wait is a deadline on the Timer2/Timer3 counter 
+     *      (Timer.h), so loop and call overhead do not add up, and the CPU idles between Timer1 ticks 
+     *      instead of spinning on delay_hund_uS. Since this is the gap between two frames of an 
+     *      animation, the sensor jobs of the bus scheduler (Bus.h) run in it when they fit.
      * Parameters 
-     *      1. int n, number of milliseconds to delay
+     *      1. int n, number of 100 microsecond steps to delay
      * Return
      *      void 
      */
     void Ndelay(int n);
+    
+    // WS2812 timing in instruction cycles, same formulas as Assembly.s. When FCY changes, assemble 
+    // Assembly.s with --defsym FCY_KHZ=<FCY / 1000> so both sides agree.
+    #define WS2812_T0H_CYCLES ((FCY / 1000UL * 375UL + 500000UL) / 1000000UL)
+    #define WS2812_T1H_CYCLES ((FCY / 1000UL * 750UL + 500000UL) / 1000000UL)
+    #define WS2812_TBIT_CYCLES ((FCY / 1000UL * 1250UL + 500000UL) / 1000000UL)
+    #define WS2812_CALL_CYCLES 6    // In the low time of write_0/write_1: bclr, return, next call
+    #define WS2812_LOOP_CYCLES 7    // In the low time of write_parallel: last 'and', loop back
+    #if (WS2812_T0H_CYCLES < 2) || ((WS2812_T1H_CYCLES - WS2812_T0H_CYCLES) < 2)
+    #error "FCY is too slow to meet the WS2812 T0H/T1H times"
+    #endif
+    #if (WS2812_TBIT_CYCLES - WS2812_T1H_CYCLES) < WS2812_LOOP_CYCLES
+    #error "FCY is too slow to fit the WS2812 low time of a '1' between bits"
+    #endif
     // TODO If C++ is being used, regular C code needs function names to have C 
     // linkage so the functions can be used by the c code. 
 
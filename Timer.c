@@ -0,0 +1,137 @@
+/*
+ * File Description
+ *      Source file for the timer based delays and deadlines built on the Timer2/Timer3 32-bit counter.
+ */
+
+#include "xc.h"
+#include "Timer.h"
+#include "Power.h"
+
+#define IDLE_MARGIN (FCY / POWER_TICK_HZ) // Idle only while at least one tick is left
+
+/*
+ * Description
+ *      Starts Timer2/Timer3 as a free running 32-bit counter at FCY. Should be called once at 
+ *      start up, before any delay.
+ * Parameters 
+ *      void
+ * Return
+ *      void
+ */
+void timer_init(void)
+{
+    T2CON = 0;
+    T3CON = 0;
+    T2CONbits.T32 = 1;  // Timer2 and Timer3 form one 32-bit timer, 1:1 prescale from FCY
+    TMR3 = 0;
+    TMR2 = 0;
+    PR3 = 0xFFFF;       // Count through the full 32 bits
+    PR2 = 0xFFFF;
+    T2CONbits.TON = 1;
+}
+
+/*
+ * Description
+ *      Current value of the 32-bit counter. Reading TMR2 latches Timer3 into TMR3HLD, but an 
+ *      interrupt handler that calls timer_now between the two reads latches it again, 65536 counts 
+ *      on if TMR2 wrapped in between. So Timer3 is read first as well, and the read is taken only 
+ *      if TMR3HLD still holds that value: the high half can only have moved on since, so it was the 
+ *      right one for TMR2. Otherwise it is tried again, which needs TMR2 to wrap or an interrupt to 
+ *      land in a window of a few instructions. Safe in interrupt handlers and with interrupts held 
+ *      off, unlike holding them off here with DISI (trace calls this under its own DISI).
+ * Parameters 
+ *      void
+ * Return
+ *      unsigned long, counts of 1/FCY since timer_init (wraps around)
+ */
+unsigned long timer_now(void)
+{
+    unsigned int msw, lsw;
+
+    do {
+        msw = TMR3;
+        lsw = TMR2;
+    } while (TMR3HLD != msw);
+    return ((unsigned long) msw << 16) | lsw;
+}
+
+/*
+ * Description
+ *      Deadline a number of microseconds from now.
+ * Parameters 
+ *      1. unsigned long us, microseconds from now
+ * Return
+ *      deadline_t, the deadline
+ */
+deadline_t deadline_in_us(unsigned long us)
+{
+    return timer_now() + us * TIMER_COUNTS_PER_US;
+}
+
+/*
+ * Description
+ *      Deadline a number of milliseconds from now.
+ * Parameters 
+ *      1. unsigned long ms, milliseconds from now
+ * Return
+ *      deadline_t, the deadline
+ */
+deadline_t deadline_in_ms(unsigned long ms)
+{
+    return timer_now() + ms * TIMER_COUNTS_PER_MS;
+}
+
+/*
+ * Description
+ *      Checks a deadline without waiting, so other work can be done until it passes. The 
+ *      difference is compared as a signed number, which keeps working when the counter wraps.
+ * Parameters 
+ *      1. deadline_t deadline, deadline from deadline_in_us or deadline_in_ms
+ * Return
+ *      unsigned char, 1 if the deadline has passed, 0 if not
+ */
+unsigned char deadline_expired(deadline_t deadline)
+{
+    return (long) (timer_now() - deadline) >= 0;
+}
+
+/*
+ * Description
+ *      Waits until a deadline has passed, idling the CPU while more than one Timer1 tick is left.
+ * Parameters 
+ *      1. deadline_t deadline, deadline from deadline_in_us or deadline_in_ms
+ * Return
+ *      void
+ */
+void wait_until(deadline_t deadline)
+{
+    while ((long) (deadline - timer_now()) > (long) IDLE_MARGIN)
+        power_idle(); // Woken by the next Timer1 tick at the latest
+    while (!deadline_expired(deadline)) {}
+}
+
+/*
+ * Description
+ *      Waits a number of microseconds.
+ * Parameters 
+ *      1. unsigned long us, microseconds to wait
+ * Return
+ *      void
+ */
+void delay_us(unsigned long us)
+{
+    wait_until(deadline_in_us(us));
+}
+
+/*
+ * Description
+ *      Waits a number of milliseconds.
+ * Parameters 
+ *      1. unsigned int ms, milliseconds to wait
+ * Return
+ *      void
+ */
+void delay_ms(unsigned int ms)
+{
+    wait_until(deadline_in_ms(ms));
+}
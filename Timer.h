@@ -0,0 +1,126 @@
+/*
+ * File Description
+ *      Header file for the timer based delays and deadlines. Timer2 and Timer3 run as one free 
+ *      running 32-bit counter clocked at FCY, and every delay is a deadline on that counter.
+ * 
+ * Background
+ *      The old delays counted nops (repeat #1593 for 100 us) and were only right at 16 MIPS, and 
+ *      Ndelay added its own loop overhead on top. Here every constant is derived from FCY at compile 
+ *      time, and a delay ends when the counter passes its deadline, so call and loop overhead do not 
+ *      add up. The counter keeps running in Idle and while interrupts are masked for a frame push.
+ * 
+ *      Error bounds: delay_us and delay_ms wait at least the requested time and return within one 
+ *      pass of the final spin loop after the deadline (well under 1 us at 16 MIPS). Long waits idle 
+ *      the CPU until less than one Timer1 tick is left and spin only for the rest. Deadlines can be 
+ *      up to 2^31 counts ahead, about 134 s at 16 MIPS. The host test (tests/timer_host.c) checks 
+ *      these bounds against a simulated counter at 16 and 32 MIPS, across the wrap.
+ */
+
+#ifndef TIMER_H
+#define	TIMER_H
+
+#include <xc.h> // include processor files - each processor file is guarded.  
+
+#ifdef	__cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+    #ifndef FCY
+    #define FCY 16000000UL // Instruction clock, FOSC / 2 with RCDIV = 0 and FRCPLL
+    #endif
+
+    #if (FCY % 1000000UL) != 0
+    #error "FCY must be a whole number of MHz for the microsecond delays"
+    #endif
+
+    #define TIMER_COUNTS_PER_US (FCY / 1000000UL)
+    #define TIMER_COUNTS_PER_MS (FCY / 1000UL)
+
+    typedef unsigned long deadline_t; // Counter value at which a wait ends
+
+    /*
+     * Description
+     *      Starts Timer2/Timer3 as a free running 32-bit counter at FCY. Should be called once at 
+     *      start up, before any delay.
+     * Parameters 
+     *      void
+     * Return
+     *      void
+     */
+    void timer_init(void);
+
+    /*
+     * Description
+     *      Current value of the 32-bit counter.
+     * Parameters 
+     *      void
+     * Return
+     *      unsigned long, counts of 1/FCY since timer_init (wraps around)
+     */
+    unsigned long timer_now(void);
+
+    /*
+     * Description
+     *      Deadline a number of microseconds from now.
+     * Parameters 
+     *      1. unsigned long us, microseconds from now
+     * Return
+     *      deadline_t, the deadline
+     */
+    deadline_t deadline_in_us(unsigned long us);
+
+    /*
+     * Description
+     *      Deadline a number of milliseconds from now.
+     * Parameters 
+     *      1. unsigned long ms, milliseconds from now
+     * Return
+     *      deadline_t, the deadline
+     */
+    deadline_t deadline_in_ms(unsigned long ms);
+
+    /*
+     * Description
+     *      Checks a deadline without waiting, so other work can be done until it passes.
+     * Parameters 
+     *      1. deadline_t deadline, deadline from deadline_in_us or deadline_in_ms
+     * Return
+     *      unsigned char, 1 if the deadline has passed, 0 if not
+     */
+    unsigned char deadline_expired(deadline_t deadline);
+
+    /*
+     * Description
+     *      Waits until a deadline has passed, idling the CPU while more than one Timer1 tick is left.
+     * Parameters 
+     *      1. deadline_t deadline, deadline from deadline_in_us or deadline_in_ms
+     * Return
+     *      void
+     */
+    void wait_until(deadline_t deadline);
+
+    /*
+     * Description
+     *      Waits a number of microseconds.
+     * Parameters 
+     *      1. unsigned long us, microseconds to wait
+     * Return
+     *      void
+     */
+    void delay_us(unsigned long us);
+
+    /*
+     * Description
+     *      Waits a number of milliseconds.
+     * Parameters 
+     *      1. unsigned int ms, milliseconds to wait
+     * Return
+     *      void
+     */
+    void delay_ms(unsigned int ms);
+
+#ifdef	__cplusplus
+}
+#endif /* __cplusplus */
+
+#endif	/* TIMER_H */
@@ -0,0 +1,116 @@
+/*
+ * File Description 
+ *      Source file for the round-robin scan over several CAP1188s sharing the bus. It only talks 
+ *      to the devices through touch_device_read and touch_device_write (Touch_sensor.c), so the 
+ *      host test (tests/touch_scan_host.c) runs it against simulated devices.
+ */
+
+#include "xc.h"
+#include "Touch_sensor.h"
+#include "Timer.h"
+
+static unsigned char scan_index;           // Next device to read
+static unsigned long scan_cycle_start;     // timer_now() when device 0 was last read
+static touch_scan_stats_t scan_stats;      // Periods kept in timer counts until touch_scan_stats
+
+/*
+ * Description
+ *      Starts the round-robin scan over every CAP1188 from the next touch_scan_next and clears 
+ *      the scan statistics. Needs timer_init.
+ * Parameters 
+ *      void
+ * Return
+ *      void
+ */
+void touch_scan_start(void)
+{
+    scan_index = 0;
+    scan_stats.cycles = 0;
+    scan_stats.min_period_us = 0xFFFFFFFF;
+    scan_stats.max_period_us = 0;
+}
+
+/*
+ * Description
+ *      Reads the input status of the next CAP1188 of the scan. The slots are timed by the caller 
+ *      (the bus scheduler), every TOUCH_SCAN_SLOT_MS. Clears the INT bit of a device with touches 
+ *      so released channels clear on its next read, and adds newly touched channels to the 
+ *      device's pressed bits.
+ * Parameters 
+ *      void
+ * Return
+ *      unsigned char, index of the device that was read if its status changed (see its changed 
+ *      field), otherwise TOUCH_SCAN_NONE.
+ */
+unsigned char touch_scan_next(void)
+{
+    unsigned char zero = 0x00;
+    unsigned char index, status;
+    unsigned long now = timer_now();
+    unsigned long period;
+    touch_device_t *device;
+    
+    if (scan_index == 0) { // A new full scan starts
+        if (scan_stats.cycles != 0) {
+            period = now - scan_cycle_start;
+            if (period < scan_stats.min_period_us)
+                scan_stats.min_period_us = period;
+            if (period > scan_stats.max_period_us)
+                scan_stats.max_period_us = period;
+        }
+        scan_cycle_start = now;
+        scan_stats.cycles++;
+    }
+    
+    index = scan_index;
+    device = &touch_devices[index];
+    if (++scan_index == TOUCH_DEVICE_COUNT)
+        scan_index = 0;
+    
+    status = touch_device_read(device, TOUCH_INPUT_STATUS);
+    if (status != 0)
+        touch_device_write(device, TOUCH_MAIN_CONTROL, &zero, 1);
+    
+    device->changed = status ^ device->status;
+    device->pressed |= status & device->changed;
+    device->status = status;
+    return device->changed ? index : TOUCH_SCAN_NONE;
+}
+
+/*
+ * Description
+ *      Takes the channels of a CAP1188 that were newly touched in any scan since the last call, 
+ *      so touches seen while the caller was busy are not lost.
+ * Parameters 
+ *      1. unsigned char device, index of the device
+ * Return
+ *      unsigned char, bit n set if CSn+1 was touched
+ */
+unsigned char touch_take_pressed(unsigned char device)
+{
+    unsigned char pressed = touch_devices[device].pressed;
+    
+    touch_devices[device].pressed = 0;
+    return pressed;
+}
+
+/*
+ * Description
+ *      Statistics of the scan since touch_scan_start. The jitter of the scan period is 
+ *      max_period_us - min_period_us.
+ * Parameters 
+ *      1. touch_scan_stats_t *stats, filled in with the statistics, periods in microseconds.
+ * Return
+ *      void
+ */
+void touch_scan_stats(touch_scan_stats_t *stats)
+{
+    *stats = scan_stats;
+    if (stats->cycles < 2) { // No full period measured yet
+        stats->min_period_us = 0;
+        stats->max_period_us = 0;
+    } else {
+        stats->min_period_us /= TIMER_COUNTS_PER_US;
+        stats->max_period_us /= TIMER_COUNTS_PER_US;
+    }
+}
@@ -3,12 +3,43 @@
  *      Source file for the library that interfaces with the CAP1188 touch sensor.
  *      This includes setup, writing, and reading functions for this device. The
  *      functions in this file handle I2C communication between the CAP1188 and 
- *      PIC24.
+ *      PIC24. Every transaction goes to one device handle, so several CAP1188s can 
+ *      share the bus. The scan that reads them in turn is in Touch_scan.c.
  * 
  */
 
 #include "Touch_sensor.h"
 #include "xc.h"
+#include "Timer.h"
+#include "Trace.h"
+
+#define I2C_TIMEOUT_US 1000 // A byte takes 90 us at 100 kHz, longer means the bus is stuck
+
+// Waits while an I2C flag stays set, at most I2C_TIMEOUT_US (see i2c_waiting)
+#define I2C_WAIT_WHILE(busy) do { \
+        deadline_t wait_end = deadline_in_us(I2C_TIMEOUT_US); \
+        while ((busy) && i2c_waiting(wait_end)) {} \
+    } while (0)
+
+touch_device_t touch_devices[TOUCH_DEVICE_COUNT];
+
+static unsigned char i2c_address;          // Device of the current transaction
+static unsigned char i2c_stuck;            // A wait of the current transaction ran out of time
+
+const touch_profile_t touch_profiles[TOUCH_PROFILE_COUNT] = {
+    { // TOUCH_PROFILE_DEFAULT, 8 samples of 1.28 ms every 70 ms
+        { TOUCH_SENSITIVITY_VALUE(2, 15), 0x20, 0xFF, TOUCH_INPUT_CONFIG_VALUE(10, 4), 0x07, 
+          TOUCH_SAMPLING_VALUE(3, 2, 1) },
+        0x80,
+        { 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40 }
+    },
+    { // TOUCH_PROFILE_FAST, 1 sample of 1.28 ms every 35 ms
+        { TOUCH_SENSITIVITY_VALUE(2, 15), 0x20, 0xFF, TOUCH_INPUT_CONFIG_VALUE(10, 4), 0x07, 
+          TOUCH_SAMPLING_VALUE(0, 2, 0) },
+        0x80,
+        { 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40 }
+    }
+};
 
 /*
  * Description
@@ -23,6 +54,9 @@
  */
 void setup_touch_sensor(void)
 {
+    unsigned char linking = 0b11111111;
+    unsigned char i;
+    
     // Set up of I2C
     I2C2CONbits.I2CEN = 0; // Make sure I2C2 is off, since I2C2 is used pins 6, 7 will be SDA, SCL
     I2C2BRG = 157; // will make the I2C clock rate 100kHz from table on pg 153 of PIC24 FDS
@@ -43,57 +77,252 @@ void setup_touch_sensor(void)
     // Register 0x72 controls mapping of CAP1188 LEDs to detected touches. By default these are not 
     // connected. Writing 11111111 to this register will map all touch pins to their corresponding 
     // LED. Needs to be transmitted several times due to it not working with just one time.  
-    transmit_to_touch_sensor(0x72, 0b11111111);
-    transmit_to_touch_sensor(0x72, 0b11111111);
-    transmit_to_touch_sensor(0x72, 0b11111111);
-    transmit_to_touch_sensor(0x72, 0b11111111);
+    for (i = 0; i < TOUCH_DEVICE_COUNT; i++) {
+        touch_devices[i].address = TOUCH_ADDRESS(i);
+        touch_device_write(&touch_devices[i], TOUCH_LED_LINKING, &linking, 1);
+        touch_device_write(&touch_devices[i], TOUCH_LED_LINKING, &linking, 1);
+        touch_device_write(&touch_devices[i], TOUCH_LED_LINKING, &linking, 1);
+        touch_device_write(&touch_devices[i], TOUCH_LED_LINKING, &linking, 1);
+    }
+    
+    load_touch_profile(&touch_profiles[TOUCH_PROFILE_BOOT]);
 }
 
 /*
  * Description
- *      Will transmit a byte of data to a register in the CAP1188 through I2C.
- *      This function might need to be called several times in a row because data 
- *      does not seem to be received the first time it is transmitted due to erratic 
- *      device behavior.
+ *      Checks one wait of I2C_WAIT_WHILE. Once a wait runs out of time the bus is taken to be 
+ *      stuck, and every other wait of the transaction gives up straight away, so a transaction 
+ *      takes at most a few I2C_TIMEOUT_US. Needs timer_init.
  * Parameters 
- *      1. unsigned char, the address of the register in the CAP1188 that is being written to. 
- *      2. char, the data that is being transmitted.
+ *      1. deadline_t deadline, end of this wait.
+ * Return
+ *      unsigned char, 1 to keep waiting, 0 to give up.
+ */
+static unsigned char i2c_waiting(deadline_t deadline)
+{
+    if (i2c_stuck)
+        return 0;
+    if (deadline_expired(deadline)) {
+        i2c_stuck = 1;
+        TRACE_RECORD(TRACE_I2C_TIMEOUT, i2c_address, I2C2STAT);
+        return 0;
+    }
+    return 1;
+}
+
+/*
+ * Description
+ *      Sends a start condition for a transaction with one device.
+ * Parameters 
+ *      1. unsigned char address, 7-bit address of the device.
+ *      2. unsigned char reg, first register of the transaction, for the trace.
  * Return
  *      void
  */
-void transmit_to_touch_sensor(unsigned char address, char data)
+static void i2c_start(unsigned char address, unsigned char reg)
 {
-    // I2C write sequence
+    i2c_address = address;
+    i2c_stuck = 0;
     I2C2CONbits.SEN = 1; // Send start condition
-    while (I2C2CONbits.SEN) {} // Wait for start to clear signaling it has been sent
+    I2C_WAIT_WHILE(I2C2CONbits.SEN); // Wait for start to clear signaling it has been sent
+    IFS3bits.MI2C2IF = 0; // Clear interrupt flag
+    TRACE_RECORD(TRACE_I2C_START, address, reg);
+}
+
+/*
+ * Description
+ *      Sends one byte that is already started on the bus and waits for it to go out.
+ * Parameters 
+ *      1. unsigned char byte, the byte to send.
+ * Return
+ *      unsigned char, 1 if the device acknowledged it, 0 if not or if the bus is stuck.
+ */
+static unsigned char i2c_send(unsigned char byte)
+{
+    if (i2c_stuck)
+        return 0;
+    I2C2TRN = byte;
+    I2C_WAIT_WHILE(IFS3bits.MI2C2IF == 0); // Wait for interrupt 
+    I2C_WAIT_WHILE(I2C2STATbits.TBF); // Wait for transmission to end
     IFS3bits.MI2C2IF = 0; // Clear interrupt flag
+    return !i2c_stuck && !I2C2STATbits.ACKSTAT;
+}
+
+/*
+ * Description
+ *      Sends a stop condition and waits for it to finish. If the bus got stuck during the 
+ *      transaction the I2C module is switched off and on again, which resets it.
+ * Parameters 
+ *      void
+ * Return
+ *      void
+ */
+static void i2c_stop(void)
+{
+    I2C2CONbits.PEN = 1; // Send stop 
+    I2C_WAIT_WHILE(I2C2CONbits.PEN); // Wait for stop bit to clear signaling transmission 
+    IFS3bits.MI2C2IF = 0; // Clear interrupt flag
+    if (i2c_stuck) {
+        I2C2CONbits.I2CEN = 0;
+        I2C2CONbits.I2CEN = 1;
+    }
+}
+
+/*
+ * Description
+ *      Will transmit bytes of data to consecutive registers of one CAP1188 in one I2C transaction, 
+ *      the CAP1188 moves to the next register after each byte. If the device does not acknowledge 
+ *      its address, or the bus gets stuck, the transaction is stopped and the device is marked 
+ *      missing.
+ * Parameters 
+ *      1. touch_device_t *device, the device.
+ *      2. unsigned char reg, the first register written to.
+ *      3. const unsigned char *data, the data that is being transmitted.
+ *      4. unsigned char count, the number of bytes.
+ * Return
+ *      unsigned char, 1 if the device answered, 0 if not.
+ */
+unsigned char touch_device_write(touch_device_t *device, unsigned char reg, const unsigned char *data, unsigned char count)
+{
+    // I2C write sequence
+    i2c_start(device->address, reg);
     
-    I2C2TRN = 0b01010000; // Slave address of CAP1188 because ADDR_COMM pin is tied to VDD, 
-                          // last bit is 0 to write 
-    while (IFS3bits.MI2C2IF == 0) {} // Wait for interrupt  
-    while (I2C2STATbits.TBF) {} // Wait for transmission to end 
-    IFS3bits.MI2C2IF = 0; // Clear interrupt flag  
+    device->present = i2c_send(device->address << 1); // Last bit is 0 to write
+    if (device->present) {
+        i2c_send(reg); // Register address on the CAP1188 to change 
+        while (count--)
+            i2c_send(*data++); // Data to be written to the next register on the CAP1188 
+        device->stale = 1; // The next read after a write returns invalid data
+    } else {
+        TRACE_RECORD(TRACE_I2C_NACK, device->address, 0);
+    }
     
-    I2C2TRN = address; // Register address on the CAP1188 to change 
-    while (IFS3bits.MI2C2IF == 0) {} // Wait for interrupt 
-    while (I2C2STATbits.TBF) {} // Wait for transmission to end
-    IFS3bits.MI2C2IF = 0; // Clear interrupt flag
+    i2c_stop();
+    if (i2c_stuck)
+        device->present = 0;
+    return device->present;
+}
+
+/*
+ * Description
+ *      Will read a byte of data from a register of one CAP1188 through I2C. The first read after 
+ *      a write returns invalid data, so in that case the register is read twice. 
+ * Parameters 
+ *      1. touch_device_t *device, the device.
+ *      2. unsigned char reg, the register to get data from.
+ * Return
+ *      unsigned char, the data received, 0 if the device did not answer.
+ */
+unsigned char touch_device_read(touch_device_t *device, unsigned char reg)
+{
+    unsigned char temp = 0; // Temp variable to read to value of the receive register from 
     
-    I2C2TRN = data; // Data to be written to the address on the CAP1188 
-    while (IFS3bits.MI2C2IF == 0) {} // Wait for interrupt 
-    while (I2C2STATbits.TBF) {} // Wait for transmission to end
-    IFS3bits.MI2C2IF = 0; // Clear interrupt flag
+    touch_device_read_block(device, reg, &temp, 1);
+    return temp; // Return the data from the CAP1188 
+}
+
+/*
+ * Description
+ *      Will read consecutive registers of one CAP1188 in one I2C transaction. Every byte but the 
+ *      last is acknowledged so the CAP1188 carries on with the next register, which makes a burst 
+ *      of 8 registers take about as long as two single reads. The first read after a write returns 
+ *      invalid data, so in that case the transaction is done twice. 
+ * Parameters 
+ *      1. touch_device_t *device, the device.
+ *      2. unsigned char reg, the first register to get data from.
+ *      3. unsigned char *data, filled in with the data received.
+ *      4. unsigned char count, the number of registers, at least 1.
+ * Return
+ *      unsigned char, 1 if the device answered, 0 if not (data is left unchanged) or if the bus got 
+ *      stuck (data may be partly filled in).
+ */
+unsigned char touch_device_read_block(touch_device_t *device, unsigned char reg, unsigned char *data, unsigned char count)
+{
+    unsigned char reads = device->stale ? 2 : 1;
+    unsigned char i;
     
-    I2C2CONbits.PEN = 1; // Send stop 
-    while (I2C2CONbits.PEN) {} // Wait for stop bit to clear signaling transmission 
-    IFS3bits.MI2C2IF = 0; // Clear interrupt flag
+    device->stale = 0;
+    while (reads--) {
+        // I2C read sequence 
+        i2c_start(device->address, reg);
+        
+        device->present = i2c_send(device->address << 1); // Last bit is 0 to write the register first
+        if (!device->present) {
+            TRACE_RECORD(TRACE_I2C_NACK, device->address, 0);
+            i2c_stop();
+            return 0;
+        }
+        i2c_send(reg); // Register address on the CAP1188 to read from
+        
+        I2C2CONbits.RSEN = 1; // Repeat start condition for read sequence 
+        I2C_WAIT_WHILE(I2C2CONbits.RSEN); // Wait for repeat start to clear signaling it has been sent 
+        IFS3bits.MI2C2IF = 0; // Clear interrupt flag
+        
+        i2c_send((device->address << 1) | 1); // Last bit is 1 to read
+        
+        for (i = 0; i < count; i++) {
+            I2C2CONbits.RCEN = 1; // Enable data reception 
+            I2C_WAIT_WHILE(I2C2CONbits.RCEN); // Wait for data reception to clear signaling data received
+            I2C_WAIT_WHILE(!I2C2STATbits.RBF); // Wait till the data received buffer is full
+            IFS3bits.MI2C2IF = 0; // Clear interrupt flag
+            data[i] = I2C2RCV; // Read data from CAP1188 out of the receive buffer
+            
+            I2C2CONbits.ACKDT = (i == count - 1); // ACK to get the next register, NACK after the last
+            I2C2CONbits.ACKEN = 1; // Transmit the ACK or NACK
+            I2C_WAIT_WHILE(I2C2CONbits.ACKEN); // Wait for it to transmit 
+            IFS3bits.MI2C2IF = 0; // Clear interrupt flag
+        }
+        
+        i2c_stop();
+        if (i2c_stuck) {
+            device->present = 0;
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/*
+ * Description
+ *      Will transmit a byte of data to a register in the first CAP1188 (touch_devices[0]) 
+ *      through I2C. This function might need to be called several times in a row because data 
+ *      does not seem to be received the first time it is transmitted due to erratic 
+ *      device behavior.
+ * Parameters 
+ *      1. unsigned char, the address of the register in the CAP1188 that is being written to. 
+ *      2. char, the data that is being transmitted.
+ * Return
+ *      void
+ */
+void transmit_to_touch_sensor(unsigned char address, char data)
+{
+    unsigned char byte = data;
+    
+    touch_device_write(&touch_devices[0], address, &byte, 1);
+}
+
+/*
+ * Description
+ *      Will transmit several bytes of data to consecutive registers in the first CAP1188 
+ *      (touch_devices[0]) in one I2C transaction, the CAP1188 moves to the next register after 
+ *      each byte. 
+ * Parameters 
+ *      1. unsigned char address, the first register written to. 
+ *      2. const unsigned char *data, the data that is being transmitted.
+ *      3. unsigned char count, the number of bytes.
+ * Return
+ *      void
+ */
+void transmit_block_to_touch_sensor(unsigned char address, const unsigned char *data, unsigned char count)
+{
+    touch_device_write(&touch_devices[0], address, data, count);
 }
 
 /*
  * Description
- *      Will read a byte of data from a register in the CAP1188 through I2C. This 
- *      function needs to be called twice if a write just occurred because the first
- *      read will return invalid data. Due to the lack of reliability in reading data 
+ *      Will read a byte of data from a register in the first CAP1188 (touch_devices[0]) 
+ *      through I2C. The first read after a write returns invalid data, so it is repeated 
+ *      by touch_device_read. Due to the lack of reliability in reading data 
  *      taken from detectable pin touches, the LED pins changing voltage on the 
  *      CAP1188 were used to take touch data. 
  * Parameters 
@@ -103,46 +332,73 @@ void transmit_to_touch_sensor(unsigned char address, char data)
  */
 unsigned char read_from_touch_sensor(unsigned char address)
 {
-    
-    unsigned char temp = 0; // Temp variable to read to value of the receive register from 
-    
-    // I2C read sequence 
-    I2C2CONbits.SEN = 1; // Send start condition
-    while (I2C2CONbits.SEN) {} // Wait for start to clear signaling it has been sent
-    IFS3bits.MI2C2IF = 0; // Clear interrupt flag
-    
-    I2C2TRN = 0b01010000; // Slave address of CAP1188 because ADDR_COMM pin is tied to VDD, 
-                          // last bit is 0 to write because is sent first then read 
-    while (IFS3bits.MI2C2IF == 0) {} // Wait for interrupt 
-    IFS3bits.MI2C2IF = 0; // Clear interrupt flag
-
-    I2C2TRN = address; // Register address on the CAP1188 to read from
-    while (IFS3bits.MI2C2IF == 0) {} // Wait for interrupt 
-    IFS3bits.MI2C2IF = 0; // Clear interrupt flag
+    return touch_device_read(&touch_devices[0], address);
+}
 
-    I2C2CONbits.RSEN = 1; // Repeat start condition for read sequence 
-    while (I2C2CONbits.RSEN) {} // Wait for repeat start to clear signaling it has been sent 
-    IFS3bits.MI2C2IF = 0; // Clear interrupt flag
+/*
+ * Description
+ *      Loads all the registers of a touch profile into every CAP1188 with three block writes each. 
+ * Parameters 
+ *      1. const touch_profile_t *profile, the profile, usually one of touch_profiles.
+ * Return
+ *      void
+ */
+void load_touch_profile(const touch_profile_t *profile)
+{
+    unsigned char i;
     
-    I2C2TRN = 0b01010001; // Slave address of CAP1188 because ADDR_COMM pin is tied to VDD, 
-                          // last bit is 1 to read
-    while (IFS3bits.MI2C2IF == 0) {} // Wait for interrupt 
-    IFS3bits.MI2C2IF = 0; // Clear interrupt flag
+    for (i = 0; i < TOUCH_DEVICE_COUNT; i++) {
+        touch_device_write(&touch_devices[i], TOUCH_SENSITIVITY, profile->control, TOUCH_CONTROL_COUNT);
+        touch_device_write(&touch_devices[i], TOUCH_MULTIPLE_TOUCH, &profile->multiple_touch, 1);
+        touch_device_write(&touch_devices[i], TOUCH_THRESHOLD, profile->threshold, TOUCH_CHANNELS);
+    }
+}
+
+/*
+ * Description
+ *      Latency measurement mode. Waits for the channel to be released, then raises the test pad 
+ *      pin (TOUCH_STIMULUS_LAT) and measures the time from that edge to the bit being set in the 
+ *      status register, which is the whole delay the sampling, averaging and cycle time add. The 
+ *      edge falls at a random point of the CAP1188 cycle, so the result of one touch lies anywhere 
+ *      between the averaging time and that plus a cycle; average several. The status is polled, 
+ *      which adds up to one read (about 300 us). The pin is lowered again before returning. 
+ *      Blocks, so it is only meant for tuning on the bench.
+ * Parameters 
+ *      1. unsigned char channel, the channel the test pad is on (0 to 7).
+ *      2. unsigned int timeout_ms, how long to wait for the release and again for the touch.
+ * Return
+ *      unsigned long, latency in microseconds, 0 if the channel did not release or the test pad 
+ *      did not register before the timeout.
+ */
+unsigned long touch_measure_latency(unsigned char channel, unsigned int timeout_ms)
+{
+    unsigned char bit = 1 << channel;
+    deadline_t deadline = deadline_in_ms(timeout_ms);
+    unsigned long pressed, us = 0;
     
-    I2C2CONbits.RCEN = 1; // Enable data reception 
-    while (I2C2CONbits.RCEN) {} // Wait for data reception to clear signaling data received
-    while (!I2C2STATbits.RBF) {} // Wait till the data received buffer is full
-    IFS3bits.MI2C2IF = 0; // Clear interrupt flag
+    TOUCH_STIMULUS_LAT = 0;
+    TOUCH_STIMULUS_TRIS = 0;
     
-    I2C2CONbits.ACKDT = 1; // Setting to transmit a NACK to CAP1188 to signal PIC24 received data
-    I2C2CONbits.ACKEN = 1; // Transmit the NACK
-    while (I2C2CONbits.ACKEN) {} // Wait for NACK to transmit 
-    IFS3bits.MI2C2IF = 0; // Clear interrupt flag
+    // Wait for the channel to be released, the status bits stay set until INT is cleared
+    do {
+        transmit_to_touch_sensor(TOUCH_MAIN_CONTROL, 0x00);
+        if (deadline_expired(deadline))
+            return 0;
+    } while (read_from_touch_sensor(TOUCH_INPUT_STATUS) & bit);
     
-    I2C2CONbits.PEN = 1; // Send stop 
-    while (I2C2CONbits.PEN) {} // Wait for stop bit to clear signaling transmission 
-    IFS3bits.MI2C2IF = 0; // Clear interrupt flag
+    // The touch starts at the edge on the test pad
+    deadline = deadline_in_ms(timeout_ms);
+    TOUCH_STIMULUS_LAT = 1;
+    pressed = timer_now();
     
-    temp =  I2C2RCV; // Read data from CAP1188 out of the receive buffer
-    return temp; // Return the data from the CAP1188 
+    // and is reported when the status bit is set. The time is taken when the bit is seen, since 
+    // the deadline can pass while the read that saw it is still going.
+    do {
+        if (read_from_touch_sensor(TOUCH_INPUT_STATUS) & bit) {
+            us = (timer_now() - pressed) / TIMER_COUNTS_PER_US;
+            break;
+        }
+    } while (!deadline_expired(deadline));
+    TOUCH_STIMULUS_LAT = 0;
+    return us;
 }
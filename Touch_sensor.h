@@ -6,6 +6,19 @@
  * 
  * File Description 
  *      Header file for library that interfaces with the CAP1188 Touch Sensor.
+ * 
+ * Background
+ *      How fast the CAP1188 reports a touch is set by its sampling registers. Each channel is 
+ *      measured AVG times for SAMP_TIME each, and a new round of all channels starts every 
+ *      CYCLE_TIME (register 0x24). With the power-up values (8 samples of 1.28 ms, 70 ms cycle) 
+ *      a touch takes up to about 80 ms to show up in the status register. A touch profile holds 
+ *      every register that affects this, so a whole set can be loaded in three block writes and 
+ *      profiles can be compared with touch_measure_latency, timed from a pin driving a test pad.
+ * 
+ *      Up to five CAP1188s can share the bus, each with its own ADDR_COMM resistor (VDD for 0x28, 
+ *      then 150k, 120k, 100k and 82k for 0x29 to 0x2C). Each one is a touch_device_t, and the scan 
+ *      reads their status registers in turn so every device is read once per TOUCH_SCAN_PERIOD_MS 
+ *      however many there are. The old single-device functions talk to touch_devices[0].
  */
 
 #ifndef TOUCH_SENSOR_H
@@ -14,6 +27,83 @@
 #ifdef	__cplusplus
 extern "C" {
 #endif
+
+#define TOUCH_CHANNELS 8 // CS1 to CS8
+
+#ifndef TOUCH_DEVICE_COUNT
+#define TOUCH_DEVICE_COUNT 1 // CAP1188s on the bus, 1 to 5
+#endif
+#define TOUCH_ADDRESS(n) (0x28 + (n)) // 7-bit I2C address of device n
+
+#ifndef TOUCH_SCAN_PERIOD_MS
+#define TOUCH_SCAN_PERIOD_MS 20 // Every device is read once per period
+#endif
+#define TOUCH_SCAN_SLOT_MS (TOUCH_SCAN_PERIOD_MS / TOUCH_DEVICE_COUNT) // Time between two reads
+#define TOUCH_SCAN_NONE 0xFF
+
+#if TOUCH_DEVICE_COUNT < 1 || TOUCH_DEVICE_COUNT > 5
+#error "TOUCH_DEVICE_COUNT must be 1 to 5"
+#endif
+#if TOUCH_SCAN_SLOT_MS < 1
+#error "TOUCH_SCAN_PERIOD_MS is too short for TOUCH_DEVICE_COUNT"
+#endif
+
+// CAP1188 registers
+#define TOUCH_MAIN_CONTROL 0x00     // Bit 0 (INT) has to be cleared to clear the status bits
+#define TOUCH_INPUT_STATUS 0x03     // Bit n set while CSn+1 is touched
+#define TOUCH_DELTA_COUNT 0x10      // 0x10 to 0x17, signed delta count of each channel
+#define TOUCH_SENSITIVITY 0x1F      // First register of touch_profile_t.control
+#define TOUCH_MULTIPLE_TOUCH 0x2A
+#define TOUCH_THRESHOLD 0x30        // 0x30 to 0x37, delta count at which each channel is touched
+#define TOUCH_LED_LINKING 0x72
+
+// Test pad of touch_measure_latency: driving this pin high has to register as a touch, for 
+// example through a MOSFET that switches a grounded pad onto the channel's electrode
+#define TOUCH_STIMULUS_TRIS TRISBbits.TRISB4 // Pin 11
+#define TOUCH_STIMULUS_LAT LATBbits.LATB4
+
+#define TOUCH_CONTROL_COUNT 6       // Registers 0x1F to 0x24 written in one block
+
+// Register values, see the CAP1188 datasheet section 5
+#define TOUCH_SENSITIVITY_VALUE(delta, base) (((delta) << 4) | (base))      // 0x1F, delta 0 = 128x to 7 = 1x
+#define TOUCH_INPUT_CONFIG_VALUE(max_dur, rpt) (((max_dur) << 4) | (rpt))   // 0x22, rpt n = 35 ms * (n + 1)
+#define TOUCH_SAMPLING_VALUE(avg, samp, cycle) (((avg) << 4) | ((samp) << 2) | (cycle)) // 0x24
+
+#define TOUCH_PROFILE_DEFAULT 0     // CAP1188 power-up values
+#define TOUCH_PROFILE_FAST 1        // One sample per channel and a 35 ms cycle
+#define TOUCH_PROFILE_COUNT 2
+
+#ifndef TOUCH_PROFILE_BOOT
+#define TOUCH_PROFILE_BOOT TOUCH_PROFILE_FAST // Profile loaded by setup_touch_sensor
+#endif
+
+typedef struct {
+    // 0x1F sensitivity, 0x20 configuration, 0x21 input enable, 0x22 input configuration 
+    // (max duration and repeat rate), 0x23 input configuration 2 (press and hold time), 
+    // 0x24 averaging and sampling
+    unsigned char control[TOUCH_CONTROL_COUNT];
+    unsigned char multiple_touch;               // 0x2A
+    unsigned char threshold[TOUCH_CHANNELS];    // 0x30 to 0x37
+} touch_profile_t;
+
+extern const touch_profile_t touch_profiles[TOUCH_PROFILE_COUNT];
+
+typedef struct {
+    unsigned char address;  // 7-bit I2C address
+    unsigned char present;  // 1 if the device acknowledged the last transaction
+    unsigned char stale;    // Set by a write, the next read has to be done twice
+    unsigned char status;   // Input status (0x03) from the last scan, bit n = CSn+1
+    unsigned char changed;  // Status bits that changed in the last scan
+    unsigned char pressed;  // Status bits newly set since touch_take_pressed
+} touch_device_t;
+
+typedef struct {
+    unsigned long cycles;        // Full scans of all devices started
+    unsigned long min_period_us; // Shortest time between the starts of two full scans
+    unsigned long max_period_us; // Longest time between the starts of two full scans
+} touch_scan_stats_t;
+
+extern touch_device_t touch_devices[TOUCH_DEVICE_COUNT];
     
 /*
  * Description
@@ -30,8 +120,8 @@ void setup_touch_sensor(void);
 
 /*
  * Description
- *      Will transmit a byte of data to a register in the CAP1188 through I2C.
- *      This function might need to be called several times in a row because data 
+ *      Will transmit a byte of data to a register in the first CAP1188 (touch_devices[0]) 
+ *      through I2C. This function might need to be called several times in a row because data 
  *      does not seem to be received the first time it is transmitted due to erratic 
  *      device behavior.
  * Parameters 
@@ -44,9 +134,9 @@ void transmit_to_touch_sensor(unsigned char address, char data);
 
 /*
  * Description
- *      Will read a byte of data from a register in the CAP1188 through I2C. This 
- *      function needs to be called twice if a write just occurred because the first
- *      read will return invalid data. Due to the lack of reliability in reading data 
+ *      Will read a byte of data from a register in the first CAP1188 (touch_devices[0]) 
+ *      through I2C. The first read after a write returns invalid data, so it is repeated 
+ *      by touch_device_read. Due to the lack of reliability in reading data 
  *      taken from detectable pin touches, the LED pins changing voltage on the 
  *      CAP1188 were used to take touch data. 
  * Parameters 
@@ -56,6 +146,137 @@ void transmit_to_touch_sensor(unsigned char address, char data);
  */
 unsigned char read_from_touch_sensor(unsigned char address);
 
+/*
+ * Description
+ *      Will transmit several bytes of data to consecutive registers in the first CAP1188 
+ *      (touch_devices[0]) in one I2C transaction, the CAP1188 moves to the next register after 
+ *      each byte. 
+ * Parameters 
+ *      1. unsigned char address, the first register written to. 
+ *      2. const unsigned char *data, the data that is being transmitted.
+ *      3. unsigned char count, the number of bytes.
+ * Return
+ *      void
+ */
+void transmit_block_to_touch_sensor(unsigned char address, const unsigned char *data, unsigned char count);
+
+/*
+ * Description
+ *      Loads all the registers of a touch profile into every CAP1188 with three block writes each. 
+ * Parameters 
+ *      1. const touch_profile_t *profile, the profile, usually one of touch_profiles.
+ * Return
+ *      void
+ */
+void load_touch_profile(const touch_profile_t *profile);
+
+/*
+ * Description
+ *      Latency measurement mode. Waits for the channel to be released, then raises the test pad 
+ *      pin (TOUCH_STIMULUS_LAT) and measures the time from that edge to the bit being set in the 
+ *      status register, which is the whole delay the sampling, averaging and cycle time add. The 
+ *      edge falls at a random point of the CAP1188 cycle, so the result of one touch lies anywhere 
+ *      between the averaging time and that plus a cycle; average several. The status is polled, 
+ *      which adds up to one read (about 300 us). The pin is lowered again before returning. 
+ *      Blocks, so it is only meant for tuning on the bench.
+ * Parameters 
+ *      1. unsigned char channel, the channel the test pad is on (0 to 7).
+ *      2. unsigned int timeout_ms, how long to wait for the release and again for the touch.
+ * Return
+ *      unsigned long, latency in microseconds, 0 if the channel did not release or the test pad 
+ *      did not register before the timeout.
+ */
+unsigned long touch_measure_latency(unsigned char channel, unsigned int timeout_ms);
+
+/*
+ * Description
+ *      Will transmit bytes of data to consecutive registers of one CAP1188 in one I2C transaction, 
+ *      the CAP1188 moves to the next register after each byte. If the device does not acknowledge 
+ *      its address the transaction is stopped and the device is marked missing.
+ * Parameters 
+ *      1. touch_device_t *device, the device.
+ *      2. unsigned char reg, the first register written to.
+ *      3. const unsigned char *data, the data that is being transmitted.
+ *      4. unsigned char count, the number of bytes.
+ * Return
+ *      unsigned char, 1 if the device answered, 0 if not.
+ */
+unsigned char touch_device_write(touch_device_t *device, unsigned char reg, const unsigned char *data, unsigned char count);
+
+/*
+ * Description
+ *      Will read a byte of data from a register of one CAP1188 through I2C. The first read after 
+ *      a write returns invalid data, so in that case the register is read twice. 
+ * Parameters 
+ *      1. touch_device_t *device, the device.
+ *      2. unsigned char reg, the register to get data from.
+ * Return
+ *      unsigned char, the data received, 0 if the device did not answer.
+ */
+unsigned char touch_device_read(touch_device_t *device, unsigned char reg);
+
+/*
+ * Description
+ *      Will read consecutive registers of one CAP1188 in one I2C transaction, the CAP1188 moves to 
+ *      the next register after each byte. Reading the 8 delta counts this way takes about 1 ms at 
+ *      100 kHz. The first read after a write returns invalid data, so in that case the 
+ *      transaction is done twice. 
+ * Parameters 
+ *      1. touch_device_t *device, the device.
+ *      2. unsigned char reg, the first register to get data from.
+ *      3. unsigned char *data, filled in with the data received.
+ *      4. unsigned char count, the number of registers, at least 1.
+ * Return
+ *      unsigned char, 1 if the device answered, 0 if not (data is left unchanged).
+ */
+unsigned char touch_device_read_block(touch_device_t *device, unsigned char reg, unsigned char *data, unsigned char count);
+
+/*
+ * Description
+ *      Starts the round-robin scan over every CAP1188 from the next touch_scan_next and clears 
+ *      the scan statistics. Needs timer_init.
+ * Parameters 
+ *      void
+ * Return
+ *      void
+ */
+void touch_scan_start(void);
+
+/*
+ * Description
+ *      Reads the input status of the next CAP1188 of the scan (Touch_scan.c). The slots are timed 
+ *      by the caller (the bus scheduler), every TOUCH_SCAN_SLOT_MS, so every device is read once 
+ *      per TOUCH_SCAN_PERIOD_MS.
+ * Parameters 
+ *      void
+ * Return
+ *      unsigned char, index of the device that was read if its status changed (see its changed 
+ *      field), otherwise TOUCH_SCAN_NONE.
+ */
+unsigned char touch_scan_next(void);
+
+/*
+ * Description
+ *      Takes the channels of a CAP1188 that were newly touched in any scan since the last call, 
+ *      so touches seen while the caller was busy are not lost.
+ * Parameters 
+ *      1. unsigned char device, index of the device
+ * Return
+ *      unsigned char, bit n set if CSn+1 was touched
+ */
+unsigned char touch_take_pressed(unsigned char device);
+
+/*
+ * Description
+ *      Statistics of the scan since touch_scan_start. The jitter of the scan period is 
+ *      max_period_us - min_period_us.
+ * Parameters 
+ *      1. touch_scan_stats_t *stats, filled in with the statistics, periods in microseconds.
+ * Return
+ *      void
+ */
+void touch_scan_stats(touch_scan_stats_t *stats);
+
 #ifdef	__cplusplus
 }
 #endif
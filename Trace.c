@@ -0,0 +1,82 @@
+/*
+ * File Description
+ *      Source file for the trace ring.
+ */
+
+#include "xc.h"
+#include "Trace.h"
+#include "Stream.h"
+#include "Timer.h"
+
+#ifdef TRACE
+
+#define TRACE_MASK (TRACE_SIZE - 1)
+
+static trace_record_t ring[TRACE_SIZE];
+static unsigned long count;         // Records written since the ring was last emptied
+static volatile unsigned char paused;
+
+/*
+ * Description
+ *      Writes a record over the oldest one. Used through TRACE_RECORD, so that nothing is left 
+ *      of it without TRACE. Can be called from interrupt handlers and the main loop.
+ * Parameters 
+ *      1. unsigned char type, one of the TRACE_ types
+ *      2. unsigned char arg, argument for the type
+ *      3. unsigned int data, data for the type
+ * Return
+ *      void
+ */
+void trace(unsigned char type, unsigned char arg, unsigned int data)
+{
+    trace_record_t *record;
+
+    if (paused)
+        return;
+    __builtin_disi(0x3FFF); // Hold off interrupts until DISICNT is cleared
+    record = &ring[(unsigned char) count & TRACE_MASK];
+    count++;
+    record->time = timer_now();
+    record->type = type;
+    record->arg = arg;
+    record->data = data;
+    DISICNT = 0;
+}
+
+/*
+ * Description
+ *      Sends the ring to the PC, oldest record first. Nothing is recorded while it is sent.
+ * Parameters 
+ *      1. unsigned char clear, 1 to empty the ring afterwards
+ * Return
+ *      unsigned char, 1
+ */
+unsigned char trace_dump(unsigned char clear)
+{
+    unsigned int kept, i;
+    unsigned char b;
+    const unsigned char *p;
+
+    paused = 1;
+    kept = count < TRACE_SIZE ? count : TRACE_SIZE;
+
+    stream_send_start(STREAM_TYPE_TRACE, 7 + kept * sizeof(trace_record_t));
+    for (b = 0; b < 4; b++)
+        stream_send_byte(count >> (8 * b));
+    stream_send_byte(TRACE_SIZE & 0xFF);
+    stream_send_byte(TRACE_SIZE >> 8);
+    stream_send_byte(TIMER_COUNTS_PER_US);
+    for (i = 0; i < kept; i++) {
+        p = (const unsigned char *) &ring[(unsigned char) (count - kept + i) & TRACE_MASK];
+        for (b = 0; b < sizeof(trace_record_t); b++)
+            stream_send_byte(p[b]); // The PIC24 is little endian like the payload
+    }
+    stream_send_end();
+
+    if (clear)
+        count = 0;
+    paused = 0;
+    return 1;
+}
+
+#endif
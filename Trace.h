@@ -0,0 +1,95 @@
+/*
+ * File Description
+ *      Header file for the trace ring, a record of what the board did lately that can be read 
+ *      back over UART when something went wrong.
+ * 
+ * Background
+ *      Every record is 8 bytes: the timer_now() time, a type, a one byte argument and a two byte 
+ *      data field. The ring keeps the last TRACE_SIZE records and overwrites the oldest, and count 
+ *      tells how many were written in all, so the reader knows how many were lost. Records come 
+ *      from the interrupt handlers and from the main loop, so the slot is taken with interrupts 
+ *      held off by DISI for the few instructions it takes to fill it; a record costs about 40 
+ *      cycles (2.5 us). 
+ * 
+ *      Only built with TRACE defined, and then together with UART_STREAM. Without it the TRACE 
+ *      macro is empty and the ring takes no RAM. The PC asks for the ring with a STREAM_TYPE_TRACE 
+ *      frame and gets back a frame of the same type (tools/trace_report.py turns it into a 
+ *      timeline), with the payload, little endian,
+ * 
+ *      count (4 bytes) | TRACE_SIZE (2 bytes) | TIMER_COUNTS_PER_US (1 byte) | the records, oldest 
+ *      first: time (4 bytes) | type | arg | data (2 bytes)
+ */
+
+#ifndef TRACE_H
+#define	TRACE_H
+
+#include <xc.h> // include processor files - each processor file is guarded.  
+
+#ifdef	__cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+    #if defined(TRACE) && !defined(UART_STREAM)
+    #error "TRACE sends the ring over UART_STREAM"
+    #endif
+
+    #define TRACE_SIZE 64   // Records kept, a power of two no larger than 256 (8 bytes each)
+
+    #if (TRACE_SIZE & (TRACE_SIZE - 1)) != 0 || TRACE_SIZE > 256
+    #error "TRACE_SIZE must be a power of two no larger than 256"
+    #endif
+
+    // Record types
+    #define TRACE_TOUCH_DOWN 1  // arg = touch channel
+    #define TRACE_TOUCH_UP 2    // arg = touch channel
+    #define TRACE_ANIM_START 3  // arg = fruit, data = intended time per frame in ms
+    #define TRACE_ANIM_STOP 4   // arg = fruit
+    #define TRACE_FRAME 5       // data = pixels sent by frame_show
+    #define TRACE_I2C_START 6   // arg = 7-bit device address, data = first register
+    #define TRACE_I2C_NACK 7    // arg = 7-bit device address
+    #define TRACE_I2C_TIMEOUT 8 // arg = 7-bit device address, data = I2C2STAT when it gave up
+    #define TRACE_GESTURE 9     // arg = gesture type, data = channel
+
+    #define STREAM_TYPE_TRACE 0x21  // payload: 1 to empty the ring after sending it, else 0
+
+    #ifdef TRACE
+    #define TRACE_RECORD(type, arg, data) trace(type, arg, data)
+    #else
+    #define TRACE_RECORD(type, arg, data) ((void) 0)
+    #endif
+
+    typedef struct {
+        unsigned long time;     // timer_now() when the record was written
+        unsigned char type;     // One of the TRACE_ types above
+        unsigned char arg;      // Depends on the type
+        unsigned int data;      // Depends on the type
+    } trace_record_t;
+
+    /*
+     * Description
+     *      Writes a record over the oldest one. Used through TRACE_RECORD, so that nothing is left 
+     *      of it without TRACE. Can be called from interrupt handlers and the main loop.
+     * Parameters 
+     *      1. unsigned char type, one of the TRACE_ types
+     *      2. unsigned char arg, argument for the type
+     *      3. unsigned int data, data for the type
+     * Return
+     *      void
+     */
+    void trace(unsigned char type, unsigned char arg, unsigned int data);
+
+    /*
+     * Description
+     *      Sends the ring to the PC, oldest record first. Nothing is recorded while it is sent.
+     * Parameters 
+     *      1. unsigned char clear, 1 to empty the ring afterwards
+     * Return
+     *      unsigned char, 1
+     */
+    unsigned char trace_dump(unsigned char clear);
+
+#ifdef	__cplusplus
+}
+#endif /* __cplusplus */
+
+#endif	/* TRACE_H */
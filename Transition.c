@@ -0,0 +1,100 @@
+/*
+ * File Description
+ *      Source file for the transitions between animations.
+ */
+
+#include "xc.h"
+#include "Transition.h"
+#include "Frame_buffer.h"
+#include "Timer.h"
+#include "Bus.h"
+
+#define DISSOLVE_TAPS 0x30 // x^6 + x^5 + 1, shifting right
+
+static unsigned char next_kind = TRANSITION_NONE;
+static unsigned char next_frames;
+static transition_stats_t totals;
+
+/*
+ * Description
+ *      Plays a transition into the next frame that is drawn. The frame is drawn into the back
+ *      buffer, and the transition runs when it is sent with frame_show.
+ * Parameters 
+ *      1. unsigned char kind, one of the TRANSITION_ kinds
+ *      2. unsigned char frames, steps from the old frame to the new one
+ * Return
+ *      void
+ */
+void transition_next(unsigned char kind, unsigned char frames)
+{
+    next_kind = kind;
+    next_frames = frames;
+    frame_draw_back();
+}
+
+/*
+ * Description
+ *      Moves the shown frame to the back buffer with the transition set by transition_next,
+ *      sending every step. Called by frame_show.
+ * Parameters 
+ *      void
+ * Return
+ *      void
+ */
+void transition_run(void)
+{
+    deadline_t deadline = timer_now();
+    unsigned char kind = next_kind, frames = next_frames;
+    unsigned char step, y;
+    unsigned char done = 0;     // Columns (wipe) or pixels (dissolve) taken so far
+    unsigned char target;
+    unsigned char lfsr = 1;     // Next pixel of the dissolve
+    unsigned char pixel;
+    unsigned long started, cycles;
+
+    next_kind = TRANSITION_NONE;
+    if (kind == TRANSITION_NONE || frames == 0) {
+        frame_blend_back(256); // The caller sends it
+        return;
+    }
+
+    for (step = 1; step <= frames; step++) {
+        started = timer_now();
+        if (kind == TRANSITION_CROSSFADE) {
+            frame_blend_back(256 / (frames - step + 1));
+        } else if (kind == TRANSITION_WIPE) {
+            target = (unsigned int) FRAME_WIDTH * step / frames;
+            for (; done < target; done++)
+                for (y = 0; y < FRAME_HEIGHT; y++)
+                    frame_take_back(done, y);
+        } else {
+            target = (unsigned int) FRAME_PIXELS * step / frames;
+            for (; done < target; done++) {
+                pixel = done == FRAME_PIXELS - 1 ? 0 : lfsr;
+                frame_take_back(pixel % FRAME_WIDTH, pixel / FRAME_WIDTH);
+                lfsr = (lfsr >> 1) ^ (-(lfsr & 1) & DISSOLVE_TAPS);
+            }
+        }
+        cycles = timer_now() - started;
+        if (cycles > totals.max_cycles)
+            totals.max_cycles = cycles;
+
+        frame_show();
+        deadline += (unsigned long) TRANSITION_FRAME_MS * TIMER_COUNTS_PER_MS;
+        bus_wait_until(deadline);
+    }
+    totals.runs++;
+}
+
+/*
+ * Description
+ *      Step time statistics since start up.
+ * Parameters 
+ *      1. transition_stats_t *stats, filled in with the statistics
+ * Return
+ *      void
+ */
+void transition_stats(transition_stats_t *stats)
+{
+    *stats = totals;
+}
@@ -0,0 +1,83 @@
+/*
+ * File Description
+ *      Header file for the transitions between animations: crossfade, wipe and dissolve.
+ *
+ * Background
+ *      transition_next makes the frame buffer draw the next frame into its back buffer
+ *      (frame_draw_back) instead of the one that is shown. When the incoming animation sends its
+ *      first frame, frame_show calls transition_run, which moves the shown frame to it over a
+ *      number of frames and then lets the animation go on as usual. The animations don't need to
+ *      know about it.
+ *
+ *      Every step works in place on the shown frame, in one pass and without copying whole frames.
+ *      A crossfade moves each color channel 1/n of the way that is left, n being the steps that
+ *      are left, which is a straight line in time and lands exactly on the new frame at the last
+ *      step (integer math only, a multiply and a shift per channel). A wipe copies the columns the
+ *      edge has passed, left to right. A dissolve copies pixels in the order of a 6-bit maximal
+ *      length LFSR (x^6 + x^5 + 1), which visits pixels 1 to 63 once each in a scattered order
+ *      without a table, and pixel 0 last. Only the pixels that change are sent (frame_show).
+ *
+ *      A step is due every TRANSITION_FRAME_MS, with the sensor jobs run in the gaps.
+ *      transition_stats gives the longest time a step took, in instruction cycles.
+ */
+
+#ifndef TRANSITION_H
+#define	TRANSITION_H
+
+#include <xc.h> // include processor files - each processor file is guarded.  
+
+#ifdef	__cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+    #define TRANSITION_NONE 0       // Cut straight to the new frame
+    #define TRANSITION_CROSSFADE 1  // Fade every pixel from the old color to the new one
+    #define TRANSITION_WIPE 2       // New frame comes in from the left, a column at a time
+    #define TRANSITION_DISSOLVE 3   // New frame comes in a few scattered pixels at a time
+
+    #define TRANSITION_FRAME_MS 20  // Time per step, 50 fps
+    #define TRANSITION_FRAMES 16    // Steps of the transitions between fruits (320 ms)
+
+    typedef struct {
+        unsigned long runs;         // Transitions played
+        unsigned long max_cycles;   // Longest step, before sending it
+    } transition_stats_t;
+
+    /*
+     * Description
+     *      Plays a transition into the next frame that is drawn. The frame is drawn into the back
+     *      buffer, and the transition runs when it is sent with frame_show.
+     * Parameters 
+     *      1. unsigned char kind, one of the TRANSITION_ kinds
+     *      2. unsigned char frames, steps from the old frame to the new one
+     * Return
+     *      void
+     */
+    void transition_next(unsigned char kind, unsigned char frames);
+
+    /*
+     * Description
+     *      Moves the shown frame to the back buffer with the transition set by transition_next,
+     *      sending every step. Called by frame_show.
+     * Parameters 
+     *      void
+     * Return
+     *      void
+     */
+    void transition_run(void);
+
+    /*
+     * Description
+     *      Step time statistics since start up.
+     * Parameters 
+     *      1. transition_stats_t *stats, filled in with the statistics
+     * Return
+     *      void
+     */
+    void transition_stats(transition_stats_t *stats);
+
+#ifdef	__cplusplus
+}
+#endif /* __cplusplus */
+
+#endif	/* TRANSITION_H */
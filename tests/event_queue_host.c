@@ -0,0 +1,141 @@
+/*
+ * File Description
+ *      Host test for the event queue (Event_queue.c). A producer thread stands in for the
+ *      interrupt handlers and pushes numbered events as fast as it can while the main thread pops
+ *      them, now and then pausing so the queue fills up. Every event that comes out has to be the
+ *      next one the producer managed to queue, in order and intact, and event_overflows has to
+ *      count exactly the pushes that were refused.
+ */
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include "Event_queue.h"
+#include "Timer.h"
+
+#define EVENTS 100000UL         // Pushed by the producer thread
+#define PAUSE_EVERY 97          // The consumer pauses after this many pops
+#define BURST 8                 // The producer pauses after this many pushes, like interrupts do
+
+static volatile unsigned long sequence;             // Number of the event being pushed
+static unsigned char refused[EVENTS];               // Set for every push the queue turned down
+static volatile int producer_done;
+
+/*
+ * Description
+ *      Stand-in for the Timer2/Timer3 counter: event_push stamps every event with the number of
+ *      the event being pushed, so the consumer can tell which one it got.
+ * Parameters 
+ *      void
+ * Return
+ *      unsigned long, the number of the event being pushed
+ */
+unsigned long timer_now(void)
+{
+    return sequence;
+}
+
+/*
+ * Description
+ *      Producer thread. Pushes EVENTS events with the low bits of their number in type and arg, in
+ *      bursts of BURST.
+ * Parameters 
+ *      1. void *unused
+ * Return
+ *      void *, NULL
+ */
+static void *produce(void *unused)
+{
+    unsigned long n;
+
+    (void) unused;
+    for (n = 0; n < EVENTS; n++) {
+        sequence = n;
+        refused[n] = !event_push((unsigned char) (n >> 8), (unsigned char) n);
+        if (n % BURST == BURST - 1)
+            sched_yield();
+    }
+    producer_done = 1;
+    return NULL;
+}
+
+/*
+ * Description
+ *      Checks one event that came out of the queue against the one that should be next.
+ * Parameters 
+ *      1. const event_t *event, the event
+ *      2. unsigned long *expected, number of the next event that was not refused, moved past it
+ * Return
+ *      int, 0 if it matched, 1 if not
+ */
+static int check(const event_t *event, unsigned long *expected)
+{
+    unsigned long n = *expected;
+
+    while (n < EVENTS && refused[n])
+        n++;
+    if (n >= EVENTS || event->time != n || event->type != (unsigned char) (n >> 8)
+        || event->arg != (unsigned char) n) {
+        printf("FAIL got event %lu (type %u arg %u), expected %lu\n", event->time, event->type,
+               event->arg, n);
+        return 1;
+    }
+    *expected = n + 1;
+    return 0;
+}
+
+int main(void)
+{
+    pthread_t producer;
+    event_t event;
+    unsigned long expected = 0, popped = 0, refusals = 0, n;
+    unsigned int i;
+    int failed = 0;
+
+    // One thread first: a full queue refuses the next push and keeps the order
+    for (i = 0; i < EVENT_QUEUE_SIZE; i++) {
+        sequence = i;
+        failed |= !event_push(EVENT_TOUCH_DOWN, (unsigned char) i);
+    }
+    failed |= event_push(EVENT_TOUCH_UP, 0) || event_overflows() != 1 || !event_pending();
+    for (i = 0; i < EVENT_QUEUE_SIZE; i++)
+        failed |= !event_pop(&event) || event.arg != i || event.type != EVENT_TOUCH_DOWN;
+    failed |= event_pop(&event) || event_pending();
+    if (failed)
+        printf("FAIL filling and emptying the queue from one thread\n");
+
+    // Then a producer thread against this one
+    sequence = 0;
+    if (pthread_create(&producer, NULL, produce, NULL) != 0) {
+        printf("FAIL could not start the producer thread\n");
+        return 1;
+    }
+    while (!failed) {
+        if (event_pop(&event)) {
+            failed |= check(&event, &expected);
+            if (++popped % PAUSE_EVERY == 0)
+                for (i = 0; i < 4; i++)
+                    sched_yield();
+        } else if (producer_done && !event_pending()) {
+            break;
+        }
+    }
+    pthread_join(producer, NULL);
+
+    for (n = 0; n < EVENTS; n++)
+        refusals += refused[n];
+    while (!failed && expected < EVENTS && refused[expected])
+        expected++;
+    if (!failed && expected != EVENTS) {
+        printf("FAIL event %lu was queued but never came out\n", expected);
+        failed = 1;
+    }
+    if (!failed && event_overflows() != (refusals + 1 > 0xFFFF ? 0xFFFF : refusals + 1)) {
+        printf("FAIL event_overflows is %u, %lu pushes were refused\n", event_overflows(), refusals + 1);
+        failed = 1;
+    }
+
+    printf("event_queue_host: %lu events, %lu popped, %lu refused: %s\n", EVENTS, popped, refusals,
+           failed ? "FAILED" : "passed");
+    return failed;
+}
@@ -0,0 +1,156 @@
+/*
+ * File Description
+ *      Host test for the gesture recognizer (Gesture.c). Touch sequences are fed in with made up
+ *      times and gesture_poll is called every GESTURE_POLL_MS, the way the main loop does, and the
+ *      gestures that come out are checked. Every sequence is run twice, once with the clock just
+ *      before wrapping around.
+ */
+
+#include <stdio.h>
+#include "Gesture.h"
+
+#define MS(ms) ((unsigned long) (ms) * TIMER_COUNTS_PER_MS)
+#define MAX_GESTURES 8
+
+typedef struct {
+    unsigned char type;     // EVENT_TOUCH_DOWN or EVENT_TOUCH_UP
+    unsigned char channel;
+    unsigned int ms;        // Time from the start of the sequence
+} touch_t;
+
+typedef struct {
+    const char *name;
+    const touch_t *touches;
+    unsigned char count;
+    gesture_t expected[MAX_GESTURES];
+    unsigned char expected_count;
+    unsigned int blocked_ms;    // Nothing is fed or polled before this time
+} sequence_t;
+
+static const touch_t tap[] = {
+    { EVENT_TOUCH_DOWN, 1, 0 }, { EVENT_TOUCH_UP, 1, 100 }
+};
+static const touch_t double_tap[] = {
+    { EVENT_TOUCH_DOWN, 2, 0 }, { EVENT_TOUCH_UP, 2, 80 },
+    { EVENT_TOUCH_DOWN, 2, 200 }, { EVENT_TOUCH_UP, 2, 280 }
+};
+static const touch_t long_press[] = {
+    { EVENT_TOUCH_DOWN, 0, 0 }, { EVENT_TOUCH_UP, 0, 900 }
+};
+static const touch_t bounce[] = {
+    { EVENT_TOUCH_DOWN, 3, 0 }, { EVENT_TOUCH_UP, 3, 3 }, { EVENT_TOUCH_DOWN, 3, 6 },
+    { EVENT_TOUCH_UP, 3, 100 }, { EVENT_TOUCH_DOWN, 3, 104 }, { EVENT_TOUCH_UP, 3, 107 }
+};
+static const touch_t swipe[] = {
+    { EVENT_TOUCH_DOWN, 0, 0 }, { EVENT_TOUCH_UP, 0, 60 },
+    { EVENT_TOUCH_DOWN, 1, 150 }, { EVENT_TOUCH_UP, 1, 210 },
+    { EVENT_TOUCH_DOWN, 2, 300 }, { EVENT_TOUCH_UP, 2, 360 }
+};
+// Each touch comes almost GESTURE_SWIPE_GAP_MS after the last, so the first release is more than
+// GESTURE_DOUBLE_MS before the third touch
+static const touch_t slow_swipe[] = {
+    { EVENT_TOUCH_DOWN, 1, 0 }, { EVENT_TOUCH_UP, 1, 30 },
+    { EVENT_TOUCH_DOWN, 2, 240 }, { EVENT_TOUCH_UP, 2, 270 },
+    { EVENT_TOUCH_DOWN, 3, 480 }, { EVENT_TOUCH_UP, 3, 510 }
+};
+// Two neighbours, then nothing: two taps once a swipe is ruled out
+static const touch_t two_taps[] = {
+    { EVENT_TOUCH_DOWN, 0, 0 }, { EVENT_TOUCH_UP, 0, 50 },
+    { EVENT_TOUCH_DOWN, 1, 200 }, { EVENT_TOUCH_UP, 1, 250 }
+};
+// Too slow for a swipe
+static const touch_t late_neighbour[] = {
+    { EVENT_TOUCH_DOWN, 0, 0 }, { EVENT_TOUCH_UP, 0, 50 },
+    { EVENT_TOUCH_DOWN, 1, 400 }, { EVENT_TOUCH_UP, 1, 450 }
+};
+// A swipe that might still come keeps the first tap waiting past GESTURE_DOUBLE_MS, so the touch on 
+// the same fruit after it is too late for a double-tap
+static const touch_t held_tap[] = {
+    { EVENT_TOUCH_DOWN, 0, 0 }, { EVENT_TOUCH_UP, 0, 50 },
+    { EVENT_TOUCH_DOWN, 1, 200 }, { EVENT_TOUCH_UP, 1, 250 },
+    { EVENT_TOUCH_DOWN, 0, 400 }, { EVENT_TOUCH_UP, 0, 450 }
+};
+// Two taps a second apart, fed in a row after the main loop was busy
+static const touch_t late_feed[] = {
+    { EVENT_TOUCH_DOWN, 2, 0 }, { EVENT_TOUCH_UP, 2, 80 },
+    { EVENT_TOUCH_DOWN, 2, 1000 }, { EVENT_TOUCH_UP, 2, 1080 }
+};
+
+static const sequence_t sequences[] = {
+    { "tap", tap, 2, { { GESTURE_TAP, 1 } }, 1, 0 },
+    { "double-tap", double_tap, 4, { { GESTURE_DOUBLE_TAP, 2 } }, 1, 0 },
+    { "long-press", long_press, 2, { { GESTURE_LONG_PRESS, 0 } }, 1, 0 },
+    { "bounce", bounce, 6, { { GESTURE_TAP, 3 } }, 1, 0 },
+    { "swipe", swipe, 6, { { GESTURE_SWIPE, 0 } }, 1, 0 },
+    { "slow swipe", slow_swipe, 6, { { GESTURE_SWIPE, 1 } }, 1, 0 },
+    { "two taps", two_taps, 4, { { GESTURE_TAP, 0 }, { GESTURE_TAP, 1 } }, 2, 0 },
+    { "late neighbour", late_neighbour, 4, { { GESTURE_TAP, 0 }, { GESTURE_TAP, 1 } }, 2, 0 },
+    { "held tap", held_tap, 6, { { GESTURE_TAP, 0 }, { GESTURE_TAP, 1 }, { GESTURE_TAP, 0 } }, 3, 0 },
+    { "late feed", late_feed, 4, { { GESTURE_TAP, 2 }, { GESTURE_TAP, 2 } }, 2, 1200 },
+};
+
+/*
+ * Description
+ *      Feeds one sequence to the recognizer starting at a given time, polling until it has been
+ *      idle for a while, and compares the gestures with the expected ones.
+ * Parameters 
+ *      1. const sequence_t *sequence, the touches and the expected gestures
+ *      2. unsigned long start, timer_now() at the start of the sequence
+ * Return
+ *      int, 0 if the gestures matched, 1 if not
+ */
+static int run(const sequence_t *sequence, unsigned long start)
+{
+    gesture_t got[MAX_GESTURES];
+    unsigned char count = 0, next = 0, i;
+    unsigned int ms;
+    event_t event;
+    gesture_t gesture;
+
+    for (ms = sequence->blocked_ms; ms < 3000; ms += GESTURE_POLL_MS) {
+        while (next < sequence->count && sequence->touches[next].ms <= ms) {
+            event.type = sequence->touches[next].type;
+            event.arg = sequence->touches[next].channel;
+            event.time = start + MS(sequence->touches[next].ms);
+            gesture_feed(&event);
+            next++;
+        }
+        gesture_poll(start + MS(ms));
+        while (gesture_next(&gesture)) {
+            if (count < MAX_GESTURES)
+                got[count] = gesture;
+            count++;
+        }
+    }
+
+    if (gesture_busy()) {
+        printf("FAIL %s: still busy after the sequence\n", sequence->name);
+        return 1;
+    }
+    if (count != sequence->expected_count) {
+        printf("FAIL %s: %u gestures, expected %u\n", sequence->name, count, sequence->expected_count);
+        return 1;
+    }
+    for (i = 0; i < count; i++) {
+        if (got[i].type != sequence->expected[i].type || got[i].channel != sequence->expected[i].channel) {
+            printf("FAIL %s: gesture %u is type %u on %u, expected type %u on %u\n", sequence->name, i,
+                   got[i].type, got[i].channel, sequence->expected[i].type, sequence->expected[i].channel);
+            return 1;
+        }
+    }
+    return 0;
+}
+
+int main(void)
+{
+    unsigned long starts[2] = { MS(10000), 0UL - MS(150) }; // The second wraps during the sequence
+    unsigned char s, t;
+    int failed = 0;
+
+    for (t = 0; t < 2; t++)
+        for (s = 0; s < sizeof(sequences) / sizeof(sequences[0]); s++)
+            failed |= run(&sequences[s], starts[t]);
+
+    printf("gesture_host: %s\n", failed ? "FAILED" : "passed");
+    return failed;
+}
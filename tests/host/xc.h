@@ -0,0 +1,75 @@
+/*
+ * File Description
+ *      Stand-in for the XC16 device header when the hardware-independent modules are built on the 
+ *      PC for the host tests. Only what those modules use is here.
+ */
+
+#ifndef HOST_XC_H
+#define	HOST_XC_H
+
+/*
+ * Timer2/Timer3 as one 32-bit counter (Timer.c), simulated by the timer test. Every access goes 
+ * through host_timer_register, which moves the simulated clock on by an instruction or two and, 
+ * for TMR2, latches Timer3 into TMR3HLD like the real module. Writes are ignored.
+ */
+#define HOST_TMR2 0
+#define HOST_TMR3 1
+#define HOST_TMR3HLD 2
+
+#define TMR2 (*host_timer_register(HOST_TMR2))
+#define TMR3 (*host_timer_register(HOST_TMR3))
+#define TMR3HLD (*host_timer_register(HOST_TMR3HLD))
+
+typedef struct {
+    unsigned int T32 : 1;
+    unsigned int TON : 1;
+} host_t2con_t;
+
+extern volatile unsigned int T2CON, T3CON, PR2, PR3;
+extern volatile host_t2con_t T2CONbits;
+
+volatile unsigned int *host_timer_register(unsigned char which);
+
+/*
+ * UART1 (Stream.c), simulated by the stream test. Reading U1STAbits works the status out from the 
+ * simulated receive FIFO, U1RXREG takes the next byte from it, and every write of U1TXREG goes to 
+ * the next place of a log of the bytes sent. The interrupt attributes mean nothing on the PC.
+ */
+#define interrupt
+#define no_auto_psv
+
+typedef struct {
+    unsigned int URXDA : 1;
+    unsigned int OERR : 1;
+    unsigned int UTXBF : 1;
+    unsigned int UTXEN : 1;
+} host_u1sta_t;
+
+typedef struct {
+    unsigned int BRGH : 1;
+    unsigned int UARTEN : 1;
+} host_u1mode_t;
+
+typedef struct {
+    unsigned int U1RXIF : 1;    // IFS0bits
+    unsigned int U1RXIE : 1;    // IEC0bits
+    unsigned int TRISB6 : 1;    // TRISBbits
+    unsigned int U1RXR : 5;     // RPINR18bits
+    unsigned int RP7R : 5;      // RPOR3bits
+} host_uart_bits_t;
+
+#define U1STAbits (*host_u1sta())
+#define U1RXREG (host_u1rx())
+#define U1TXREG (*host_u1tx())
+
+volatile host_u1sta_t *host_u1sta(void);
+unsigned char host_u1rx(void);
+volatile unsigned int *host_u1tx(void);
+
+extern volatile unsigned int U1MODE, U1STA, U1BRG, OSCCON;
+extern volatile host_u1mode_t U1MODEbits;
+extern volatile host_uart_bits_t IFS0bits, IEC0bits, TRISBbits, RPINR18bits, RPOR3bits;
+
+void __builtin_write_OSCCONL(unsigned int value);
+
+#endif	/* HOST_XC_H */
@@ -0,0 +1,203 @@
+/*
+ * File Description
+ *      Host test and benchmark for the marquee (Marquee.c, drawing through Bitboard.c). A known
+ *      string is stepped through and the whole matrix is checked after every step against the
+ *      font columns it should have fed in: each character's columns, one blank column after it,
+ *      and then FRAME_WIDTH blank columns that push the text off the left edge before the marquee
+ *      says it is done. The benchmark steps long messages and reports the time per step on the PC.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "Marquee.h"
+#include "Frame_buffer.h"
+#include "Event_queue.h"
+#include "Timer.h"
+#include "Bus.h"
+
+#define MAX_COLUMNS 512
+#define BENCH_MESSAGES 20000
+
+static unsigned char rows[FRAME_HEIGHT];    // Row patterns drawn, bit 0x80 is the left-most LED
+static unsigned int shows;
+static unsigned int pending_after;          // event_pending answers 1 after this many shows, 0 for never
+static int failed;
+
+void frame_draw_row(unsigned char y, unsigned int bits, unsigned char r, unsigned char g, unsigned char b)
+{
+    (void) r;
+    (void) g;
+    (void) b;
+    rows[y] = (unsigned char) bits;
+}
+
+void frame_show(void)
+{
+    shows++;
+}
+
+unsigned char event_pending(void)
+{
+    return pending_after != 0 && shows >= pending_after;
+}
+
+void bus_wait_until(deadline_t deadline)
+{
+    (void) deadline;
+}
+
+unsigned long timer_now(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (unsigned long) now.tv_sec * 1000000000UL + now.tv_nsec;
+}
+
+/*
+ * Description
+ *      Columns a message should feed in: the columns of every character, read back from a marquee 
+ *      of that character alone, each followed by the blank gap. Checking a message against these 
+ *      checks how the characters are put together; the font itself is checked against columns 
+ *      written out by hand.
+ * Parameters 
+ *      1. const char *text, the message
+ *      2. unsigned char *columns, filled in with the columns, bit 0 the top row
+ * Return
+ *      unsigned int, number of columns
+ */
+static unsigned int expected_columns(const char *text, unsigned char *columns)
+{
+    static const unsigned char blank[MARQUEE_GLYPH_WIDTH];
+    unsigned int count = 0, i;
+    unsigned char c, x, y;
+
+    for (; *text; text++) {
+        c = (unsigned char) *text;
+        if (c >= 'a' && c <= 'z')
+            c -= 'a' - 'A';
+        if (c < MARQUEE_FIRST || c > MARQUEE_LAST)
+            c = '?';
+        memcpy(columns + count, blank, MARQUEE_GLYPH_WIDTH);
+        for (i = 0; i < MARQUEE_GLYPH_WIDTH; i++) {
+            char one[2] = { (char) c, 0 };
+
+            marquee_start(one);
+            for (x = 0; x <= i; x++)
+                marquee_step(1, 1, 1);
+            for (y = 0; y < 7; y++)
+                columns[count + i] |= (rows[y] & 1) << y;
+        }
+        count += MARQUEE_GLYPH_WIDTH;
+        columns[count++] = 0; // The gap
+    }
+    return count;
+}
+
+/*
+ * Description
+ *      Steps a message to the end and checks the whole matrix after every step.
+ * Parameters 
+ *      1. const char *text, the message
+ *      2. const unsigned char *columns, the columns it should feed in, bit 0 the top row
+ *      3. unsigned int count, number of columns
+ * Return
+ *      void
+ */
+static void check_message(const char *text, const unsigned char *columns, unsigned int count)
+{
+    unsigned int step, shown;
+    unsigned char x, y, want, lit;
+    int column;
+
+    marquee_start(text);
+    for (step = 0; step < count + FRAME_WIDTH; step++) {
+        if (!marquee_step(1, 1, 1)) {
+            printf("FAIL \"%s\": done after %u steps, expected %u\n", text, step, count + FRAME_WIDTH);
+            failed = 1;
+            return;
+        }
+        // Column x of the matrix shows message column step - (FRAME_WIDTH - 1) + x
+        for (x = 0; x < FRAME_WIDTH; x++) {
+            column = (int) step - (FRAME_WIDTH - 1) + x;
+            want = (column >= 0 && column < (int) count) ? columns[column] : 0;
+            for (y = 0; y < 7; y++) {
+                lit = (rows[y] >> (7 - x)) & 1;
+                if (lit != ((want >> y) & 1)) {
+                    printf("FAIL \"%s\" step %u: LED (%u, %u) is %u\n", text, step, x, y, lit);
+                    failed = 1;
+                    return;
+                }
+            }
+            if (rows[7] != 0) {
+                printf("FAIL \"%s\" step %u: bottom row lit\n", text, step);
+                failed = 1;
+                return;
+            }
+        }
+    }
+    shown = 0;
+    for (y = 0; y < FRAME_HEIGHT; y++)
+        shown |= rows[y];
+    if (shown != 0 || marquee_step(1, 1, 1)) {
+        printf("FAIL \"%s\": not blank and done after the run-out\n", text);
+        failed = 1;
+    }
+}
+
+int main(void)
+{
+    // 'H' and 'I' as in the font: bit 0 is the top row
+    static const unsigned char hi[] = { 0x7F, 0x08, 0x08, 0x08, 0x7F, 0, 0x00, 0x41, 0x7F, 0x41, 0x00, 0 };
+    static const char long_text[] = "THE QUICK BROWN FOX JUMPS OVER THE LAZY DOG 0123456789";
+    unsigned char columns[MAX_COLUMNS], question[MAX_COLUMNS];
+    unsigned int count, i, steps = 0;
+    struct timespec start, end;
+    marquee_stats_t stats;
+    double ns;
+
+    // A known string against columns written out by hand
+    check_message("HI", hi, sizeof(hi));
+    // The font columns read back one character at a time match too, lower case is shown in upper
+    // case and anything outside the font as '?'
+    count = expected_columns("hi~", columns);
+    if (count != 18 || memcmp(columns, hi, sizeof(hi)) != 0 || expected_columns("?", question) != 6
+        || memcmp(columns + sizeof(hi), question, 6) != 0) {
+        printf("FAIL \"hi~\" is not shown as \"HI?\"\n");
+        failed = 1;
+    }
+    check_message("hi~", columns, count);
+    count = expected_columns(long_text, columns);
+    check_message(long_text, columns, count);
+    check_message("", columns, 0);
+
+    // marquee_play shows every step, and stops when an event comes in
+    shows = 0;
+    if (!marquee_play("HI", 1, 1, 1) || shows != sizeof(hi) + FRAME_WIDTH) {
+        printf("FAIL marquee_play showed %u steps, expected %u\n", shows, (unsigned int) sizeof(hi) + FRAME_WIDTH);
+        failed = 1;
+    }
+    shows = 0;
+    pending_after = 3;
+    if (marquee_play("HI", 1, 1, 1) || shows != 3) {
+        printf("FAIL marquee_play did not stop on the event (%u steps)\n", shows);
+        failed = 1;
+    }
+    pending_after = 0;
+
+    // Benchmark: steps of a long message, drawing included
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (i = 0; i < BENCH_MESSAGES; i++) {
+        marquee_start(long_text);
+        while (marquee_step(1, 1, 1))
+            steps++;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    ns = ((end.tv_sec - start.tv_sec) * 1e9 + (end.tv_nsec - start.tv_nsec)) / steps;
+    marquee_stats(&stats);
+
+    printf("marquee_host: %lu steps, %.1f ns per step on this PC: %s\n", stats.steps, ns,
+           failed ? "FAILED" : "passed");
+    return failed;
+}
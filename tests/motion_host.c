@@ -0,0 +1,221 @@
+/*
+ * File Description
+ *      Host test and benchmark for the sprite motion (Motion.c). A sprite of one lit pixel is drawn
+ *      at every fraction of a pixel, and at whole-pixel and negative offsets around the matrix, and
+ *      the four shares it leaves are read back from the frame: drawn in full red, a pixel's red is
+ *      its coverage. The shares have to sit on the 2x2 pixels the sprite covers, follow the bilinear
+ *      weights and add up to 256 (a whole pixel shows 255, the most a pixel holds). The easing
+ *      curves have to start at 0, end at 256 and stay in between. The benchmark draws a full sprite
+ *      at moving offsets and reports the time per draw on the PC.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "Motion.h"
+#include "Frame_buffer.h"
+#include "Timer.h"
+#include "Bus.h"
+
+#define LIT_X 3             // Column of the lit pixel in the test sprite
+#define LIT_Y 4             // Row of the lit pixel in the test sprite
+#define MAX_EASE_STEP 8     // Most an easing curve may move for a 1/256 step of time
+#define BENCH_DRAWS 200000
+
+static unsigned char pixels[FRAME_HEIGHT][FRAME_WIDTH][3];  // Colors drawn
+static unsigned int shows;
+static int failed;
+
+void frame_set_pixel(unsigned char x, unsigned char y, unsigned char r, unsigned char g, unsigned char b)
+{
+    if (x >= FRAME_WIDTH || y >= FRAME_HEIGHT) {
+        printf("FAIL pixel (%u, %u) set off the matrix\n", x, y);
+        failed = 1;
+        return;
+    }
+    pixels[y][x][0] = r;
+    pixels[y][x][1] = g;
+    pixels[y][x][2] = b;
+}
+
+void frame_show(void)
+{
+    shows++;
+}
+
+void bus_wait_until(deadline_t deadline)
+{
+    (void) deadline;
+}
+
+unsigned long timer_now(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (unsigned long) now.tv_sec * 1000000000UL + now.tv_nsec;
+}
+
+/*
+ * Description
+ *      Whole pixels in a Q8.8 position, rounded down also for negative positions.
+ * Parameters 
+ *      1. int position, Q8.8
+ * Return
+ *      int, whole pixels
+ */
+static int floor_pixels(int position)
+{
+    return (position - (position & 0xFF)) / 256;
+}
+
+/*
+ * Description
+ *      Checks one share against the exact bilinear weight. Three shares are rounded down and the 
+ *      fourth takes what they leave, so a share is less than 3 off.
+ * Parameters 
+ *      1. unsigned int share, share read back
+ *      2. unsigned int a, coverage along x of the pixel, out of 256
+ *      3. unsigned int b, coverage along y of the pixel, out of 256
+ * Return
+ *      int, 1 if the share is close enough
+ */
+static int share_ok(unsigned int share, unsigned int a, unsigned int b)
+{
+    long exact = (long) a * b; // Share times 256
+    long off;
+
+    if (exact > 255 * 256)
+        exact = 255 * 256;  // A pixel holds no more than 255
+    off = (long) share * 256 - exact;
+    return off > -3 * 256 && off < 3 * 256;
+}
+
+/*
+ * Description
+ *      Draws the one-pixel sprite at an offset and checks the shares it leaves.
+ * Parameters 
+ *      1. int x, offset in Q8.8 columns
+ *      2. int y, offset in Q8.8 rows
+ * Return
+ *      void
+ */
+static void check_offset(int x, int y)
+{
+    int px = LIT_X * 256 + x, py = LIT_Y * 256 + y;    // Where the lit pixel lands, Q8.8
+    int left = floor_pixels(px), top = floor_pixels(py);
+    unsigned int fx = px & 0xFF, fy = py & 0xFF;
+    unsigned int share, sum = 0, lit = 0, weight_x, weight_y;
+    unsigned char sx, sy;
+
+    sprite_draw(0x8000000000000000ULL >> (LIT_Y * 8 + LIT_X), x, y, 255, 128, 1);
+    for (sy = 0; sy < FRAME_HEIGHT; sy++) {
+        for (sx = 0; sx < FRAME_WIDTH; sx++) {
+            share = pixels[sy][sx][0];
+            // The other colors are scaled by the same coverage
+            if (pixels[sy][sx][1] != (128 * (share + 1)) >> 8 || pixels[sy][sx][2] != (share == 255)) {
+                printf("FAIL offset (%d, %d): pixel (%u, %u) colors %u %u %u\n", x, y, sx, sy,
+                       share, pixels[sy][sx][1], pixels[sy][sx][2]);
+                failed = 1;
+                return;
+            }
+            if (sx == left || sx == left + 1)
+                weight_x = sx == left ? 256 - fx : fx;
+            else
+                weight_x = 0;
+            if (sy == top || sy == top + 1)
+                weight_y = sy == top ? 256 - fy : fy;
+            else
+                weight_y = 0;
+            if (!share_ok(share, weight_x, weight_y)) {
+                printf("FAIL offset (%d, %d): pixel (%u, %u) has share %u, expected %u/256\n", x, y, sx, sy,
+                       share, weight_x * weight_y / 256);
+                failed = 1;
+                return;
+            }
+            sum += share;
+            lit += share != 0;
+        }
+    }
+    // All four shares are on the matrix here, so they add up to a whole pixel. When the other 
+    // three round down to 0, the whole of it is on one pixel, which shows 255.
+    if (left >= 0 && left + 1 < FRAME_WIDTH && top >= 0 && top + 1 < FRAME_HEIGHT
+        && !(sum == 256 || (sum == 255 && lit == 1))) {
+        printf("FAIL offset (%d, %d): shares add up to %u\n", x, y, sum);
+        failed = 1;
+    }
+}
+
+int main(void)
+{
+    static const unsigned char eases[] = { EASE_LINEAR, EASE_IN, EASE_IN_OUT, EASE_BOUNCE };
+    static const motion_t move = { 0xFF818181818181FFULL, MOTION_PIXELS(-8), MOTION_PIXELS(-3), 0, 0, 6,
+                                   EASE_BOUNCE, 255, 255, 255 };
+    struct timespec start, end;
+    motion_stats_t stats;
+    unsigned int fx, fy, t, e, i;
+    int x, y, done, last;
+    unsigned char sx, sy;
+    double ns;
+
+    // Every fraction of a pixel, away from the edges
+    for (fy = 0; fy < 256; fy++)
+        for (fx = 0; fx < 256; fx++)
+            check_offset(fx, fy);
+    // Whole-pixel and negative offsets, including ones that push shares off every edge
+    for (y = MOTION_PIXELS(-6); y <= MOTION_PIXELS(5); y += 64)
+        for (x = MOTION_PIXELS(-5); x <= MOTION_PIXELS(6); x += 64)
+            check_offset(x, y);
+    for (y = MOTION_PIXELS(-6); y <= MOTION_PIXELS(5); y += 229)
+        for (x = MOTION_PIXELS(-5); x <= MOTION_PIXELS(6); x += 197)
+            check_offset(x, y);
+
+    // Easing curves: 0 at the start, 256 at the end and after it, no jumps in between
+    for (e = 0; e < sizeof(eases); e++) {
+        if (motion_ease(eases[e], 0) != 0 || motion_ease(eases[e], 256) != 256
+            || motion_ease(eases[e], 300) != 256) {
+            printf("FAIL ease %u: %d at the start, %d at the end\n", eases[e], motion_ease(eases[e], 0),
+                   motion_ease(eases[e], 256));
+            failed = 1;
+        }
+        last = 0;
+        for (t = 1; t <= 256; t++) {
+            done = motion_ease(eases[e], t);
+            if (done < 0 || done > 256 || abs(done - last) > MAX_EASE_STEP
+                || (eases[e] != EASE_BOUNCE && done < last)) {
+                printf("FAIL ease %u: %d at t = %u after %d\n", eases[e], done, t, last);
+                failed = 1;
+                break;
+            }
+            last = done;
+        }
+    }
+
+    // A move shows every frame and ends on its last position
+    shows = 0;
+    motion_play(&move);
+    for (sy = 0; sy < FRAME_HEIGHT; sy++) {
+        for (sx = 0; sx < FRAME_WIDTH; sx++) {
+            if (pixels[sy][sx][0] != ((move.shape >> (63 - sy * 8 - sx)) & 1) * 255) {
+                printf("FAIL motion_play ended with pixel (%u, %u) at %u\n", sx, sy, pixels[sy][sx][0]);
+                failed = 1;
+            }
+        }
+    }
+    if (shows != move.frames + 1) {
+        printf("FAIL motion_play showed %u frames, expected %u\n", shows, move.frames + 1);
+        failed = 1;
+    }
+
+    // Benchmark: a full sprite at moving fractional offsets
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (i = 0; i < BENCH_DRAWS; i++)
+        sprite_draw(0xFF818181818181FFULL, (int) (i % 1024) - 512, (int) (i * 7 % 1024) - 512, 255, 128, 1);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    ns = ((end.tv_sec - start.tv_sec) * 1e9 + (end.tv_nsec - start.tv_nsec)) / BENCH_DRAWS;
+    motion_stats(&stats);
+
+    printf("motion_host: %lu sprites, %.1f ns per sprite_draw on this PC: %s\n", stats.frames, ns,
+           failed ? "FAILED" : "passed");
+    return failed;
+}
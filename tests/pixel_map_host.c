@@ -0,0 +1,103 @@
+/*
+ * File Description
+ *      Host test for pixel_map (Pixel_map.c), built once for every MATRIX_WIRING, MATRIX_ROTATION
+ *      and MATRIX_MIRROR setting (see the Makefile). Checks that the table is a permutation of the
+ *      chain, that the corners of the drawing land on the expected corners of the panel, and that
+ *      LEDs next to each other in the chain show drawing positions next to each other.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "Pixel_map.h"
+
+// Corners, clockwise from the top-left
+#define TOP_LEFT 0
+#define TOP_RIGHT 1
+#define BOTTOM_RIGHT 2
+#define BOTTOM_LEFT 3
+
+/*
+ * Description
+ *      Chain index of a corner of the panel for the configured wiring.
+ * Parameters 
+ *      1. unsigned char corner, one of the corners above
+ * Return
+ *      unsigned char, chain index
+ */
+static unsigned char panel_corner(unsigned char corner)
+{
+    unsigned char last_row_reversed = MATRIX_WIRING == MATRIX_WIRING_SERPENTINE && ((FRAME_HEIGHT - 1) & 1);
+
+    if (corner == TOP_LEFT)
+        return 0;
+    if (corner == TOP_RIGHT)
+        return FRAME_WIDTH - 1;
+    if (corner == BOTTOM_LEFT)
+        return (FRAME_HEIGHT - 1) * FRAME_WIDTH + (last_row_reversed ? FRAME_WIDTH - 1 : 0);
+    return (FRAME_HEIGHT - 1) * FRAME_WIDTH + (last_row_reversed ? 0 : FRAME_WIDTH - 1);
+}
+
+/*
+ * Description
+ *      Corner of the panel a corner of the drawing ends up on: turning clockwise moves every corner
+ *      one place on clockwise, and the mirror swaps left and right.
+ * Parameters 
+ *      1. unsigned char corner, corner of the drawing
+ * Return
+ *      unsigned char, corner of the panel
+ */
+static unsigned char moved_corner(unsigned char corner)
+{
+    corner = (corner + MATRIX_ROTATION / 90) & 3;
+    if (MATRIX_MIRROR)
+        corner ^= 1; // Top-left <-> top-right, bottom-right <-> bottom-left
+    return corner;
+}
+
+int main(void)
+{
+    static const unsigned char corner_x[4] = { 0, FRAME_WIDTH - 1, FRAME_WIDTH - 1, 0 };
+    static const unsigned char corner_y[4] = { 0, 0, FRAME_HEIGHT - 1, FRAME_HEIGHT - 1 };
+    unsigned char seen[FRAME_PIXELS] = { 0 };
+    unsigned char where_x[FRAME_PIXELS], where_y[FRAME_PIXELS];
+    unsigned char x, y, c, index;
+    unsigned int i;
+    int failed = 0;
+
+    for (y = 0; y < FRAME_HEIGHT; y++) {
+        for (x = 0; x < FRAME_WIDTH; x++) {
+            index = pixel_map[y * FRAME_WIDTH + x];
+            if (index >= FRAME_PIXELS || seen[index]++) {
+                printf("FAIL (%u, %u) maps to %u, outside the chain or used twice\n", x, y, index);
+                failed = 1;
+                continue;
+            }
+            where_x[index] = x;
+            where_y[index] = y;
+        }
+    }
+
+    for (c = 0; c < 4; c++) {
+        index = pixel_map[corner_y[c] * FRAME_WIDTH + corner_x[c]];
+        if (index != panel_corner(moved_corner(c))) {
+            printf("FAIL drawing corner %u is LED %u, expected %u\n", c, index, panel_corner(moved_corner(c)));
+            failed = 1;
+        }
+    }
+
+    // Neighbours in the chain are neighbours in the drawing, except across the end of a row unless
+    // the panel is serpentine
+    for (i = 0; !failed && i + 1 < FRAME_PIXELS; i++) {
+        if (MATRIX_WIRING != MATRIX_WIRING_SERPENTINE && (i + 1) % FRAME_WIDTH == 0)
+            continue;
+        if (abs(where_x[i] - where_x[i + 1]) + abs(where_y[i] - where_y[i + 1]) != 1) {
+            printf("FAIL LEDs %u and %u show (%u, %u) and (%u, %u)\n", i, i + 1,
+                   where_x[i], where_y[i], where_x[i + 1], where_y[i + 1]);
+            failed = 1;
+        }
+    }
+
+    printf("pixel_map_host wiring %d rotation %d mirror %d: %s\n", MATRIX_WIRING, MATRIX_ROTATION,
+           MATRIX_MIRROR, failed ? "FAILED" : "passed");
+    return failed;
+}
@@ -0,0 +1,98 @@
+/*
+ * File Description
+ *      Host test for the proximity averages (Proximity.c). The CAP1188 delta counts are made up: a 
+ *      channel sits a little below its baseline with nothing near, so its average goes negative, 
+ *      and is then touched hard enough to saturate the delta count at 127. The level has to climb 
+ *      to full within a few updates and stay there while the touch lasts, and fall back to 0 on the 
+ *      release. The PC's int is 32 bits, so a step worked out in int would not overflow here the 
+ *      way it does on the PIC24; the test checks the levels the steps must give.
+ */
+
+#include <stdio.h>
+#include "Proximity.h"
+
+#define SETTLE 40   // Updates for the average to settle on a steady delta count
+
+static signed char deltas[TOUCH_CHANNELS]; // Delta counts the next read returns
+static int failed;
+
+unsigned char touch_device_read_block(touch_device_t *device, unsigned char reg, unsigned char *data, unsigned char count)
+{
+    unsigned char c;
+
+    if (!device->present || reg != TOUCH_DELTA_COUNT || count != TOUCH_CHANNELS)
+        return 0;
+    for (c = 0; c < count; c++)
+        data[c] = (unsigned char) deltas[c];
+    return 1;
+}
+
+/*
+ * Description
+ *      Runs updates with one delta count on channel 0 and checks the level of channel 0 after each.
+ * Parameters 
+ *      1. const char *step, name of the step for the report
+ *      2. touch_device_t *device, the device to read
+ *      3. signed char delta, the delta count of channel 0
+ *      4. unsigned int updates, updates to run
+ *      5. unsigned int within, updates by which the level has to reach the target
+ *      6. unsigned char target, the level expected from then on
+ * Return
+ *      void
+ */
+static void run(const char *step, touch_device_t *device, signed char delta, unsigned int updates,
+                unsigned int within, unsigned char target)
+{
+    unsigned char level, last = proximity_level(0);
+    unsigned int i;
+
+    deltas[0] = delta;
+    for (i = 1; i <= updates; i++) {
+        proximity_update(device);
+        level = proximity_level(0);
+        // The level only moves towards the new delta count
+        if ((target >= last && level < last) || (target < last && level > last)) {
+            printf("FAIL %s: level went from %u to %u on update %u\n", step, last, level, i);
+            failed = 1;
+        }
+        if (i >= within && level != target) {
+            printf("FAIL %s: level %u after %u updates, expected %u\n", step, level, i, target);
+            failed = 1;
+        }
+        last = level;
+    }
+}
+
+int main(void)
+{
+    touch_device_t device = { 0 };
+
+    device.present = 1;
+    deltas[3] = PROXIMITY_FULL / 2; // A hand half way to channel 3
+
+    // Nothing near: the delta count a few counts under the baseline, the average negative
+    run("baseline", &device, -3, SETTLE, 1, 0);
+    if (proximity_nearest() != 3) {
+        printf("FAIL baseline: nearest is %u, expected 3\n", proximity_nearest());
+        failed = 1;
+    }
+
+    // A hard touch saturates the delta count: full within 3 updates, and it stays full
+    run("touch", &device, 127, SETTLE, 3, 255);
+    if (proximity_nearest() != 0) {
+        printf("FAIL touch: nearest is %u, expected 0\n", proximity_nearest());
+        failed = 1;
+    }
+    run("release", &device, -3, SETTLE, 20, 0);
+
+    // The lowest delta count there is, then the highest
+    run("lowest", &device, -128, SETTLE, 1, 0);
+    run("touch from lowest", &device, 127, SETTLE, 5, 255);
+
+    // A device that does not answer leaves the values as they are
+    device.present = 0;
+    run("missing device", &device, -3, 4, 1, 255);
+
+    printf("proximity_host: %s\n", failed ? "FAILED" : "passed");
+    return failed;
+}
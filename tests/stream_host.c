@@ -0,0 +1,358 @@
+/*
+ * File Description
+ *      Host test and benchmark for the frame streaming parser (Stream.c). Frames are put in the
+ *      simulated UART receive FIFO of host/xc.h a few bytes at a time and moved into the ring by
+ *      the receive interrupt, like on the chip, and stream_poll parses them. The test checks the
+ *      ACK and NAK bytes sent back, the CRC against a bit by bit CRC-16/CCITT, that a good frame
+ *      only becomes the front buffer once it is complete and the frame being shown is not written
+ *      over by the next one, the resync after a bad frame, and the ring and FIFO overflow counts.
+ *      The benchmark parses a run of RGB frames and reports the PC's parse time per frame next to
+ *      the time the frame takes on the wire at 1 Mbaud; the PIC24 is far slower than the PC, so
+ *      it only shows the parser's cost per byte, not the margin on the chip.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "Stream.h"
+#include "Event_queue.h"
+#include "Frame_buffer.h"
+#include "Anim_store.h"
+
+#define FIFO_SIZE 4             // Receive FIFO of the UART
+#define RGB_LENGTH (FRAME_PIXELS * 3)
+#define BPP4_LENGTH (16 * 3 + FRAME_PIXELS / 2)
+#define FRAME_MAX (5 + RGB_LENGTH + 2)
+#define WIRE_NS_PER_BYTE 10000UL // 10 bits at 1 Mbaud
+#define GOOD_FRAMES 7            // Good display frames in the test before the benchmark
+#define BENCH_FRAMES 20000
+
+volatile unsigned int U1MODE, U1STA, U1BRG, OSCCON;
+volatile host_u1mode_t U1MODEbits;
+volatile host_uart_bits_t IFS0bits, IEC0bits, TRISBbits, RPINR18bits, RPOR3bits;
+
+static unsigned char fifo[FIFO_SIZE];
+static unsigned char fifo_count;
+static volatile host_u1sta_t u1sta;
+static volatile unsigned int sent[4096];     // Bytes written to U1TXREG
+static unsigned int sent_count;
+
+static unsigned char shown[FRAME_PIXELS][3]; // Pixels drawn by stream_show
+static unsigned int shows;
+static unsigned char store_result;           // What anim_store_command answers
+static unsigned char store_type;             // Type of the last command it got
+static int failed;
+
+void __builtin_write_OSCCONL(unsigned int value)
+{
+    OSCCON = value;
+}
+
+volatile host_u1sta_t *host_u1sta(void)
+{
+    u1sta.URXDA = fifo_count != 0;
+    u1sta.UTXBF = 0;
+    return &u1sta;
+}
+
+unsigned char host_u1rx(void)
+{
+    unsigned char byte = fifo[0];
+
+    if (fifo_count != 0)
+        memmove(fifo, fifo + 1, --fifo_count);
+    return byte;
+}
+
+volatile unsigned int *host_u1tx(void)
+{
+    if (sent_count == sizeof(sent) / sizeof(sent[0]))
+        sent_count = 0;
+    return &sent[sent_count++];
+}
+
+unsigned long timer_now(void)
+{
+    return 0;
+}
+
+void frame_set_pixel(unsigned char x, unsigned char y, unsigned char r, unsigned char g, unsigned char b)
+{
+    shown[y * FRAME_WIDTH + x][0] = r;
+    shown[y * FRAME_WIDTH + x][1] = g;
+    shown[y * FRAME_WIDTH + x][2] = b;
+}
+
+void frame_show(void)
+{
+    shows++;
+}
+
+unsigned char anim_store_command(unsigned char type, const unsigned char *payload)
+{
+    (void) payload;
+    store_type = type;
+    return store_result;
+}
+
+void _U1RXInterrupt(void);
+
+/*
+ * Description
+ *      CRC-16/CCITT one bit at a time, to check the table driven one against.
+ * Parameters 
+ *      1. const unsigned char *data, the bytes
+ *      2. unsigned int count, number of bytes
+ * Return
+ *      unsigned int, the CRC
+ */
+static unsigned int reference_crc(const unsigned char *data, unsigned int count)
+{
+    unsigned int crc = 0xFFFF, i, bit;
+
+    for (i = 0; i < count; i++) {
+        crc ^= (unsigned int) data[i] << 8;
+        for (bit = 0; bit < 8; bit++)
+            crc = (crc & 0x8000) ? ((crc << 1) ^ 0x1021) & 0xFFFF : (crc << 1) & 0xFFFF;
+    }
+    return crc;
+}
+
+/*
+ * Description
+ *      Builds a frame for the wire.
+ * Parameters 
+ *      1. unsigned char *frame, filled in with the frame
+ *      2. unsigned char type, the type
+ *      3. const unsigned char *payload, the payload
+ *      4. unsigned int length, length of the payload
+ * Return
+ *      unsigned int, length of the frame
+ */
+static unsigned int make_frame(unsigned char *frame, unsigned char type, const unsigned char *payload, unsigned int length)
+{
+    unsigned int crc;
+
+    frame[0] = STREAM_SYNC;
+    frame[1] = type;
+    frame[2] = length & 0xFF;
+    frame[3] = length >> 8;
+    memcpy(frame + 4, payload, length);
+    crc = reference_crc(frame + 1, length + 3);
+    frame[4 + length] = crc >> 8;
+    frame[5 + length] = crc & 0xFF;
+    return length + 6;
+}
+
+/*
+ * Description
+ *      Receives bytes the way the UART does: into the FIFO, taken out by the receive interrupt
+ *      when it is full, and parsed by stream_poll every poll_every bytes.
+ * Parameters 
+ *      1. const unsigned char *data, the bytes
+ *      2. unsigned int count, number of bytes
+ *      3. unsigned int poll_every, bytes between stream_poll calls, 0 for none
+ * Return
+ *      void
+ */
+static void receive(const unsigned char *data, unsigned int count, unsigned int poll_every)
+{
+    unsigned int i;
+
+    for (i = 0; i < count; i++) {
+        fifo[fifo_count++] = data[i];
+        if (fifo_count == FIFO_SIZE || i + 1 == count)
+            _U1RXInterrupt();
+        if (poll_every != 0 && ((i + 1) % poll_every == 0 || i + 1 == count))
+            stream_poll();
+    }
+}
+
+/*
+ * Description
+ *      Checks the bytes sent back since the last call.
+ * Parameters 
+ *      1. const char *step, name of the step for the report
+ *      2. int expected, the one byte expected, or -1 for none
+ * Return
+ *      void
+ */
+static void expect_sent(const char *step, int expected)
+{
+    if ((expected < 0 && sent_count != 0) || (expected >= 0 && (sent_count != 1 || sent[0] != (unsigned int) expected))) {
+        printf("FAIL %s: sent %u bytes, first 0x%02x, expected %s 0x%02x\n", step, sent_count,
+               sent_count ? sent[0] : 0, expected < 0 ? "nothing" : "", expected < 0 ? 0 : expected);
+        failed = 1;
+    }
+    sent_count = 0;
+}
+
+/*
+ * Description
+ *      Shows the front frame and checks its pixels.
+ * Parameters 
+ *      1. const char *step, name of the step for the report
+ *      2. const unsigned char *expected, the pixels expected, 3 bytes each, or NULL for no frame
+ * Return
+ *      void
+ */
+static void expect_show(const char *step, const unsigned char *expected)
+{
+    unsigned char got = stream_show();
+
+    if (got != (expected != NULL) || (expected != NULL && memcmp(shown, expected, sizeof(shown)) != 0)) {
+        printf("FAIL %s: %s\n", step, got ? "wrong frame shown" : "no frame shown");
+        failed = 1;
+    }
+    expect_sent(step, expected != NULL ? STREAM_ACK : -1);
+}
+
+int main(void)
+{
+    static unsigned char frame[FRAME_MAX], frame2[FRAME_MAX];
+    unsigned char rgb[RGB_LENGTH], rgb2[RGB_LENGTH], bpp4[BPP4_LENGTH], expected[RGB_LENGTH];
+    unsigned char check_payload[1] = { 0 }, junk[3 * STREAM_RX_SIZE];
+    unsigned int i, length, length2, crc;
+    stream_stats_t stats;
+    event_t event;
+    struct timespec start, end;
+    double ns;
+
+    stream_init();
+    for (i = 0; i < RGB_LENGTH; i++) {
+        rgb[i] = (unsigned char) (i * 7);
+        rgb2[i] = (unsigned char) (255 - i);
+    }
+    for (i = 0; i < BPP4_LENGTH; i++)
+        bpp4[i] = (unsigned char) (i * 13 + 5);
+
+    // CRC of the replies: the table driven CRC against the bit by bit one
+    stream_send_start(0x33, 9);
+    for (i = 0; i < 9; i++)
+        stream_send_byte((unsigned char) ('1' + i));
+    stream_send_end();
+    for (i = 0; i < 13; i++)
+        frame[i] = (unsigned char) sent[i];
+    crc = reference_crc(frame + 1, 12);
+    if (sent_count != 15 || sent[0] != STREAM_SYNC || sent[13] != (crc >> 8) || sent[14] != (crc & 0xFF)) {
+        printf("FAIL reply CRC 0x%02x%02x, expected 0x%04x\n", sent[13], sent[14], crc);
+        failed = 1;
+    }
+    sent_count = 0;
+
+    // The first byte in an empty ring wakes the main loop
+    length = make_frame(frame, STREAM_TYPE_RGB, rgb, RGB_LENGTH);
+    receive(frame, 1, 0);
+    if (!event_pop(&event) || event.type != EVENT_STREAM_RX || event_pop(&event)) {
+        printf("FAIL no single EVENT_STREAM_RX for the first byte\n");
+        failed = 1;
+    }
+
+    // A good RGB frame, fed together with junk before the next sync byte
+    receive(frame + 1, length - 1, 16);
+    expect_sent("RGB frame", -1);
+    receive((const unsigned char *) "\x00\x13\xFF", 3, 1);
+    expect_show("RGB frame", rgb);
+    expect_show("RGB frame shown twice", NULL);
+
+    // A 4bpp frame goes through the palette
+    length = make_frame(frame, STREAM_TYPE_4BPP, bpp4, BPP4_LENGTH);
+    receive(frame, length, 7);
+    for (i = 0; i < FRAME_PIXELS; i++) {
+        unsigned char index = bpp4[48 + i / 2];
+
+        index = (i & 1) ? (index & 0x0F) : (index >> 4);
+        memcpy(expected + i * 3, bpp4 + index * 3, 3);
+    }
+    expect_show("4bpp frame", expected);
+
+    // Two frames before the first is shown: the newer one is shown
+    length = make_frame(frame, STREAM_TYPE_RGB, rgb, RGB_LENGTH);
+    length2 = make_frame(frame2, STREAM_TYPE_RGB, rgb2, RGB_LENGTH);
+    receive(frame, length, 32);
+    receive(frame2, length2, 32);
+    expect_show("newer frame", rgb2);
+
+    // Half of the next frame arriving does not touch the one waiting to be shown
+    receive(frame, length, 64);
+    receive(frame2, length2 / 2, 64);
+    expect_show("frame while the next arrives", rgb);
+    receive(frame2 + length2 / 2, length2 - length2 / 2, 64);
+    expect_show("the next frame", rgb2);
+
+    // A bad CRC is answered with NAK and shows nothing
+    length = make_frame(frame, STREAM_TYPE_RGB, rgb, RGB_LENGTH);
+    frame[length - 1] ^= 0x01;
+    receive(frame, length, 16);
+    expect_sent("bad CRC", STREAM_NAK);
+    expect_show("bad CRC", NULL);
+    // So is a flipped payload bit
+    length = make_frame(frame, STREAM_TYPE_RGB, rgb, RGB_LENGTH);
+    frame[100] ^= 0x40;
+    receive(frame, length, 16);
+    expect_sent("bad payload", STREAM_NAK);
+
+    // A length that does not fit the type is answered as soon as the length is in, and the parser
+    // finds the next frame
+    length = make_frame(frame, STREAM_TYPE_RGB, rgb, RGB_LENGTH - 1);
+    receive(frame, 4, 1);
+    expect_sent("bad length", STREAM_NAK);
+    receive(frame + 4, length - 4, 16);
+    sent_count = 0; // Whatever the rest of the bad frame looked like
+    length = make_frame(frame, STREAM_TYPE_RGB, rgb2, RGB_LENGTH);
+    receive(frame, length, 16);
+    expect_show("frame after a bad length", rgb2);
+    length = make_frame(frame, 0x7E, rgb, 1);
+    receive(frame, length, 16);
+    expect_sent("unknown type", STREAM_NAK);
+
+    // Animation store commands are answered with what anim_store_command says
+    store_result = 1;
+    length = make_frame(frame, STREAM_TYPE_STORE_CHECK, check_payload, 1);
+    receive(frame, length, 16);
+    expect_sent("store ACK", STREAM_ACK);
+    store_result = 0;
+    receive(frame, length, 16);
+    expect_sent("store NAK", STREAM_NAK);
+    if (store_type != STREAM_TYPE_STORE_CHECK) {
+        printf("FAIL anim_store_command got type 0x%02x\n", store_type);
+        failed = 1;
+    }
+    expect_show("store command", NULL);
+
+    // More than the ring holds without a poll: the rest is dropped and counted
+    memset(junk, 0, sizeof(junk));
+    receive(junk, sizeof(junk), 0);
+    stream_poll();
+    u1sta.OERR = 1;
+    _U1RXInterrupt();
+    stream_stats(&stats);
+    if (stats.ring_drops != sizeof(junk) - STREAM_RX_SIZE || stats.overruns != 1 || u1sta.OERR) {
+        printf("FAIL %u ring drops, %u overruns\n", stats.ring_drops, stats.overruns);
+        failed = 1;
+    }
+    if (stats.frames != GOOD_FRAMES || stats.shown != 6 || stats.crc_errors != 2 || stats.length_errors != 2) {
+        printf("FAIL statistics: %lu frames, %lu shown, %u CRC errors, %u length errors\n", stats.frames,
+               stats.shown, stats.crc_errors, stats.length_errors);
+        failed = 1;
+    }
+    while (event_pop(&event)) {}
+
+    // Benchmark: a run of RGB frames through the FIFO, the ring and the parser
+    length = make_frame(frame, STREAM_TYPE_RGB, rgb, RGB_LENGTH);
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (i = 0; i < BENCH_FRAMES; i++)
+        receive(frame, length, 64);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    ns = ((end.tv_sec - start.tv_sec) * 1e9 + (end.tv_nsec - start.tv_nsec)) / BENCH_FRAMES;
+    expect_show("after the benchmark", rgb);
+    stream_stats(&stats);
+    if (stats.frames != GOOD_FRAMES + BENCH_FRAMES) {
+        printf("FAIL benchmark: %lu frames received\n", stats.frames - GOOD_FRAMES);
+        failed = 1;
+    }
+
+    printf("stream_host: RGB frame parsed in %.0f ns on this PC, %lu us on the wire: %s\n", ns,
+           length * WIRE_NS_PER_BYTE / 1000, failed ? "FAILED" : "passed");
+    return failed;
+}
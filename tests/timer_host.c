@@ -0,0 +1,268 @@
+/*
+ * File Description
+ *      Host test for the timer delays and deadlines (Timer.c), and for Ndelay (Support_fruit.c) with
+ *      the bus scheduler it waits in (Bus.c). The Timer2/Timer3 counter is simulated behind the
+ *      registers of host/xc.h: every register access takes one or two counts, power_idle sleeps to
+ *      the next Timer1 tick, and interrupt handlers that read the timer themselves land between the
+ *      accesses. Every delay has to end at or after its deadline and no later than the bound of
+ *      Timer.h (one pass of the final spin loop, plus a retry of timer_now and an interrupt that
+ *      lands in it), and the time past the deadline is reported as the drift. The test is built
+ *      with -Dlong=int, so long is 32 bits like on the PIC24 and the counter wraps where it does on
+ *      the chip. That is also why no standard header is included.
+ */
+
+#include "Timer.h"
+#include "Power.h"
+#include "Bus.h"
+#include "Support_fruit.h"
+
+int printf(const char *format, ...);
+
+#define MAX_STEP 2                      // Most counts one register access takes
+#define PASS_COUNTS (3 * MAX_STEP)      // One timer_now without a retry
+#define ISR_COUNTS 80                   // Time an interrupt handler takes
+#define INTERRUPT_EVERY 397             // Register accesses between interrupts in the delay tests
+#define TICK_COUNTS (FCY / POWER_TICK_HZ)
+#define LATE_COUNTS (2 * PASS_COUNTS + MAX_STEP + ISR_COUNTS) // Latest a wait may end
+#define JOB_COUNTS (700 * TIMER_COUNTS_PER_US) // Time the bus job below takes
+
+volatile unsigned int T2CON, T3CON, PR2, PR3;
+volatile host_t2con_t T2CONbits;
+
+static unsigned long clock;                 // The simulated 32-bit counter
+static unsigned int registers[3];           // TMR2, TMR3 and TMR3HLD as last read
+static unsigned long random_state = 1;
+static unsigned int interrupt_every;        // Register accesses between interrupts, 0 for none
+static unsigned int accesses;
+static unsigned char interrupt_before_hld;  // Interrupt right before the next TMR3HLD read
+static unsigned char in_interrupt;
+static unsigned char marked;                // Set by mark, cleared by the next TMR2 read
+static unsigned long first_read;            // Counter at the first TMR2 read after mark
+static unsigned long idles;                 // power_idle calls
+static unsigned long job_runs;
+static int failed;
+
+/*
+ * Description
+ *      Checks a timer_now reading taken right before: never ahead of the counter, and behind it
+ *      by no more than the reading could have taken.
+ * Parameters 
+ *      1. const char *step, name of the step for the report
+ *      2. unsigned long now, the reading
+ * Return
+ *      void
+ */
+static void check_reading(const char *step, unsigned long now)
+{
+    if ((long) (clock - now) < 0 || clock - now > 2 * PASS_COUNTS + ISR_COUNTS) {
+        printf("FAIL %s: timer_now read 0x%08x with the counter at 0x%08x\n", step, now, clock);
+        failed = 1;
+    }
+}
+
+/*
+ * Description
+ *      An interrupt handler that stamps an event, the way the Timer1, CN and U1RX handlers do.
+ * Parameters 
+ *      void
+ * Return
+ *      void
+ */
+static void handler(void)
+{
+    in_interrupt = 1;
+    clock += ISR_COUNTS / 2;
+    check_reading("interrupt", timer_now());
+    clock += ISR_COUNTS / 2;
+    in_interrupt = 0;
+}
+
+volatile unsigned int *host_timer_register(unsigned char which)
+{
+    if (!in_interrupt && ((interrupt_every != 0 && ++accesses % interrupt_every == 0)
+        || (interrupt_before_hld && which == HOST_TMR3HLD))) {
+        interrupt_before_hld = 0;
+        handler();
+    }
+
+    random_state = random_state * 1103515245 + 12345;
+    clock += 1 + (random_state >> 16) % MAX_STEP;
+    if (which == HOST_TMR2) {
+        registers[HOST_TMR2] = (unsigned int) clock & 0xFFFF;
+        registers[HOST_TMR3HLD] = (unsigned int) (clock >> 16); // Latched by the TMR2 read
+        if (marked && !in_interrupt) {
+            marked = 0;
+            first_read = clock;
+        }
+    } else if (which == HOST_TMR3) {
+        registers[HOST_TMR3] = (unsigned int) (clock >> 16);
+    }
+    return &registers[which];
+}
+
+void power_idle(void)
+{
+    clock += TICK_COUNTS - clock % TICK_COUNTS; // Woken by the next Timer1 tick
+    idles++;
+}
+
+// Ndelay is built in with the rest of Support_fruit.c, which sends the colors through these
+void write_0(void) {}
+void write_1(void) {}
+void write_parallel(const unsigned char *planes, unsigned int count, unsigned char mask)
+{
+    (void) planes;
+    (void) count;
+    (void) mask;
+}
+
+/*
+ * Description
+ *      A sensor job for the bus scheduler to run in the Ndelay gaps.
+ * Parameters 
+ *      void
+ * Return
+ *      void
+ */
+static void job_run(void)
+{
+    clock += JOB_COUNTS;
+    job_runs++;
+}
+
+static bus_job_t job = { job_run, 3, 1000, 0, 0 };
+
+/*
+ * Description
+ *      Marks the start of a wait, so the deadline it sets can be worked out from its first read.
+ * Parameters 
+ *      void
+ * Return
+ *      void
+ */
+static void mark(void)
+{
+    marked = 1;
+}
+
+/*
+ * Description
+ *      Checks that a wait started with mark ended at or after its deadline and no later than
+ *      allowed, and keeps the latest end seen.
+ * Parameters 
+ *      1. const char *step, name of the step for the report
+ *      2. unsigned long counts, the wait in counts
+ *      3. unsigned long allowed, counts it may end after the deadline
+ *      4. unsigned long *worst, latest end so far, updated
+ * Return
+ *      void
+ */
+static void check_wait(const char *step, unsigned long counts, unsigned long allowed, unsigned long *worst)
+{
+    unsigned long late = clock - (first_read + counts);
+
+    if ((long) late < 0 || late > allowed) {
+        printf("FAIL %s: %u counts ended %d counts after the deadline\n", step, counts, (int) late);
+        failed = 1;
+    } else if (late > *worst) {
+        *worst = late;
+    }
+}
+
+int main(void)
+{
+    static const unsigned long us[] = { 0, 1, 2, 5, 10, 99, 100, 999, 1000, 1001, 12345, 100000 };
+    static const unsigned int ms[] = { 0, 1, 2, 10, 123, 1000 };
+    static const int hundreds[] = { 0, 1, 5, 20, 2000 };
+    static const unsigned long starts[] = { 0x1000, 0xFFFFFFFF - 50000 }; // The second wraps
+    unsigned long worst_us = 0, worst_ms = 0, worst_n = 0, worst_job = 0, now, deadline;
+    unsigned int s, i;
+
+    timer_init();
+
+    // An interrupt that reads the timer between the TMR2 and TMR3HLD reads, with TMR2 wrapping
+    // while it runs
+    for (i = 0; i < ISR_COUNTS + 4 * PASS_COUNTS; i++) {
+        clock = 0x0004FFFF - i;
+        interrupt_before_hld = 1;
+        now = timer_now();
+        check_reading("wrap during an interrupt", now);
+    }
+    interrupt_before_hld = 0;
+
+    interrupt_every = INTERRUPT_EVERY;
+    for (s = 0; s < sizeof(starts) / sizeof(starts[0]); s++) {
+        for (i = 0; i < sizeof(us) / sizeof(us[0]); i++) {
+            clock = starts[s];
+            mark();
+            delay_us(us[i]);
+            check_wait("delay_us", us[i] * TIMER_COUNTS_PER_US, LATE_COUNTS, &worst_us);
+        }
+        for (i = 0; i < sizeof(ms) / sizeof(ms[0]); i++) {
+            clock = starts[s];
+            mark();
+            delay_ms(ms[i]);
+            check_wait("delay_ms", ms[i] * TIMER_COUNTS_PER_MS, LATE_COUNTS, &worst_ms);
+        }
+        // bus_wait_until checks the deadline once more after wait_until returns
+        for (i = 0; i < sizeof(hundreds) / sizeof(hundreds[0]); i++) {
+            clock = starts[s];
+            mark();
+            Ndelay(hundreds[i]);
+            check_wait("Ndelay", hundreds[i] * 100 * TIMER_COUNTS_PER_US, LATE_COUNTS + PASS_COUNTS, &worst_n);
+        }
+    }
+
+    // Ndelay with a job in the gaps: it only runs when it fits, so the delay still ends on time
+    bus_add(&job);
+    for (s = 0; s < sizeof(starts) / sizeof(starts[0]); s++) {
+        for (i = 0; i < sizeof(hundreds) / sizeof(hundreds[0]); i++) {
+            clock = starts[s];
+            job.due = clock;
+            mark();
+            Ndelay(hundreds[i]);
+            check_wait("Ndelay with a job", hundreds[i] * 100 * TIMER_COUNTS_PER_US, LATE_COUNTS + 2 * PASS_COUNTS,
+                       &worst_job);
+        }
+    }
+    if (job_runs == 0) {
+        printf("FAIL the bus job never ran in the Ndelay gaps\n");
+        failed = 1;
+    }
+    interrupt_every = 0;
+
+    // Deadlines across the wrap of the counter
+    clock = 0xFFFFFF00;
+    deadline = deadline_in_us(100);
+    if (deadline_expired(deadline)) {
+        printf("FAIL a deadline past the wrap has expired right away\n");
+        failed = 1;
+    }
+    clock = 0xFFFFFFF0;
+    if (deadline_expired(deadline)) {
+        printf("FAIL a deadline past the wrap has expired before the wrap\n");
+        failed = 1;
+    }
+    clock = deadline - 2 * PASS_COUNTS;
+    if (deadline_expired(deadline)) {
+        printf("FAIL a deadline past the wrap has expired early\n");
+        failed = 1;
+    }
+    clock = deadline;
+    if (!deadline_expired(deadline)) {
+        printf("FAIL a deadline past the wrap has not expired on time\n");
+        failed = 1;
+    }
+    clock = 0x80000000;
+    if (deadline_expired(clock + 0x7FFFFF00) || !deadline_expired(clock - 0x7FFFFF00)) {
+        printf("FAIL deadlines almost 2^31 counts away\n");
+        failed = 1;
+    }
+
+    printf("timer_host %u MIPS: latest end past the deadline %u ns (delay_us), %u ns (delay_ms), "
+           "%u ns (Ndelay), %u ns (Ndelay with %u jobs), %u idles: %s\n",
+           (unsigned int) TIMER_COUNTS_PER_US, (unsigned int) (worst_us * 1000 / TIMER_COUNTS_PER_US),
+           (unsigned int) (worst_ms * 1000 / TIMER_COUNTS_PER_US), (unsigned int) (worst_n * 1000 / TIMER_COUNTS_PER_US),
+           (unsigned int) (worst_job * 1000 / TIMER_COUNTS_PER_US), job_runs, idles, failed ? "FAILED" : "passed");
+    return failed;
+}
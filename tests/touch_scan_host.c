@@ -0,0 +1,213 @@
+/*
+ * File Description
+ *      Host test for the CAP1188 scan (Touch_scan.c), built with TOUCH_DEVICE_COUNT 3. The I2C
+ *      device functions are replaced by simulated CAP1188s: a touched channel sets its status bit,
+ *      which stays set until the INT bit is cleared and is then set again only if the channel is
+ *      still touched, like the real part. The test touches and releases channels between scans and
+ *      checks the pressed bits, the reads and writes each device gets, and the scan statistics.
+ */
+
+#include <stdio.h>
+#include "Touch_sensor.h"
+#include "Timer.h"
+
+#if TOUCH_DEVICE_COUNT != 3
+#error "Build the scan test with -DTOUCH_DEVICE_COUNT=3"
+#endif
+
+typedef struct {
+    unsigned char present;  // Answers on the bus
+    unsigned char touching; // Channels touched right now
+    unsigned char status;   // Input status register, latched until INT is cleared
+    unsigned int reads;     // Status reads
+    unsigned int clears;    // INT clears
+} fake_t;
+
+touch_device_t touch_devices[TOUCH_DEVICE_COUNT];
+static fake_t fakes[TOUCH_DEVICE_COUNT];
+static unsigned long now;
+static int failed;
+
+unsigned long timer_now(void)
+{
+    return now;
+}
+
+/*
+ * Description
+ *      Simulated CAP1188 of a device handle.
+ * Parameters 
+ *      1. const touch_device_t *device, the handle
+ * Return
+ *      fake_t *, the simulated device
+ */
+static fake_t *fake_of(const touch_device_t *device)
+{
+    return &fakes[device - touch_devices];
+}
+
+unsigned char touch_device_read(touch_device_t *device, unsigned char reg)
+{
+    fake_t *fake = fake_of(device);
+
+    device->present = fake->present;
+    if (!fake->present || reg != TOUCH_INPUT_STATUS)
+        return 0;
+    fake->reads++;
+    return fake->status;
+}
+
+unsigned char touch_device_write(touch_device_t *device, unsigned char reg, const unsigned char *data, unsigned char count)
+{
+    fake_t *fake = fake_of(device);
+
+    device->present = fake->present;
+    if (!fake->present)
+        return 0;
+    if (reg == TOUCH_MAIN_CONTROL && count == 1 && (data[0] & 1) == 0) {
+        fake->clears++;
+        fake->status = fake->touching;
+    }
+    return 1;
+}
+
+/*
+ * Description
+ *      Touches or releases a channel of a simulated device.
+ * Parameters 
+ *      1. unsigned char device, index of the device
+ *      2. unsigned char channel, the channel
+ *      3. unsigned char down, 1 to touch, 0 to release
+ * Return
+ *      void
+ */
+static void touch(unsigned char device, unsigned char channel, unsigned char down)
+{
+    if (down) {
+        fakes[device].touching |= 1 << channel;
+        fakes[device].status |= 1 << channel;
+    } else {
+        fakes[device].touching &= ~(1 << channel);
+    }
+}
+
+/*
+ * Description
+ *      Runs full scans, one device per TOUCH_SCAN_SLOT_MS like the bus scheduler.
+ * Parameters 
+ *      1. unsigned int scans, full scans to run
+ * Return
+ *      void
+ */
+static void scan(unsigned int scans)
+{
+    unsigned int i;
+
+    for (i = 0; i < scans * TOUCH_DEVICE_COUNT; i++) {
+        touch_scan_next();
+        now += (unsigned long) TOUCH_SCAN_SLOT_MS * TIMER_COUNTS_PER_MS;
+    }
+}
+
+/*
+ * Description
+ *      Takes the pressed bits of every device and compares them with the expected ones.
+ * Parameters 
+ *      1. const char *step, name of the step for the report
+ *      2. unsigned char d0, expected pressed bits of device 0
+ *      3. unsigned char d1, expected pressed bits of device 1
+ *      4. unsigned char d2, expected pressed bits of device 2
+ * Return
+ *      void
+ */
+static void expect(const char *step, unsigned char d0, unsigned char d1, unsigned char d2)
+{
+    unsigned char expected[TOUCH_DEVICE_COUNT] = { d0, d1, d2 };
+    unsigned char d, pressed;
+
+    for (d = 0; d < TOUCH_DEVICE_COUNT; d++) {
+        pressed = touch_take_pressed(d);
+        if (pressed != expected[d]) {
+            printf("FAIL %s: device %u pressed 0x%02x, expected 0x%02x\n", step, d, pressed, expected[d]);
+            failed = 1;
+        }
+    }
+}
+
+int main(void)
+{
+    touch_scan_stats_t stats;
+    unsigned char d;
+
+    for (d = 0; d < TOUCH_DEVICE_COUNT; d++) {
+        touch_devices[d].address = TOUCH_ADDRESS(d);
+        fakes[d].present = 1;
+    }
+    touch_scan_start();
+
+    scan(1);
+    expect("idle", 0, 0, 0);
+    for (d = 0; d < TOUCH_DEVICE_COUNT; d++) {
+        if (fakes[d].reads != 1 || fakes[d].clears != 0) {
+            printf("FAIL idle: device %u read %u times, cleared %u times\n", d, fakes[d].reads, fakes[d].clears);
+            failed = 1;
+        }
+    }
+
+    touch(1, 2, 1);
+    scan(1);
+    expect("touch", 0, 0x04, 0);
+    scan(5);
+    expect("held", 0, 0, 0);
+    touch(1, 2, 0);
+    scan(2);
+    expect("released", 0, 0, 0);
+    if (touch_devices[1].status != 0) {
+        printf("FAIL released: status still 0x%02x\n", touch_devices[1].status);
+        failed = 1;
+    }
+
+    // Touched and released between two reads: the latched status bit still reports it
+    touch(2, 7, 1);
+    touch(2, 7, 0);
+    scan(1);
+    expect("short touch", 0, 0, 0x80);
+
+    // Two touches before the caller gets to them are both kept
+    touch(0, 0, 1);
+    scan(1);
+    touch(0, 1, 1);
+    scan(1);
+    expect("two touches", 0x03, 0, 0);
+    touch(0, 0, 0);
+    touch(0, 1, 0);
+    scan(2);
+
+    // Touched again after the release is a new press
+    touch(1, 2, 1);
+    scan(1);
+    expect("touch again", 0, 0x04, 0);
+    touch(1, 2, 0);
+    scan(2);
+
+    // A device that does not answer reports nothing and the others carry on
+    fakes[1].present = 0;
+    touch(1, 3, 1);
+    touch(2, 3, 1);
+    scan(2);
+    expect("missing device", 0, 0, 0x08);
+    if (touch_devices[1].present) {
+        printf("FAIL missing device: still marked present\n");
+        failed = 1;
+    }
+
+    touch_scan_stats(&stats);
+    if (stats.cycles != 19 || stats.min_period_us != TOUCH_SCAN_SLOT_MS * TOUCH_DEVICE_COUNT * 1000UL
+        || stats.max_period_us != stats.min_period_us) {
+        printf("FAIL stats: %lu cycles, period %lu to %lu us\n", stats.cycles, stats.min_period_us, stats.max_period_us);
+        failed = 1;
+    }
+
+    printf("touch_scan_host: %s\n", failed ? "FAILED" : "passed");
+    return failed;
+}
@@ -0,0 +1,98 @@
+/*
+ * File Description
+ *      Host check of the WS2812 bit timing that Assembly.s generates from the instruction clock, 
+ *      built once for every FCY in the Makefile. The assembler cannot run here, so the bit times of 
+ *      write_0, write_1 and write_parallel are worked out from the cycle counts of Support_fruit.h 
+ *      (the same formulas as Assembly.s) the way the code spends them, with padding that cannot go 
+ *      below zero, and checked against the WS2812 datasheet: every bit exactly TBIT long and every 
+ *      high and low time within 150 ns of its nominal value. Clocks too slow to meet it must be 
+ *      refused by Support_fruit.h; the Makefile checks that for 8 MHz.
+ */
+
+#include <stdio.h>
+#include "Support_fruit.h"
+
+#define TOLERANCE_NS 150
+
+typedef struct {
+    const char *name;
+    unsigned long high;     // Cycles
+    unsigned long low;
+} bit_t;
+
+/*
+ * Description
+ *      Padding as delay_cycles emits it: nothing for a count of zero or less.
+ * Parameters 
+ *      1. long cycles, the count
+ * Return
+ *      unsigned long, cycles waited
+ */
+static unsigned long pad(long cycles)
+{
+    return cycles > 0 ? (unsigned long) cycles : 0;
+}
+
+/*
+ * Description
+ *      Cycles in nanoseconds.
+ * Parameters 
+ *      1. unsigned long cycles, the cycles
+ * Return
+ *      unsigned long, nanoseconds
+ */
+static unsigned long ns(unsigned long cycles)
+{
+    return cycles * 1000000000UL / FCY;
+}
+
+/*
+ * Description
+ *      Checks one bit against the bit time and the datasheet high and low times.
+ * Parameters 
+ *      1. const bit_t *bit, the bit
+ *      2. unsigned long high_ns, nominal high time
+ *      3. unsigned long low_ns, nominal low time
+ * Return
+ *      int, 0 if it is right, 1 if not
+ */
+static int check(const bit_t *bit, unsigned long high_ns, unsigned long low_ns)
+{
+    int failed = bit->high + bit->low != WS2812_TBIT_CYCLES
+        || ns(bit->high) + TOLERANCE_NS < high_ns || ns(bit->high) > high_ns + TOLERANCE_NS
+        || ns(bit->low) + TOLERANCE_NS < low_ns || ns(bit->low) > low_ns + TOLERANCE_NS;
+
+    printf("%s%s: high %lu ns, low %lu ns, bit %lu ns\n", failed ? "FAIL " : "  ", bit->name, ns(bit->high), 
+           ns(bit->low), ns(bit->high + bit->low));
+    return failed;
+}
+
+int main(void)
+{
+    long t0h = WS2812_T0H_CYCLES, t1h = WS2812_T1H_CYCLES, tbit = WS2812_TBIT_CYCLES;
+    // write_0 and write_1: bset, high padding, bclr; low padding, return and the next call
+    bit_t write_0 = { "write_0", t0h, pad(tbit - t0h - WS2812_CALL_CYCLES) + WS2812_CALL_CYCLES };
+    bit_t write_1 = { "write_1", t1h, pad(tbit - t1h - WS2812_CALL_CYCLES) + WS2812_CALL_CYCLES };
+    // write_parallel: ior, mov, padding, then the 'and' for the '0' lines, mov, padding, then the 
+    // 'and' for the '1' lines, padding and the loop back to ior
+    bit_t parallel_0, parallel_1;
+    unsigned long bit;
+    int failed = 0;
+
+    parallel_0.name = "write_parallel '0'";
+    parallel_0.high = 1 + 1 + pad(t0h - 2);
+    parallel_1.name = "write_parallel '1'";
+    parallel_1.high = parallel_0.high + 1 + 1 + pad(t1h - t0h - 2);
+    bit = parallel_1.high + pad(tbit - t1h - WS2812_LOOP_CYCLES) + WS2812_LOOP_CYCLES;
+    parallel_0.low = bit - parallel_0.high;
+    parallel_1.low = bit - parallel_1.high;
+
+    printf("ws2812_timing_host %lu MIPS: T0H %ld, T1H %ld, TBIT %ld cycles\n", FCY / 1000000UL, t0h, t1h, tbit);
+    failed |= check(&write_0, 350, 800);
+    failed |= check(&write_1, 700, 600);
+    failed |= check(&parallel_0, 350, 800);
+    failed |= check(&parallel_1, 700, 600);
+
+    printf("ws2812_timing_host: %s\n", failed ? "FAILED" : "passed");
+    return failed;
+}
@@ -0,0 +1,102 @@
+#!/usr/bin/env python3
+"""
+Builds an SPI flash image of an animation and checks that playback keeps up (see Spi_flash.h).
+
+The animation is in the text format of upload_animation.py. The image is written to a file that
+is then programmed onto the chip with any SPI programmer:
+
+    python3 tools/flash_image.py banana.anim banana.bin
+
+The player is then replayed against that file as if it were the chip, with the timings of the
+board, to tell whether reading each frame ahead fits in the gap after the previous one:
+
+    python3 tools/flash_image.py banana.bin --check --fps 60
+
+Reads the text format with upload_animation.py, so needs pyserial too.
+"""
+
+import argparse
+import struct
+import sys
+
+from upload_animation import parse
+
+HEADER_BYTES = 8
+FRAME_BYTES = 192
+SCK_HZ = 8000000
+BYTE_OVERHEAD_US = 0.5      # spi_transfer loop around each byte
+PUSH_US = 64 * 24 * 1.25 + 50  # frame_show: 24 bits per LED plus the latch
+DRAW_US = 64 * 4.0          # frame_set_pixel for every pixel
+
+
+def image(period, palette, frames):
+    data = bytearray(b"SF")
+    data += struct.pack("<HI", period, len(frames))
+    for rows in frames:
+        for row in rows:
+            for index in row:
+                data += bytes(palette[index])
+    return bytes(data)
+
+
+def read(chip, address, count):
+    """Reads from the file the way spi_flash_read reads from the chip, with the time it takes."""
+    chip.seek(address)
+    data = chip.read(count)
+    if len(data) != count:
+        sys.exit("image ends at %d, reading %d bytes from %d" % (chip.tell(), count, address))
+    return data, (4 + count) * (8e6 / SCK_HZ + BYTE_OVERHEAD_US)
+
+
+def check(path, fps):
+    with open(path, "rb") as chip:
+        header, _ = read(chip, 0, HEADER_BYTES)
+        if header[:2] != b"SF":
+            sys.exit("%s is not an SPI flash image" % path)
+        period, frames = struct.unpack("<HI", header[2:])
+        if fps:
+            period = 1000.0 / fps
+        budget = period * 1000.0
+
+        late, min_slack, max_read = 0, budget, 0.0
+        for n in range(frames):
+            used = DRAW_US + PUSH_US
+            if n + 1 < frames:
+                _, took = read(chip, HEADER_BYTES + (n + 1) * FRAME_BYTES, FRAME_BYTES)
+                max_read = max(max_read, took)
+                used += took
+            if used > budget:
+                late += 1
+            min_slack = min(min_slack, budget - used)
+
+    print("%d frames, %.1f ms each, %.1f s" % (frames, period, frames * period / 1000.0))
+    print("read ahead %.0f us, draw and push %.0f us, least slack %.0f us" %
+          (max_read, DRAW_US + PUSH_US, min_slack))
+    print("highest frame rate %.0f fps" % (1e6 / (DRAW_US + PUSH_US + max_read)))
+    if late:
+        print("read-ahead does not keep up: %d late frames" % late)
+        return 1
+    print("read-ahead keeps up")
+    return 0
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n")[1])
+    parser.add_argument("source", help="animation, or image with --check")
+    parser.add_argument("image", nargs="?", help="image file to write")
+    parser.add_argument("--check", action="store_true", help="replay an image file as the chip")
+    parser.add_argument("--fps", type=float, help="frame rate to check instead of the period in the image")
+    args = parser.parse_args()
+
+    if args.check:
+        sys.exit(check(args.source, args.fps))
+    if not args.image:
+        parser.error("the image file is needed to build an image")
+    data = image(*parse(args.source))
+    with open(args.image, "wb") as f:
+        f.write(data)
+    print("wrote %d bytes" % len(data))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,113 @@
+#!/usr/bin/env python3
+"""
+Reports flash and RAM use per function and per variable from the XC16 link map.
+
+Have the linker write a map file (Project Properties > xc16-ld > Generate map file, or
+-Wl,-Map=fruit.map on the command line), build, and then:
+
+    python3 tools/map_report.py dist/default/production/fruit.map --top 20
+
+Flash is counted in bytes of program memory, 3 per instruction. Static RAM is what the linker
+placed; the stack gets whatever is left, and how much of it is really used only shows at run time
+(stack_high_water in Stack.h).
+"""
+
+import argparse
+import re
+from collections import defaultdict
+
+FLASH_BYTES = 22016 * 3  # PIC24FJ64GA002: 22016 instructions of 3 bytes
+RAM_BYTES = 8 * 1024
+
+SECTION = re.compile(r"^ ?(\.\S+)(?:\s+0x([0-9a-fA-F]+)\s+0x([0-9a-fA-F]+)(?:\s+(\S+))?)?\s*$")
+WRAPPED = re.compile(r"^\s+0x([0-9a-fA-F]+)\s+0x([0-9a-fA-F]+)(?:\s+(\S+))?\s*$")
+SYMBOL = re.compile(r"^\s+0x([0-9a-fA-F]+)\s+([A-Za-z_]\w*)\s*(?:=.*)?$")
+
+
+def in_flash(section):
+    return section.startswith((".text", ".const", ".dinit", ".isr", ".ivt", ".aivt", ".init"))
+
+
+def in_ram(section):
+    return section.startswith((".bss", ".nbss", ".data", ".ndata", ".pbss"))
+
+
+def parse(path):
+    """Input sections as (section, address, length, object) and symbols as address: name."""
+    sections, symbols, pending = [], {}, None
+    started = False
+    with open(path) as f:
+        for line in f:
+            if not started:
+                started = line.startswith("Linker script and memory map")
+                continue
+            if pending:
+                m = WRAPPED.match(line)
+                if m:
+                    sections.append((pending, int(m.group(1), 16), int(m.group(2), 16), m.group(3)))
+                pending = None
+                continue
+            m = SECTION.match(line)
+            if m and line[0] == " ":
+                if m.group(2) is None:
+                    pending = m.group(1)  # Long name, address and length are on the next line
+                elif m.group(4):
+                    sections.append((m.group(1), int(m.group(2), 16), int(m.group(3), 16), m.group(4)))
+                continue
+            m = SYMBOL.match(line)
+            if m:
+                symbols[int(m.group(1), 16)] = m.group(2)
+    return sections, symbols
+
+
+def sizes(sections, symbols):
+    """Size of every symbol, up to the next symbol or the end of its input section."""
+    found = []
+    addresses = sorted(symbols)
+    for section, start, length, obj in sections:
+        if length == 0 or not (in_flash(section) or in_ram(section)):
+            continue
+        inside = [a for a in addresses if start <= a < start + length]
+        if not inside or inside[0] != start:
+            inside.insert(0, start)
+        for i, address in enumerate(inside):
+            end = inside[i + 1] if i + 1 < len(inside) else start + length
+            name = symbols.get(address, "(%s)" % section)
+            if name.startswith("_"):
+                name = name[1:]  # C names get an underscore
+            size = end - address
+            if in_flash(section):
+                size = size * 3 // 2  # Program addresses count 2 per instruction of 3 bytes
+            found.append((in_flash(section), name, size, obj.split("/")[-1]))
+    return found
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n")[1])
+    parser.add_argument("map")
+    parser.add_argument("--top", type=int, default=0, help="show only the largest entries")
+    args = parser.parse_args()
+
+    sections, symbols = parse(args.map)
+    found = sizes(sections, symbols)
+    stack = [a for a, n in symbols.items() if n in ("__SP_init", "__SPLIM_init")]
+
+    for flash, title, total in ((True, "Flash", FLASH_BYTES), (False, "RAM", RAM_BYTES)):
+        entries = sorted((e for e in found if e[0] == flash), key=lambda e: -e[2])
+        used = sum(e[2] for e in entries)
+        print("%s: %d of %d bytes used, %d left" % (title, used, total, total - used))
+        for _, name, size, obj in entries[:args.top or None]:
+            print("  %6d  %-32s %s" % (size, name, obj))
+        per_object = defaultdict(int)
+        for _, _, size, obj in entries:
+            per_object[obj] += size
+        print("  by file:")
+        for obj, size in sorted(per_object.items(), key=lambda e: -e[1]):
+            print("  %6d  %s" % (size, obj))
+        print()
+    if len(stack) == 2:
+        print("Stack: %d bytes from 0x%x (compare with stack_high_water)" % (max(stack) + 2 - min(stack), min(stack)))
+
+
+if __name__ == "__main__":
+    main()
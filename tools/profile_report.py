@@ -0,0 +1,93 @@
+#!/usr/bin/env python3
+"""
+Reads the profiler histogram from the board and names the functions it landed in (see Profile.h).
+
+The board has to be built with PROFILE and UART_STREAM. The names come from the link map of the
+same build (see map_report.py):
+
+    python3 tools/profile_report.py /dev/ttyUSB0 dist/default/production/fruit.map --clear
+
+A bucket covers 32 instructions, so a sample is put in the function the bucket starts in and a
+small function next to a big one can take some of its samples.
+
+Needs pyserial.
+"""
+
+import argparse
+import bisect
+import struct
+import sys
+from collections import defaultdict
+
+import serial
+
+from map_report import in_flash, parse
+from stream_frames import BAUD, SYNC, crc16, frame
+
+TYPE_PROFILE = 0x20
+HEADER = "<IIHHBH"
+
+
+def read_frame(port, kind=TYPE_PROFILE):
+    """Payload of the reply frame of the given type."""
+    while True:
+        byte = port.read(1)
+        if not byte:
+            sys.exit("no reply, is the board built with the right options and UART_STREAM?")
+        if byte[0] == SYNC:
+            break
+    head = port.read(3)
+    length = struct.unpack("<H", head[1:])[0]
+    payload = port.read(length)
+    crc = port.read(2)
+    if head[0] != kind or len(payload) != length or struct.unpack(">H", crc)[0] != crc16(head + payload):
+        sys.exit("bad reply")
+    return payload
+
+
+def functions(path):
+    sections, symbols = parse(path)
+    starts = {}
+    for section, start, length, _ in sections:
+        if in_flash(section):
+            for address, name in symbols.items():
+                if start <= address < start + length:
+                    starts[address] = name[1:] if name.startswith("_") else name
+    addresses = sorted(starts)
+    return addresses, [starts[a] for a in addresses]
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n")[1])
+    parser.add_argument("port")
+    parser.add_argument("map")
+    parser.add_argument("--clear", action="store_true", help="start a new histogram on the board")
+    parser.add_argument("--top", type=int, default=25)
+    args = parser.parse_args()
+
+    with serial.Serial(args.port, BAUD, timeout=2) as port:
+        port.reset_input_buffer()
+        port.write(frame(TYPE_PROFILE, bytes([1 if args.clear else 0])))
+        payload = read_frame(port)
+
+    samples, masked, outside, hz, shift, buckets = struct.unpack_from(HEADER, payload)
+    counts = struct.unpack_from("<%dH" % buckets, payload, struct.calcsize(HEADER))
+    addresses, names = functions(args.map)
+
+    per_function = defaultdict(int)
+    for bucket, count in enumerate(counts):
+        if count:
+            i = bisect.bisect_right(addresses, bucket << shift) - 1
+            per_function[names[i] if i >= 0 else "(below 0x%x)" % addresses[0]] += count
+
+    total = samples + masked
+    if not total:
+        sys.exit("no samples yet")
+    print("%d samples in %.1f s, %.1f%% in frame pushes (masked), %d outside program memory" %
+          (total, total / hz, 100.0 * masked / total, outside))
+    for name, count in sorted(per_function.items(), key=lambda e: -e[1])[:args.top]:
+        print("  %5.1f%%  %6d  %s" % (100.0 * count / total, count, name))
+
+
+if __name__ == "__main__":
+    main()
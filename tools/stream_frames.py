@@ -0,0 +1,93 @@
+#!/usr/bin/env python3
+"""
+Streams test frames to the matrix in UART_STREAM mode and measures the frame rate.
+
+Each frame is sent as soon as the ACK for the previous one arrives (see Stream.h for the
+framing). The measured rate is printed next to the bound set by the wire time alone, so it
+shows how much the LED push and parsing add on top.
+
+    python3 tools/stream_frames.py /dev/ttyUSB0 --frames 500 --type rgb
+
+Needs pyserial.
+"""
+
+import argparse
+import struct
+import sys
+import time
+
+import serial
+
+SYNC = 0xA5
+TYPE_RGB = 0x01
+TYPE_4BPP = 0x02
+ACK = 0x06
+NAK = 0x15
+PIXELS = 64
+BAUD = 1000000
+
+
+def crc16(data):
+    """CRC-16/CCITT, polynomial 0x1021, start 0xFFFF."""
+    crc = 0xFFFF
+    for byte in data:
+        crc ^= byte << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) if crc & 0x8000 else (crc << 1)
+            crc &= 0xFFFF
+    return crc
+
+
+def frame(kind, payload):
+    body = bytes([kind]) + struct.pack("<H", len(payload)) + payload
+    return bytes([SYNC]) + body + struct.pack(">H", crc16(body))
+
+
+def rgb_frame(n):
+    """A single lit pixel running through the matrix."""
+    payload = bytearray(PIXELS * 3)
+    payload[(n % PIXELS) * 3:(n % PIXELS) * 3 + 3] = b"\x40\x40\x40"
+    return frame(TYPE_RGB, bytes(payload))
+
+
+def bpp4_frame(n):
+    """Diagonal stripes that move one pixel per frame, over a 16 step grey palette."""
+    palette = b"".join(bytes([i * 6] * 3) for i in range(16))
+    indices = bytearray()
+    for p in range(0, PIXELS, 2):
+        left = ((p % 8) + (p // 8) + n) & 15
+        right = ((p % 8) + 1 + (p // 8) + n) & 15
+        indices.append((left << 4) | right)
+    return frame(TYPE_4BPP, palette + bytes(indices))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n")[1])
+    parser.add_argument("port")
+    parser.add_argument("--frames", type=int, default=500)
+    parser.add_argument("--type", choices=["rgb", "4bpp"], default="rgb")
+    args = parser.parse_args()
+
+    make = rgb_frame if args.type == "rgb" else bpp4_frame
+    frames = [make(n) for n in range(args.frames)]
+    naks = 0
+
+    with serial.Serial(args.port, BAUD, timeout=1) as port:
+        port.reset_input_buffer()
+        start = time.perf_counter()
+        for data in frames:
+            port.write(data)
+            reply = port.read(1)
+            if not reply:
+                sys.exit("no ACK, is the board in UART_STREAM mode?")
+            if reply[0] == NAK:
+                naks += 1
+        elapsed = time.perf_counter() - start
+
+    wire = len(frames[0]) * 10 / BAUD  # 8N1 is 10 bits per byte
+    print("%d %s frames of %d bytes in %.2f s" % (args.frames, args.type, len(frames[0]), elapsed))
+    print("%.1f fps measured, %.1f fps wire limit, %d NAK" % (args.frames / elapsed, 1 / wire, naks))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,114 @@
+#!/usr/bin/env python3
+"""
+Reads the trace ring from the board and prints it as a timeline (see Trace.h).
+
+The board has to be built with TRACE and UART_STREAM. Each animation is followed by its real
+frame intervals next to the intended time per frame:
+
+    python3 tools/trace_report.py /dev/ttyUSB0 --save kiosk3.trace
+    python3 tools/trace_report.py --load kiosk3.trace
+
+Needs pyserial.
+"""
+
+import argparse
+import struct
+
+import serial
+
+from profile_report import read_frame
+from stream_frames import BAUD, frame
+
+TYPE_TRACE = 0x21
+RECORD = "<IBBH"
+GESTURES = {1: "tap", 2: "double-tap", 3: "long-press", 4: "swipe"}
+FRUITS = ["banana", "apple", "orange", "grapes"]
+
+
+def fruit(arg):
+    return FRUITS[arg] if arg < len(FRUITS) else str(arg)
+
+
+def describe(kind, arg, data):
+    if kind == 1:
+        return "touch down   channel %d" % arg
+    if kind == 2:
+        return "touch up     channel %d" % arg
+    if kind == 3:
+        return "anim start   %s, %d ms per frame" % (fruit(arg), data)
+    if kind == 4:
+        return "anim stop    %s" % fruit(arg)
+    if kind == 5:
+        return "frame        %d pixels" % data
+    if kind == 6:
+        return "i2c start    0x%02x register 0x%02x" % (arg, data)
+    if kind == 7:
+        return "i2c NACK     0x%02x" % arg
+    if kind == 8:
+        return "i2c timeout  0x%02x I2C2STAT 0x%04x" % (arg, data)
+    if kind == 9:
+        return "gesture      %s on channel %d" % (GESTURES.get(arg, arg), data)
+    return "type %d      arg %d data %d" % (kind, arg, data)
+
+
+def intervals(name, period, frames):
+    if len(frames) < 2:
+        return
+    gaps = [b - a for a, b in zip(frames, frames[1:])]
+    print("             %s: %d frames, interval %.1f ms mean, %.1f min, %.1f max (intended %d ms)" %
+          (name, len(frames), sum(gaps) / len(gaps), min(gaps), max(gaps), period))
+
+
+def timeline(payload):
+    count, size, per_us = struct.unpack_from("<IHB", payload)
+    records = [struct.unpack_from(RECORD, payload, 7 + 8 * i) for i in range((len(payload) - 7) // 8)]
+    if count > size:
+        print("%d older records were overwritten" % (count - size))
+    if not records:
+        print("the ring is empty")
+        return
+
+    last = records[0][0]
+    elapsed = 0.0
+    anim, period, frames = None, 0, []
+    for time, kind, arg, data in records:
+        elapsed += ((time - last) & 0xFFFFFFFF) / (per_us * 1000.0)  # The counter wraps after 268 s
+        last = time
+        print("%10.3f ms  %s" % (elapsed, describe(kind, arg, data)))
+        if kind == 3:
+            anim, period, frames = fruit(arg), data, []
+        elif kind == 5 and anim:
+            frames.append(elapsed)
+        elif kind == 4 and anim:
+            intervals(anim, period, frames)
+            anim = None
+    if anim:
+        intervals(anim + " (still playing)", period, frames)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n")[1])
+    parser.add_argument("port", nargs="?")
+    parser.add_argument("--clear", action="store_true", help="empty the ring on the board")
+    parser.add_argument("--save", help="also write the ring to this file")
+    parser.add_argument("--load", help="read a saved ring instead of the board")
+    args = parser.parse_args()
+
+    if args.load:
+        with open(args.load, "rb") as f:
+            payload = f.read()
+    elif args.port:
+        with serial.Serial(args.port, BAUD, timeout=2) as port:
+            port.reset_input_buffer()
+            port.write(frame(TYPE_TRACE, bytes([1 if args.clear else 0])))
+            payload = read_frame(port, TYPE_TRACE)
+    else:
+        parser.error("give the port or --load")
+    if args.save:
+        with open(args.save, "wb") as f:
+            f.write(payload)
+    timeline(payload)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,100 @@
+#!/usr/bin/env python3
+"""
+Uploads an animation to the library in program flash over UART (see Anim_store.h).
+
+The board has to be running in UART_STREAM mode. The animation is a text file:
+
+    period 120              time per frame in ms
+    color 1 100 100 0       palette entry 1, in writeColor order (unused entries are off)
+    frame                   starts a frame, followed by 8 rows of 8 hex digit palette indices
+    00000010
+    ...
+
+    python3 tools/upload_animation.py /dev/ttyUSB0 banana.anim --page 0
+
+Needs pyserial.
+"""
+
+import argparse
+import struct
+import sys
+
+import serial
+
+from stream_frames import ACK, BAUD, crc16, frame
+
+TYPE_STORE_ERASE = 0x10
+TYPE_STORE_ROW = 0x11
+TYPE_STORE_CHECK = 0x12
+PAGES = 8
+PAGE_BYTES = 1024
+ROW_BYTES = 128
+
+
+def parse(path):
+    period, palette, frames = 100, [(0, 0, 0)] * 16, []
+    with open(path) as f:
+        for number, line in enumerate(f, 1):
+            words = line.split("#")[0].split()
+            if not words:
+                continue
+            if words[0] == "period":
+                period = int(words[1])
+            elif words[0] == "color":
+                palette[int(words[1])] = tuple(int(w) for w in words[2:5])
+            elif words[0] == "frame":
+                frames.append([])
+            elif frames and len(words[0]) == 8:
+                frames[-1].append([int(c, 16) for c in words[0]])
+            else:
+                sys.exit("%s:%d: cannot read %r" % (path, number, line.strip()))
+    for rows in frames:
+        if len(rows) != 8:
+            sys.exit("%s: every frame needs 8 rows" % path)
+    return period, palette, frames
+
+
+def blob(period, palette, frames):
+    data = bytearray(b"AN")
+    data += struct.pack("<HHH", 56 + 32 * len(frames), len(frames), period)
+    for color in palette:
+        data += bytes(color)
+    for rows in frames:
+        pixels = [p for row in rows for p in row]
+        data += bytes((pixels[i] << 4) | pixels[i + 1] for i in range(0, 64, 2))
+    return bytes(data) + struct.pack(">H", crc16(data))
+
+
+def command(port, kind, payload, what):
+    port.write(frame(kind, payload))
+    reply = port.read(1)
+    if not reply or reply[0] != ACK:
+        sys.exit("%s failed" % what)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n")[1])
+    parser.add_argument("port")
+    parser.add_argument("animation")
+    parser.add_argument("--page", type=int, default=0, help="first page, 0 to %d" % (PAGES - 1))
+    args = parser.parse_args()
+
+    data = blob(*parse(args.animation))
+    pages = (len(data) + PAGE_BYTES - 1) // PAGE_BYTES
+    if args.page + pages > PAGES:
+        sys.exit("%d bytes do not fit from page %d" % (len(data), args.page))
+    data += b"\xff" * (-len(data) % ROW_BYTES)
+
+    with serial.Serial(args.port, BAUD, timeout=2) as port:
+        port.reset_input_buffer()
+        command(port, TYPE_STORE_ERASE, bytes([args.page, pages]), "erase")
+        base = args.page * PAGE_BYTES
+        for offset in range(0, len(data), ROW_BYTES):
+            command(port, TYPE_STORE_ROW, struct.pack("<H", base + offset) + data[offset:offset + ROW_BYTES],
+                    "row at %d" % (base + offset))
+        command(port, TYPE_STORE_CHECK, bytes([args.page]), "check")
+    print("stored %d bytes on pages %d to %d" % (len(data), args.page, args.page + pages - 1))
+
+
+if __name__ == "__main__":
+    main()